@@ -0,0 +1,288 @@
+#include "Game/AllocationCounter.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+struct AtomicMemoryTagStats
+{
+	std::atomic<uint64_t> m_numAllocations{ 0 };
+	std::atomic<uint64_t> m_numBytesAllocated{ 0 };
+	std::atomic<int64_t>  m_numLiveAllocations{ 0 };
+	std::atomic<int64_t>  m_numLiveBytes{ 0 };
+	std::atomic<int64_t>  m_highWaterBytes{ 0 };
+};
+
+
+//kept in front of every block while tracking, so a free knows what to give back and to whom
+struct alignas(16) AllocationHeader
+{
+	uint64_t  m_numBytes = 0;
+	MemoryTag m_tag = MemoryTag::UNTAGGED;
+};
+static_assert(sizeof(AllocationHeader) == 16, "Allocation header must keep blocks 16-byte aligned");
+
+
+constexpr int NUM_MEMORY_TAGS = static_cast<int>(MemoryTag::NUM_MEMORY_TAGS);
+
+static std::atomic<uint64_t> s_numHeapAllocations = 0;
+static std::atomic<uint64_t> s_numHeapBytesAllocated = 0;
+static AtomicMemoryTagStats s_tagStats[NUM_MEMORY_TAGS];
+static thread_local MemoryTag t_currentMemoryTag = MemoryTag::UNTAGGED;
+
+//frame bookkeeping, only touched by the thread calling MarkMemoryFrame
+static MemoryTagStats s_frameStartStats[NUM_MEMORY_TAGS];
+static MemoryTagStats s_lastFrameStats[NUM_MEMORY_TAGS];
+
+
+#if defined(ENABLE_ALLOCATION_COUNTING)
+//
+//allocation bookkeeping
+//
+static void RecordAllocation(MemoryTag tag, size_t numBytes)
+{
+	s_numHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	s_numHeapBytesAllocated.fetch_add(numBytes, std::memory_order_relaxed);
+
+	AtomicMemoryTagStats& stats = s_tagStats[static_cast<int>(tag)];
+	stats.m_numAllocations.fetch_add(1, std::memory_order_relaxed);
+	stats.m_numBytesAllocated.fetch_add(numBytes, std::memory_order_relaxed);
+
+#if defined(ENABLE_MEMORY_TRACKING)
+	stats.m_numLiveAllocations.fetch_add(1, std::memory_order_relaxed);
+	int64_t numLiveBytes = stats.m_numLiveBytes.fetch_add(static_cast<int64_t>(numBytes), std::memory_order_relaxed) + static_cast<int64_t>(numBytes);
+	int64_t highWaterBytes = stats.m_highWaterBytes.load(std::memory_order_relaxed);
+	while (numLiveBytes > highWaterBytes && !stats.m_highWaterBytes.compare_exchange_weak(highWaterBytes, numLiveBytes, std::memory_order_relaxed))
+	{
+	}
+#endif
+}
+
+
+static void FreeBlock(void* memory)
+{
+	if (memory == nullptr) return;
+
+#if defined(ENABLE_MEMORY_TRACKING)
+	AllocationHeader* header = static_cast<AllocationHeader*>(memory) - 1;
+	AtomicMemoryTagStats& stats = s_tagStats[static_cast<int>(header->m_tag)];
+	stats.m_numLiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+	stats.m_numLiveBytes.fetch_sub(static_cast<int64_t>(header->m_numBytes), std::memory_order_relaxed);
+	free(header);
+#else
+	free(memory);
+#endif
+}
+
+
+//
+//global allocation replacements
+//
+void* operator new(size_t numBytes)
+{
+	MemoryTag tag = t_currentMemoryTag;
+	RecordAllocation(tag, numBytes);
+
+#if defined(ENABLE_MEMORY_TRACKING)
+	AllocationHeader* header = static_cast<AllocationHeader*>(malloc(sizeof(AllocationHeader) + numBytes));
+	if (header == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	header->m_numBytes = numBytes;
+	header->m_tag = tag;
+	return header + 1;
+#else
+	void* memory = malloc(numBytes != 0 ? numBytes : 1);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+#endif
+}
+
+
+void* operator new[](size_t numBytes)
+{
+	return operator new(numBytes);
+}
+
+
+void operator delete(void* memory) noexcept
+{
+	FreeBlock(memory);
+}
+
+
+void operator delete[](void* memory) noexcept
+{
+	FreeBlock(memory);
+}
+
+
+void operator delete(void* memory, size_t numBytes) noexcept
+{
+	UNUSED(numBytes);
+	FreeBlock(memory);
+}
+
+
+void operator delete[](void* memory, size_t numBytes) noexcept
+{
+	UNUSED(numBytes);
+	FreeBlock(memory);
+}
+#endif
+
+
+//
+//scoped tag
+//
+ScopedMemoryTag::ScopedMemoryTag(MemoryTag tag)
+	: m_previousTag(t_currentMemoryTag)
+{
+	t_currentMemoryTag = tag;
+}
+
+
+ScopedMemoryTag::~ScopedMemoryTag()
+{
+	t_currentMemoryTag = m_previousTag;
+}
+
+
+//
+//public functions
+//
+uint64_t GetNumHeapAllocations()
+{
+	return s_numHeapAllocations.load(std::memory_order_relaxed);
+}
+
+
+uint64_t GetNumHeapBytesAllocated()
+{
+	return s_numHeapBytesAllocated.load(std::memory_order_relaxed);
+}
+
+
+bool IsAllocationCountingEnabled()
+{
+#if defined(ENABLE_ALLOCATION_COUNTING)
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+bool IsMemoryTrackingEnabled()
+{
+#if defined(ENABLE_MEMORY_TRACKING)
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+char const* GetMemoryTagName(MemoryTag tag)
+{
+	switch (tag)
+	{
+		case MemoryTag::UNTAGGED:		return "Untagged";
+		case MemoryTag::MAP_ENTITIES:	return "Map Entities";
+		case MemoryTag::RENDERING:		return "Rendering";
+		case MemoryTag::UI:				return "UI";
+		case MemoryTag::AUDIO:			return "Audio";
+		case MemoryTag::DEFINITIONS:	return "Definitions";
+		default:						return "Invalid";
+	}
+}
+
+
+MemoryTagStats GetMemoryTagStats(MemoryTag tag)
+{
+	AtomicMemoryTagStats const& atomicStats = s_tagStats[static_cast<int>(tag)];
+
+	MemoryTagStats stats;
+	stats.m_numAllocations = atomicStats.m_numAllocations.load(std::memory_order_relaxed);
+	stats.m_numBytesAllocated = atomicStats.m_numBytesAllocated.load(std::memory_order_relaxed);
+	stats.m_numLiveAllocations = atomicStats.m_numLiveAllocations.load(std::memory_order_relaxed);
+	stats.m_numLiveBytes = atomicStats.m_numLiveBytes.load(std::memory_order_relaxed);
+	stats.m_highWaterBytes = atomicStats.m_highWaterBytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+
+void CaptureMemoryTagStats(MemoryTagStats* out_statsPerTag)
+{
+	for (int tagIndex = 0; tagIndex < NUM_MEMORY_TAGS; tagIndex++)
+	{
+		out_statsPerTag[tagIndex] = GetMemoryTagStats(static_cast<MemoryTag>(tagIndex));
+	}
+}
+
+
+void MarkMemoryFrame()
+{
+	for (int tagIndex = 0; tagIndex < NUM_MEMORY_TAGS; tagIndex++)
+	{
+		MemoryTagStats stats = GetMemoryTagStats(static_cast<MemoryTag>(tagIndex));
+
+		MemoryTagStats& lastFrameStats = s_lastFrameStats[tagIndex];
+		lastFrameStats = stats;
+		lastFrameStats.m_numAllocations -= s_frameStartStats[tagIndex].m_numAllocations;
+		lastFrameStats.m_numBytesAllocated -= s_frameStartStats[tagIndex].m_numBytesAllocated;
+
+		s_frameStartStats[tagIndex] = stats;
+	}
+}
+
+
+MemoryTagStats GetLastFrameMemoryStats(MemoryTag tag)
+{
+	return s_lastFrameStats[static_cast<int>(tag)];
+}
+
+
+void ResetMemoryHighWaterMarks()
+{
+	for (int tagIndex = 0; tagIndex < NUM_MEMORY_TAGS; tagIndex++)
+	{
+		AtomicMemoryTagStats& stats = s_tagStats[tagIndex];
+		stats.m_highWaterBytes.store(stats.m_numLiveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+
+std::string GetMemoryTrackingSummary(MemoryTagStats const* startStatsPerTag)
+{
+	std::string summary = Stringf("%-14s %12s %11s %12s %12s %14s\n", "Tag", "Live KB", "Live Allocs", "Peak KB", "Allocs", "KB Allocated");
+	for (int tagIndex = 0; tagIndex < NUM_MEMORY_TAGS; tagIndex++)
+	{
+		MemoryTag tag = static_cast<MemoryTag>(tagIndex);
+		MemoryTagStats stats = GetMemoryTagStats(tag);
+		if (startStatsPerTag != nullptr)
+		{
+			stats.m_numAllocations -= startStatsPerTag[tagIndex].m_numAllocations;
+			stats.m_numBytesAllocated -= startStatsPerTag[tagIndex].m_numBytesAllocated;
+		}
+
+		summary += Stringf("%-14s %12.1f %11lld %12.1f %12llu %14.1f\n", GetMemoryTagName(tag), static_cast<double>(stats.m_numLiveBytes) / 1024.0,
+			static_cast<long long>(stats.m_numLiveAllocations), static_cast<double>(stats.m_highWaterBytes) / 1024.0, static_cast<unsigned long long>(stats.m_numAllocations),
+			static_cast<double>(stats.m_numBytesAllocated) / 1024.0);
+	}
+
+	if (!IsAllocationCountingEnabled())
+	{
+		summary += "Allocations are only counted in a build with ENABLE_ALLOCATION_COUNTING\n";
+	}
+	else if (!IsMemoryTrackingEnabled())
+	{
+		summary += "Live and peak columns need a build with ENABLE_MEMORY_TRACKING\n";
+	}
+	return summary;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+
+//both off unless defined here or in the project's preprocessor definitions, so ordinary builds keep the CRT allocator.
+//ENABLE_ALLOCATION_COUNTING replaces global operator new and delete to count allocations and bytes per tag.
+//ENABLE_MEMORY_TRACKING also puts a 16-byte header on every block to remember its size and tag, which is what live
+//byte counts and high-water marks need; it implies counting.
+//#define ENABLE_ALLOCATION_COUNTING
+//#define ENABLE_MEMORY_TRACKING
+#if defined(ENABLE_MEMORY_TRACKING) && !defined(ENABLE_ALLOCATION_COUNTING)
+	#define ENABLE_ALLOCATION_COUNTING
+#endif
+
+
+//subsystems allocations are charged to; each thread charges whatever tag it currently has set
+enum class MemoryTag : uint8_t
+{
+	UNTAGGED,
+	MAP_ENTITIES,
+	RENDERING,
+	UI,
+	AUDIO,
+	DEFINITIONS,
+
+	NUM_MEMORY_TAGS
+};
+
+
+struct MemoryTagStats
+{
+	uint64_t m_numAllocations = 0;		//since startup, or over the frame for GetLastFrameMemoryStats
+	uint64_t m_numBytesAllocated = 0;
+	int64_t  m_numLiveAllocations = 0;	//live counts and high-water marks need ENABLE_MEMORY_TRACKING
+	int64_t  m_numLiveBytes = 0;
+	int64_t  m_highWaterBytes = 0;
+};
+
+
+//charges the calling thread's allocations to a tag until it goes out of scope
+class ScopedMemoryTag
+{
+public:
+	explicit ScopedMemoryTag(MemoryTag tag);
+	~ScopedMemoryTag();
+	ScopedMemoryTag(ScopedMemoryTag const& copyFrom) = delete;
+	ScopedMemoryTag& operator=(ScopedMemoryTag const& copyFrom) = delete;
+
+private:
+	MemoryTag m_previousTag = MemoryTag::UNTAGGED;
+};
+
+
+//counts every global operator new in the process, so a frame or a test can show how much it allocated; 0 without ENABLE_ALLOCATION_COUNTING
+uint64_t GetNumHeapAllocations();
+uint64_t GetNumHeapBytesAllocated();
+
+//per-tag reporting
+bool		   IsAllocationCountingEnabled();
+bool		   IsMemoryTrackingEnabled();
+char const*	   GetMemoryTagName(MemoryTag tag);
+MemoryTagStats GetMemoryTagStats(MemoryTag tag);
+void		   CaptureMemoryTagStats(MemoryTagStats* out_statsPerTag);	//fills NUM_MEMORY_TAGS entries
+void		   MarkMemoryFrame();	//once per frame, before anything else allocates
+MemoryTagStats GetLastFrameMemoryStats(MemoryTag tag);
+void		   ResetMemoryHighWaterMarks();	//peaks restart from what is live now
+std::string	   GetMemoryTrackingSummary(MemoryTagStats const* startStatsPerTag = nullptr);	//one line per tag; totals since startStatsPerTag when given
@@ -1,6 +1,8 @@
 #include "Game/App.hpp"
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/FrameArena.hpp"
+#include "Game/AllocationCounter.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Audio/AudioSystem.hpp"
@@ -84,12 +86,36 @@ void App::Startup()
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " 1-6: Debug Spawn Bloons");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " Left Shift + 1-6: Hold to Spawn Bloons");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " F2: Draw All Tower Ranges");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " F5: Toggle Bloon Crowd Level of Detail");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " F6: Toggle Memory Overlay");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " F8: Restart Game");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " T: Slow Speed");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " Y: Fast Speed");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " T+Y: Super Fast Speed");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " P: Pause Time");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " O: Progress 1 Frame");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, "");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, "Console Commands: ");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " WriteMap Name=<name>: Export the current track to Data/Exported as XML and binary");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " ExportTracks: Write every map's track to Data/Tracks as binary");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " SaveGame Name=<name>: Snapshot the full game state to Data/Saves");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " LoadGame Name=<name>: Restore a saved snapshot");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " StartRecording: Record player commands from the current state");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " StopRecording Name=<name>: Save the recording to Data/Replays");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " PlayReplay Name=<name>: Re-simulate a replay headless and verify every tick");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " CheckDeterminism Option=<name> Replay=<name> Ticks=<n>: Run with and without an option, report first divergence");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " OptimizeLayout Map=<name> Budget=<money> Candidates=<n> Rounds=<n> PruneBelow=<round> Cache=<name>: Search tower layouts headless on all cores");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " ThreadedSimulation Enabled=<bool>: Step the simulation on its own thread alongside rendering");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " BenchmarkProjectiles Count=<n> Ticks=<n> Projectile=<name>: Time headless updates of many straight projectiles");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " MemoryStats ResetPeaks=<bool>: Print live, peak and total allocation per subsystem");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " Freeplay Seed=<n> Round=<n>: Keep generating rounds past the last one, optionally skipping ahead");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " SpawnBloons Bloon=<name> Count=<n> Spacing=<distance>: Lay bloons down the track from the start");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " PlaceTowerGrid Tower=<name> Spacing=<distance> Path=<1|2> Upgrades=<n> Max=<n>: Fill the playfield with free towers");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " RunTicks Ticks=<n> DeltaSeconds=<s>: Step the game flat out without rendering and report per-phase timings");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " Telemetry Enabled=<bool> Format=<csv|json|both> Run=<name>: Write what each tower popped, hit and fired after every round");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " RunBatch File=<xml> Workers=<n>: Play a file of scenarios in headless games across all cores and write a report");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " EstimateCoverage First=<n> Last=<n> Validate=<bool>: Predict leaks per round from tower coverage, optionally against the simulator");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " StepEnvironments Envs=<n> Steps=<n> Map=<index> Grid=<cells>: Drive headless training environments through their C interface and report");
 }
 
 
@@ -144,7 +170,13 @@ void App::RunFrame()
 	//run through the four parts of the frame
 	BeginFrame();
 	Update();
+
+	//the simulation step overlaps rendering, so render allocations include the step's when it's threaded
+	g_theGame->BeginSimulationStep();
+	uint64_t renderStartNumAllocations = GetNumHeapAllocations();
 	Render();
+	m_lastRenderNumAllocations = static_cast<int>(GetNumHeapAllocations() - renderStartNumAllocations);
+	g_theGame->EndSimulationStep();
 	EndFrame();
 }
 
@@ -180,12 +212,19 @@ bool App::Event_Quit(EventArgs& args)
 //
 void App::BeginFrame()
 {
+	MarkMemoryFrame();
+	m_frameStartNumAllocations = GetNumHeapAllocations();
+	g_frameArena.Reset();
+
 	g_theEventSystem->BeginFrame();
 	g_theDevConsole->BeginFrame();
 	g_theInput->BeginFrame();
 	g_theWindow->BeginFrame();
 	g_theRenderer->BeginFrame();
-	g_theAudio->BeginFrame();
+	{
+		ScopedMemoryTag memoryTag(MemoryTag::AUDIO);
+		g_theAudio->BeginFrame();
+	}
 
 	DebugRenderBeginFrame();
 }
@@ -225,6 +264,8 @@ void App::Update()
 
 void App::Render() const
 {	
+	ScopedMemoryTag memoryTag(MemoryTag::RENDERING);
+
 	g_theGame->Render();
 
 	//render dev console separately from and after rest of game
@@ -241,9 +282,14 @@ void App::EndFrame()
 	g_theInput->EndFrame();
 	g_theWindow->EndFrame();
 	g_theRenderer->EndFrame();
-	g_theAudio->EndFrame();
+	{
+		ScopedMemoryTag memoryTag(MemoryTag::AUDIO);
+		g_theAudio->EndFrame();
+	}
 
 	DebugRenderEndFrame();
+
+	m_lastFrameNumAllocations = static_cast<int>(GetNumHeapAllocations() - m_frameStartNumAllocations);
 }
 
 
@@ -15,6 +15,8 @@ public:
 
 	//app utilities
 	bool IsQuitting() const { return m_isQuitting; }
+	int  GetLastFrameNumAllocations() const { return m_lastFrameNumAllocations; }
+	int  GetLastRenderNumAllocations() const { return m_lastRenderNumAllocations; }
 	bool HandleQuitRequested();
 
 	//static app utilites
@@ -35,4 +37,8 @@ private:
 private:
 	bool m_isQuitting = false;
 	Camera m_devConsoleCamera;
+
+	uint64_t m_frameStartNumAllocations = 0;
+	int m_lastFrameNumAllocations = 0;
+	int m_lastRenderNumAllocations = 0;
 };
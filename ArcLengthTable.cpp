@@ -0,0 +1,47 @@
+#include "Game/ArcLengthTable.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <algorithm>
+
+
+//
+//public member functions
+//
+void ArcLengthTable::Build(CubicBezierCurve2D const& curve)
+{
+	m_points[0] = curve.EvaluateAtParametric(0.0f);
+	m_cumulativeLengths[0] = 0.0f;
+
+	for (int subdivIndex = 0; subdivIndex < NUM_CURVE_SUBDIVISIONS; subdivIndex++)
+	{
+		float segmentEndT = static_cast<float>(subdivIndex + 1) * (1.0f / NUM_CURVE_SUBDIVISIONS);
+		m_points[subdivIndex + 1] = curve.EvaluateAtParametric(segmentEndT);
+		m_cumulativeLengths[subdivIndex + 1] = m_cumulativeLengths[subdivIndex] + GetDistance2D(m_points[subdivIndex], m_points[subdivIndex + 1]);
+	}
+}
+
+
+Vec2 ArcLengthTable::EvaluateAtDistance(float distance) const
+{
+	if (distance <= 0.0f)
+	{
+		return m_points[0];
+	}
+	if (distance >= GetTotalLength())
+	{
+		return m_points[NUM_CURVE_SUBDIVISIONS];
+	}
+
+	//find the first segment whose end is past the given distance, then lerp along it
+	float const* segmentEnd = std::upper_bound(m_cumulativeLengths, m_cumulativeLengths + NUM_CURVE_SUBDIVISIONS + 1, distance);
+	int endIndex = static_cast<int>(segmentEnd - m_cumulativeLengths);
+	int startIndex = endIndex - 1;
+
+	float segmentLength = m_cumulativeLengths[endIndex] - m_cumulativeLengths[startIndex];
+	if (segmentLength <= 0.0f)
+	{
+		return m_points[startIndex];
+	}
+
+	float fraction = (distance - m_cumulativeLengths[startIndex]) / segmentLength;
+	return m_points[startIndex] + (m_points[endIndex] - m_points[startIndex]) * fraction;
+}
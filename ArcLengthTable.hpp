@@ -0,0 +1,33 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/CubicBezierCurve2D.hpp"
+
+
+class ArcLengthTable
+{
+//public member functions
+public:
+	void Build(CubicBezierCurve2D const& curve);
+
+	Vec2  EvaluateAtDistance(float distance) const;
+	float GetTotalLength() const { return m_cumulativeLengths[NUM_CURVE_SUBDIVISIONS]; }
+
+//public member variables
+public:
+	Vec2  m_points[NUM_CURVE_SUBDIVISIONS + 1];
+	float m_cumulativeLengths[NUM_CURVE_SUBDIVISIONS + 1] = {};
+};
+
+
+//a tower's boomerang path, shared by the tower and every projectile currently flying along it
+struct CurvedProjectileArc
+{
+	CubicBezierCurve2D m_curve = CubicBezierCurve2D();
+	ArcLengthTable	   m_arcLengths;
+
+	Vec2 m_origin = Vec2();
+	Vec2 m_iBasis = Vec2();
+
+	int m_numReferences = 0;
+};
@@ -0,0 +1,329 @@
+#include "Game/BatchRunner.hpp"
+#include "Game/WorkerPool.hpp"
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Game/TowerDefinition.hpp"
+#include "Game/RoundDefinition.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/FileUtils.hpp"
+
+
+constexpr int MAX_BATCH_TICKS_PER_ROUND = 60 * 60 * 10;
+
+
+//
+//local helper functions
+//
+static bool ParseBatchScenario(XmlElement const& element, BatchScenario& scenario, std::string& out_error)
+{
+	scenario.m_name = ParseXmlAttribute(element, "name", scenario.m_name);
+
+	std::string mapName = ParseXmlAttribute(element, "map", "");
+	MapDefinition const* mapDef = MapDefinition::GetMapDefinitionByName(mapName);
+	if (mapDef == nullptr)
+	{
+		out_error = Stringf("Scenario %s has unknown map %s", scenario.m_name.c_str(), mapName.c_str());
+		return false;
+	}
+	scenario.m_mapIndex = static_cast<int>(mapDef - MapDefinition::s_mapDefinitions.data());
+
+	scenario.m_firstRound = ParseXmlAttribute(element, "firstRound", scenario.m_firstRound);
+	scenario.m_lastRound = ParseXmlAttribute(element, "lastRound", scenario.m_lastRound);
+	scenario.m_seed = ParseXmlAttribute(element, "seed", scenario.m_seed);
+	scenario.m_deltaSeconds = ParseXmlAttribute(element, "deltaSeconds", scenario.m_deltaSeconds);
+	scenario.m_startingMoney = ParseXmlAttribute(element, "money", scenario.m_startingMoney);
+	scenario.m_startingLives = ParseXmlAttribute(element, "lives", scenario.m_startingLives);
+	if (scenario.m_firstRound < 1 || scenario.m_lastRound < scenario.m_firstRound || scenario.m_deltaSeconds <= 0.0f)
+	{
+		out_error = Stringf("Scenario %s needs 1 <= firstRound <= lastRound and a positive deltaSeconds", scenario.m_name.c_str());
+		return false;
+	}
+
+	XmlElement const* towerElement = element.FirstChildElement();
+	while (towerElement != nullptr)
+	{
+		std::string elementName = towerElement->Name();
+		if (elementName != "Tower")
+		{
+			out_error = Stringf("Child elements of scenario %s must be <Tower>", scenario.m_name.c_str());
+			return false;
+		}
+
+		BatchTowerPlacement placement;
+		std::string towerName = ParseXmlAttribute(*towerElement, "name", "");
+		placement.m_definition = TowerDefinition::GetTowerDefinitionByName(towerName);
+		if (placement.m_definition == nullptr)
+		{
+			out_error = Stringf("Scenario %s has unknown tower %s", scenario.m_name.c_str(), towerName.c_str());
+			return false;
+		}
+		placement.m_position = ParseXmlAttribute(*towerElement, "position", placement.m_position);
+		placement.m_upgradePath = ParseXmlAttribute(*towerElement, "path", placement.m_upgradePath);
+		placement.m_numUpgrades = ParseXmlAttribute(*towerElement, "upgrades", placement.m_numUpgrades);
+		placement.m_numTargetingToggles = ParseXmlAttribute(*towerElement, "targetingToggles", placement.m_numTargetingToggles);
+		scenario.m_towers.emplace_back(placement);
+
+		towerElement = towerElement->NextSiblingElement();
+	}
+
+	return true;
+}
+
+
+//the same commands a player would issue, so a placement the money or the track rules out is skipped the same way
+static int BuyBatchLayout(Game& game, BatchScenario const& scenario)
+{
+	int numPlaced = 0;
+
+	for (int towerIndex = 0; towerIndex < scenario.m_towers.size(); towerIndex++)
+	{
+		BatchTowerPlacement const& placement = scenario.m_towers[towerIndex];
+
+		GameCommand placeCommand;
+		placeCommand.m_type = GameCommandType::PLACE_TOWER;
+		placeCommand.m_index = static_cast<int>(placement.m_definition - TowerDefinition::s_towerDefinitions.data());
+		placeCommand.m_position = placement.m_position;
+		if (!game.m_currentMap->IsValidTowerPlacement(placement.m_definition, placement.m_position) || !game.ExecuteCommand(placeCommand)) continue;
+		numPlaced++;
+
+		int towerSlot = static_cast<int>(game.m_currentMap->m_towers.size()) - 1;
+		for (int upgradeIndex = 0; upgradeIndex < placement.m_numUpgrades; upgradeIndex++)
+		{
+			GameCommand upgradeCommand;
+			upgradeCommand.m_type = placement.m_upgradePath == 2 ? GameCommandType::BUY_UPGRADE_2 : GameCommandType::BUY_UPGRADE_1;
+			upgradeCommand.m_index = towerSlot;
+			if (!game.ExecuteCommand(upgradeCommand)) break;
+		}
+		for (int toggleIndex = 0; toggleIndex < placement.m_numTargetingToggles; toggleIndex++)
+		{
+			GameCommand toggleCommand;
+			toggleCommand.m_type = GameCommandType::TOGGLE_TARGETING_MODE;
+			toggleCommand.m_index = towerSlot;
+			game.ExecuteCommand(toggleCommand);
+		}
+	}
+
+	return numPlaced;
+}
+
+
+static void RunBatchScenario(Game& game, std::vector<uint8_t> const& baseSnapshot, BatchScenario const& scenario, BatchScenarioResult& result)
+{
+	double startTime = GetCurrentTimeSeconds();
+
+	if (!game.ReadSnapshot(baseSnapshot))
+	{
+		result.m_didRestoreFail = true;
+		return;
+	}
+	game.m_numMoney = scenario.m_startingMoney;
+	game.m_numLives = scenario.m_startingLives;
+
+	//rounds past the authored ones come from freeplay, which also takes care of skipping ahead
+	int numAuthoredRounds = static_cast<int>(RoundDefinition::s_roundDefinitions.size());
+	if (scenario.m_lastRound > numAuthoredRounds)
+	{
+		GameCommand freeplayCommand;
+		freeplayCommand.m_type = GameCommandType::ENTER_FREEPLAY;
+		freeplayCommand.m_index = static_cast<int>(scenario.m_seed);
+		freeplayCommand.m_position.x = static_cast<float>(scenario.m_firstRound);
+		game.ExecuteCommand(freeplayCommand);
+	}
+	else
+	{
+		game.m_roundNumber = scenario.m_firstRound;
+	}
+
+	result.m_numTowersPlaced = BuyBatchLayout(game, scenario);
+
+	for (int roundNumber = scenario.m_firstRound; roundNumber <= scenario.m_lastRound; roundNumber++)
+	{
+		GameCommand startCommand;
+		startCommand.m_type = GameCommandType::START_ROUND;
+		if (!game.ExecuteCommand(startCommand)) break;
+
+		int tickIndex = 0;
+		for (; tickIndex < MAX_BATCH_TICKS_PER_ROUND && game.m_isRoundActive; tickIndex++)
+		{
+			game.UpdateSimulation(scenario.m_deltaSeconds);
+		}
+		result.m_numTicksRun += tickIndex;
+		result.m_numRoundsPlayed++;
+
+		//a round that never ends counts as a loss, the same as in the layout optimizer
+		if (game.m_numLives <= 0 || game.m_isRoundActive)
+		{
+			result.m_wasLost = true;
+			break;
+		}
+		result.m_roundsSurvived++;
+
+		//the game over timer also starts when the last authored round is won
+		if (game.m_resetTimer > 0.0f) break;
+	}
+
+	result.m_livesLost = scenario.m_startingLives - game.m_numLives;
+	result.m_moneyLeft = game.m_numMoney;
+	result.m_secondsElapsed = GetCurrentTimeSeconds() - startTime;
+}
+
+
+//
+//public functions
+//
+bool LoadBatchScenarios(std::string const& filePath, std::vector<BatchScenario>& out_scenarios, std::string& out_error)
+{
+	XmlDocument batchXml;
+	if (batchXml.LoadFile(filePath.c_str()) != tinyxml2::XML_SUCCESS)
+	{
+		out_error = Stringf("Failed to open batch file %s", filePath.c_str());
+		return false;
+	}
+
+	XmlElement* rootElement = batchXml.RootElement();
+	if (rootElement == nullptr)
+	{
+		out_error = Stringf("Batch file %s has no root element", filePath.c_str());
+		return false;
+	}
+
+	XmlElement const* scenarioElement = rootElement->FirstChildElement();
+	while (scenarioElement != nullptr)
+	{
+		std::string elementName = scenarioElement->Name();
+		if (elementName != "Scenario")
+		{
+			out_error = Stringf("Child elements in batch file %s must be <Scenario>", filePath.c_str());
+			return false;
+		}
+
+		BatchScenario scenario;
+		scenario.m_name = Stringf("Scenario%i", static_cast<int>(out_scenarios.size()));
+		if (!ParseBatchScenario(*scenarioElement, scenario, out_error))
+		{
+			return false;
+		}
+		out_scenarios.emplace_back(scenario);
+
+		scenarioElement = scenarioElement->NextSiblingElement();
+	}
+
+	return true;
+}
+
+
+BatchReport RunBatch(std::vector<BatchScenario> const& scenarios, int numWorkers)
+{
+	BatchReport report;
+	report.m_results.resize(scenarios.size());
+
+	WorkerPool workerPool = WorkerPool(numWorkers);
+	report.m_numWorkers = workerPool.GetNumWorkers();
+
+	std::vector<Game*> workerGames = Game::CreateHeadlessGames(report.m_numWorkers);
+
+	//every scenario starts from a fresh snapshot of its map
+	std::vector<std::vector<uint8_t>> baseSnapshots;
+	baseSnapshots.resize(MapDefinition::s_mapDefinitions.size());
+	for (int scenarioIndex = 0; scenarioIndex < scenarios.size(); scenarioIndex++)
+	{
+		int mapIndex = scenarios[scenarioIndex].m_mapIndex;
+		if (baseSnapshots[mapIndex].empty())
+		{
+			workerGames[0]->WriteFreshMapSnapshot(mapIndex, baseSnapshots[mapIndex]);
+		}
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+
+	for (int scenarioIndex = 0; scenarioIndex < scenarios.size(); scenarioIndex++)
+	{
+		workerPool.AddJob([&, scenarioIndex](int workerIndex)
+		{
+			BatchScenario const& scenario = scenarios[scenarioIndex];
+			RunBatchScenario(*workerGames[workerIndex], baseSnapshots[scenario.m_mapIndex], scenario, report.m_results[scenarioIndex]);
+		});
+	}
+	workerPool.WaitForAllJobs();
+
+	report.m_secondsElapsed = GetCurrentTimeSeconds() - startTime;
+	for (int resultIndex = 0; resultIndex < report.m_results.size(); resultIndex++)
+	{
+		report.m_numTicksRun += report.m_results[resultIndex].m_numTicksRun;
+	}
+
+	Game::DestroyHeadlessGames(workerGames);
+
+	return report;
+}
+
+
+std::string GetBatchReportAsCSV(std::vector<BatchScenario> const& scenarios, BatchReport const& report)
+{
+	std::string text = "scenario,map,firstRound,lastRound,seed,deltaSeconds,failed,towersPlaced,roundsPlayed,roundsSurvived,lost,livesLost,moneyLeft,ticks,seconds,ticksPerSecond\n";
+
+	for (int scenarioIndex = 0; scenarioIndex < scenarios.size(); scenarioIndex++)
+	{
+		BatchScenario const& scenario = scenarios[scenarioIndex];
+		BatchScenarioResult const& result = report.m_results[scenarioIndex];
+		double ticksPerSecond = result.m_secondsElapsed > 0.0 ? static_cast<double>(result.m_numTicksRun) / result.m_secondsElapsed : 0.0;
+		text += Stringf("%s,%s,%i,%i,%u,%.6f,%i,%i,%i,%i,%i,%i,%i,%i,%.3f,%.0f\n", scenario.m_name.c_str(), MapDefinition::s_mapDefinitions[scenario.m_mapIndex].m_name.c_str(),
+			scenario.m_firstRound, scenario.m_lastRound, scenario.m_seed, scenario.m_deltaSeconds, result.m_didRestoreFail ? 1 : 0, result.m_numTowersPlaced, result.m_numRoundsPlayed, result.m_roundsSurvived,
+			result.m_wasLost ? 1 : 0, result.m_livesLost, result.m_moneyLeft, result.m_numTicksRun, result.m_secondsElapsed, ticksPerSecond);
+	}
+
+	double totalTicksPerSecond = report.m_secondsElapsed > 0.0 ? static_cast<double>(report.m_numTicksRun) / report.m_secondsElapsed : 0.0;
+	text += Stringf("total,,,,,,,,,,,,,%llu,%.3f,%.0f\n", report.m_numTicksRun, report.m_secondsElapsed, totalTicksPerSecond);
+
+	return text;
+}
+
+
+std::string GetBatchOutputPath(std::string const& filePath, std::string const& suffix)
+{
+	std::string outputPath = filePath;
+	size_t extensionStart = outputPath.rfind(".xml");
+	if (extensionStart != std::string::npos)
+	{
+		outputPath.erase(extensionStart);
+	}
+	return outputPath + suffix;
+}
+
+
+bool RunBatchFile(std::string const& filePath, int numWorkers, std::string& out_summary)
+{
+	//scenario files name towers and maps, so definitions have to be in before they're read
+	Game::LoadDefinitions();
+
+	std::string summaryPath = GetBatchOutputPath(filePath, "_Summary.txt");
+	std::vector<BatchScenario> scenarios;
+	if (!LoadBatchScenarios(filePath, scenarios, out_summary))
+	{
+		FileWriteFromBuffer(std::vector<uint8_t>(out_summary.begin(), out_summary.end()), summaryPath);
+		return false;
+	}
+
+	BatchReport report = RunBatch(scenarios, numWorkers);
+
+	std::string reportPath = GetBatchOutputPath(filePath, "_Report.csv");
+	std::string reportText = GetBatchReportAsCSV(scenarios, report);
+	FileWriteFromBuffer(std::vector<uint8_t>(reportText.begin(), reportText.end()), reportPath);
+
+	//scenarios that never got going are reported on their own rather than counted as survivors
+	int numSurvived = 0;
+	int numFailed = 0;
+	for (int resultIndex = 0; resultIndex < report.m_results.size(); resultIndex++)
+	{
+		BatchScenarioResult const& result = report.m_results[resultIndex];
+		if (result.m_didRestoreFail) numFailed++;
+		else if (!result.m_wasLost) numSurvived++;
+	}
+	double ticksPerSecond = report.m_secondsElapsed > 0.0 ? static_cast<double>(report.m_numTicksRun) / report.m_secondsElapsed : 0.0;
+	out_summary = Stringf("Ran %i scenarios in %.2f s on %i workers (%.0f ticks/s, %.0f per worker), %i survived every round, %i failed to start; report in %s",
+		static_cast<int>(scenarios.size()), report.m_secondsElapsed, report.m_numWorkers, ticksPerSecond, ticksPerSecond / static_cast<double>(report.m_numWorkers), numSurvived,
+		numFailed, reportPath.c_str());
+	FileWriteFromBuffer(std::vector<uint8_t>(out_summary.begin(), out_summary.end()), summaryPath);
+	return numFailed == 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+
+
+class TowerDefinition;
+
+
+struct BatchTowerPlacement
+{
+	TowerDefinition const* m_definition = nullptr;
+	Vec2 m_position = Vec2();
+	int	 m_upgradePath = 1;
+	int	 m_numUpgrades = 0;
+	int	 m_numTargetingToggles = 0;	//steps through targeting modes from First
+};
+
+
+//one independent game: a layout bought on a fresh map, then a range of rounds played out
+struct BatchScenario
+{
+	std::string m_name;
+	int		 m_mapIndex = 0;
+	int		 m_firstRound = 1;
+	int		 m_lastRound = 40;			//past the authored rounds plays freeplay rounds from m_seed
+	uint32_t m_seed = 0x5EED0B10;
+	float	 m_deltaSeconds = 1.0f / 60.0f;
+	int		 m_startingMoney = 650;
+	int		 m_startingLives = 100;
+	std::vector<BatchTowerPlacement> m_towers;
+};
+
+
+struct BatchScenarioResult
+{
+	int		m_numTowersPlaced = 0;		//placements the starting money couldn't cover are skipped
+	int		m_numRoundsPlayed = 0;
+	int		m_roundsSurvived = 0;
+	int		m_livesLost = 0;
+	int		m_moneyLeft = 0;
+	bool	m_wasLost = false;
+	bool	m_didRestoreFail = false;	//the map's base snapshot wouldn't restore, so nothing was played
+	int		m_numTicksRun = 0;
+	double	m_secondsElapsed = 0.0;
+};
+
+
+struct BatchReport
+{
+	std::vector<BatchScenarioResult> m_results;	//same order as the scenarios
+	int		 m_numWorkers = 0;
+	double	 m_secondsElapsed = 0.0;
+	uint64_t m_numTicksRun = 0;
+};
+
+
+//scenarios come from an xml file of <Scenario> elements, each with <Tower> children
+bool LoadBatchScenarios(std::string const& filePath, std::vector<BatchScenario>& out_scenarios, std::string& out_error);
+
+//every scenario runs in a headless game on a worker thread, one game per worker, and needs nothing global but loaded definitions
+BatchReport RunBatch(std::vector<BatchScenario> const& scenarios, int numWorkers = 0);
+
+std::string GetBatchReportAsCSV(std::vector<BatchScenario> const& scenarios, BatchReport const& report);
+
+//<name><suffix> next to the batch file <name>.xml
+std::string GetBatchOutputPath(std::string const& filePath, std::string const& suffix);
+
+//loads definitions and the scenarios, runs them and writes the report and summary next to the batch file as <name>_Report.csv
+//and <name>_Summary.txt; works without a window, renderer or audio system, so it also backs the -batch=<file> command line
+bool RunBatchFile(std::string const& filePath, int numWorkers, std::string& out_summary);
@@ -2,9 +2,11 @@
 #include "Game/BloonDefinition.hpp"
 #include "Game/GameCommon.hpp"
 #include "Game/Map.hpp"
-#include "Game/Projectile.hpp"
+#include "Game/ProjectilePool.hpp"
 #include "Game/ProjectileDefinition.hpp"
 #include "Game/Game.hpp"
+#include "Game/RoundTelemetry.hpp"
+#include "Game/StateHash.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Math/MathUtils.hpp"
@@ -27,34 +29,16 @@ Bloon::Bloon(BloonDefinition const* definition, Map const* map, CubicBezierCurve
 
 	if (m_trackDistance < 0.0f) m_trackDistance = 0.0f;
 
-	//#TO-DO: After map splines are finalized, calculate this once ahead of time and store in Map
-	float totalSplineDistance = 0.0f;
-	for (int curveIndex = 0; curveIndex < m_map->m_trackSpline.size(); curveIndex++)
-	{
-		totalSplineDistance += m_map->m_trackSpline[curveIndex].GetApproximateLength(NUM_CURVE_SUBDIVISIONS);
-	}
+	UpdatePositionOnTrack();
+}
 
-	//calculate new position along track
-	float approximateDistanceOnSpline = m_trackDistance;
-	float approximateDistanceOnCurve = 0.0f;
-	int curveNum = 0;
-	for (int curveIndex = 0; curveIndex < m_map->m_trackSpline.size(); curveIndex++)
-	{
-		float curveAproxLength = m_map->m_trackSpline[curveIndex].GetApproximateLength(NUM_CURVE_SUBDIVISIONS);
-		if (approximateDistanceOnSpline > curveAproxLength)
-		{
-			approximateDistanceOnSpline -= curveAproxLength;
-		}
-		else
-		{
-			approximateDistanceOnCurve = approximateDistanceOnSpline;
-			curveNum = curveIndex;
-			break;
-		}
-	}
-	m_position = m_map->m_trackSpline[curveNum].EvaluateAtApproximateDistance(approximateDistanceOnCurve, NUM_CURVE_SUBDIVISIONS);
+Bloon::Bloon(BloonDefinition const* definition, Map const* map)
+	: m_definition(definition)
+	, m_map(map)
+{
 }
 
+
 //
 //public game flow functions
 //
@@ -67,71 +51,21 @@ void Bloon::Update(float deltaSeconds)
 		return;
 	}
 
-	//#TO-DO: After map splines are finalized, calculate this once ahead of time and store in Map
-	float totalSplineDistance = 0.0f;
-	for (int curveIndex = 0; curveIndex < m_map->m_trackSpline.size(); curveIndex++)
-	{
-		totalSplineDistance += m_map->m_trackSpline[curveIndex].GetApproximateLength(NUM_CURVE_SUBDIVISIONS);
-	}
-
-	//move along track based on speed
+	//move along track based on speed; the map's leak queue notices when this passes the end
 	m_trackDistance += m_definition->m_speed * deltaSeconds;
 
-	//if bloon is past end of track, leak
-	if (m_trackDistance >= totalSplineDistance)
-	{
-		Leak();
-		return;
-	}
-
-	//calculate new position along track
-	float approximateDistanceOnSpline = m_trackDistance;
-	float approximateDistanceOnCurve = 0.0f;
-	int curveNum = 0;
-	for (int curveIndex = 0; curveIndex < m_map->m_trackSpline.size(); curveIndex++)
-	{
-		float curveAproxLength = m_map->m_trackSpline[curveIndex].GetApproximateLength(NUM_CURVE_SUBDIVISIONS);
-		if (approximateDistanceOnSpline > curveAproxLength)
-		{
-			approximateDistanceOnSpline -= curveAproxLength;
-		}
-		else
-		{
-			approximateDistanceOnCurve = approximateDistanceOnSpline;
-			curveNum = curveIndex;
-			break;
-		}
-	}
-	m_position = m_map->m_trackSpline[curveNum].EvaluateAtApproximateDistance(approximateDistanceOnCurve, NUM_CURVE_SUBDIVISIONS);
-}
-
-
-void Bloon::Render() const
-{
-	//#TODO: Replace current system with having all bloons in one draw call using spritesheet
-	std::vector<Vertex_PCU> verts;
-
-	float const& size = m_definition->m_size;
-	AABB2 renderBounds = AABB2(m_position.x - size, m_position.y - size, m_position.x + size, m_position.y + size);
-
-	AddVertsForAABB2(verts, renderBounds, m_definition->m_color);
-
-	if (m_freezeTimer > 0.0f)
-	{
-		AddVertsForAABB2(verts, renderBounds, Rgba8(255, 255, 255, 150));
-	}
-
-	g_theRenderer->DrawVertexArray(verts);
+	UpdatePositionOnTrack();
 }
 
 
 //
 //public gameplay functions
 //
-void Bloon::TakeDamage(Projectile& damageSource)
+void Bloon::TakeDamage(ProjectilePool& projectiles, int damageSourceIndex)
 {
-	DamageType damageType = damageSource.m_definition->m_damageType;
-	int damageAmount = damageSource.m_definition->m_damage;
+	ProjectileDefinition const* damageSourceDef = projectiles.GetDefinition(damageSourceIndex);
+	DamageType damageType = damageSourceDef->m_damageType;
+	int damageAmount = damageSourceDef->m_damage;
 
 	bool immune = false;
 	//if frozen, check if damage is Sharp or Freeze
@@ -152,21 +86,28 @@ void Bloon::TakeDamage(Projectile& damageSource)
 		}
 	}
 
+	RoundTelemetry* telemetry = m_map->m_game->m_roundTelemetry;
+	if (telemetry != nullptr)
+	{
+		telemetry->CountHit(projectiles.m_coldData[damageSourceIndex].m_ownerTowerSlot, m_definition, immune ? 0 : damageAmount);
+	}
+
 	if (!immune)
 	{
 		m_currentHealth -= damageAmount;
 		if (m_currentHealth <= 0)
 		{
-			Pop(damageSource);
+			Pop(damageSourceIndex);
 		}
 		else
 		{
-			if (damageSource.m_definition->m_freezeTimer + damageSource.m_addedFreezeTime > 0.0f)
+			float addedFreezeTime = projectiles.m_coldData[damageSourceIndex].m_addedFreezeTime;
+			if (damageSourceDef->m_freezeTimer + addedFreezeTime > 0.0f)
 			{
-				m_freezeTimer = damageSource.m_definition->m_freezeTimer + damageSource.m_addedFreezeTime;
+				m_freezeTimer = damageSourceDef->m_freezeTimer + addedFreezeTime;
 			}
 
-			damageSource.m_bloonsToPassOver.emplace_back(this);
+			projectiles.AddHitBloon(damageSourceIndex, this);
 		}
 	}
 	else
@@ -179,22 +120,28 @@ void Bloon::TakeDamage(Projectile& damageSource)
 		//play immunity sound
 		if (m_freezeTimer > 0.0f && damageType != DamageType::Freeze)
 		{
-			g_theAudio->StartSound(g_theGame->m_frozenHitSound, false, 0.9f);
+			m_map->m_game->PlaySound(m_map->m_game->m_frozenHitSound, 0.9f);
 		}
 		else
 		{
-			if (m_definition->m_noDamageSound != 0) g_theAudio->StartSound(m_definition->m_noDamageSound, false, 0.95f);
+			if (m_definition->m_noDamageSound != 0) m_map->m_game->PlaySound(m_definition->m_noDamageSound, 0.95f);
 		}
 	}
 }
 
 
-void Bloon::Pop(Projectile& popper)
+void Bloon::Pop(int popperIndex)
 {
 	m_hasPopped = true;
-	m_popper = &popper;
+	m_popperIndex = popperIndex;
 
-	g_theAudio->StartSound(m_definition->m_popSound, false, 0.64f);
+	RoundTelemetry* telemetry = m_map->m_game->m_roundTelemetry;
+	if (telemetry != nullptr)
+	{
+		telemetry->CountPop(m_map->m_projectiles.m_coldData[popperIndex].m_ownerTowerSlot, m_definition);
+	}
+
+	m_map->m_game->PlaySound(m_definition->m_popSound, 0.64f);
 }
 
 
@@ -202,3 +149,59 @@ void Bloon::Leak()
 {
 	m_hasLeaked = true;
 }
+
+
+//
+//public determinism functions
+//
+uint64_t Bloon::GetStateHash() const
+{
+	uint64_t hash = STATE_HASH_SEED;
+	hash = HashWord(hash, static_cast<int>(m_definition - BloonDefinition::s_bloonDefinitions.data()));
+	hash = HashWord(hash, m_position);
+	hash = HashWord(hash, m_trackDistance);
+	hash = HashWord(hash, m_currentHealth);
+	hash = HashWord(hash, m_freezeTimer);
+	return hash;
+}
+
+
+std::string Bloon::GetStateDescription() const
+{
+	return Stringf("%s pos=(%.9g, %.9g) trackDist=%.9g curve=%i health=%i freeze=%.9g", m_definition->m_name.c_str(), m_position.x, m_position.y, m_trackDistance, m_splineCurveIndex,
+		m_currentHealth, m_freezeTimer);
+}
+
+
+//
+//private track functions
+//
+void Bloon::UpdatePositionOnTrack()
+{
+	if (m_map->m_game->m_simConfig.m_useArcLengthTables)
+	{
+		m_position = m_map->GetTrackPositionAtDistance(m_trackDistance);
+		return;
+	}
+
+	//a bloon past the end stays at the end for the tick before the leak queue removes it
+	float approximateDistanceOnSpline = m_trackDistance;
+	float approximateDistanceOnCurve = approximateDistanceOnSpline;
+	int curveNum = static_cast<int>(m_map->m_trackSpline.size()) - 1;
+	for (int curveIndex = 0; curveIndex < m_map->m_trackSpline.size(); curveIndex++)
+	{
+		float curveAproxLength = m_map->m_trackSpline[curveIndex].GetApproximateLength(NUM_CURVE_SUBDIVISIONS);
+		if (approximateDistanceOnSpline > curveAproxLength)
+		{
+			approximateDistanceOnSpline -= curveAproxLength;
+			approximateDistanceOnCurve = curveAproxLength;
+		}
+		else
+		{
+			approximateDistanceOnCurve = approximateDistanceOnSpline;
+			curveNum = curveIndex;
+			break;
+		}
+	}
+	m_position = m_map->m_trackSpline[curveNum].EvaluateAtApproximateDistance(approximateDistanceOnCurve, NUM_CURVE_SUBDIVISIONS);
+}
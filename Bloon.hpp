@@ -3,11 +3,12 @@
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Math/CubicBezierCurve2D.hpp"
+#include <string>
 
 
 class BloonDefinition;
 class Map;
-class Projectile;
+class ProjectilePool;
 
 
 class Bloon
@@ -15,16 +16,20 @@ class Bloon
 //public member functions
 public:
 	Bloon(BloonDefinition const* definition, Map const* map, CubicBezierCurve2D const* startingCurve, float trackDistance = 0.0f);
+	Bloon(BloonDefinition const* definition, Map const* map);	//for restoring from a snapshot, caller fills in the rest
 
 	//game flow functions
 	void Update(float deltaSeconds);
-	void Render() const;
 
 	//gameplay functions
-	void TakeDamage(Projectile& damageSource);
-	void Pop(Projectile& popper);
+	void TakeDamage(ProjectilePool& projectiles, int damageSourceIndex);
+	void Pop(int popperIndex);
 	void Leak();
 
+	//determinism functions
+	uint64_t	GetStateHash() const;
+	std::string GetStateDescription() const;
+
 //public member variables
 public:
 	BloonDefinition const* m_definition = nullptr;
@@ -46,5 +51,13 @@ public:
 	bool m_hasPopped = false;
 	bool m_hasLeaked = false;
 
-	Projectile* m_popper = nullptr;
+	int m_popperIndex = -1;	//projectile slot, so its children can be added to what it passes over
+
+	int m_slotIndex = -1;
+
+	double m_leakCheckSeconds = 0.0;	//when the map's leak queue next looks at this bloon; managed by the map, never saved or hashed
+
+//private member functions
+private:
+	void UpdatePositionOnTrack();
 };
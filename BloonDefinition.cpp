@@ -14,21 +14,24 @@ BloonDefinition::BloonDefinition(XmlElement const& element)
 	m_name = ParseXmlAttribute(element, "name", m_name);
 
 	std::string textureFilePath = ParseXmlAttribute(element, "texture", "invalid path");
-	m_texture = g_theRenderer->CreateOrGetTextureFromFile(textureFilePath.c_str());
+	if (g_theRenderer != nullptr)	//headless batch runs load definitions without a renderer
+	{
+		m_texture = g_theRenderer->CreateOrGetTextureFromFile(textureFilePath.c_str());
+	}
 	m_color = ParseXmlAttribute(element, "color", m_color);
 
 	std::string popSoundFilePath = ParseXmlAttribute(element, "popSound", "invalid path");
-	if (popSoundFilePath != "invalid path")
+	if (popSoundFilePath != "invalid path" && g_theAudio != nullptr)
 	{
 		m_popSound = g_theAudio->CreateOrGetSound(popSoundFilePath);
 	}
 	std::string damageSoundFilePath = ParseXmlAttribute(element, "damageSound", "invalid path");
-	if (damageSoundFilePath != "invalid path")
+	if (damageSoundFilePath != "invalid path" && g_theAudio != nullptr)
 	{
 		m_damageSound = g_theAudio->CreateOrGetSound(damageSoundFilePath);
 	}
 	std::string noDamageSoundFilePath = ParseXmlAttribute(element, "noDamageSound", "invalid path");
-	if (noDamageSoundFilePath != "invalid path")
+	if (noDamageSoundFilePath != "invalid path" && g_theAudio != nullptr)
 	{
 		m_noDamageSound = g_theAudio->CreateOrGetSound(noDamageSoundFilePath);
 	}
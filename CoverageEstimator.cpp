@@ -0,0 +1,292 @@
+#include "Game/CoverageEstimator.hpp"
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+#include "Game/Tower.hpp"
+#include "Game/TowerDefinition.hpp"
+#include "Game/BloonDefinition.hpp"
+#include "Game/ProjectileDefinition.hpp"
+#include "Game/RoundDefinition.hpp"
+#include "Engine/Core/Time.hpp"
+#include <cmath>
+
+
+constexpr int MAX_VALIDATION_TICKS_PER_ROUND = 60 * 60 * 10;
+constexpr float VALIDATION_DELTA_SECONDS = 1.0f / 60.0f;
+
+
+//
+//local helper functions
+//
+//length of the segment from start to end that lies inside the disc
+static float GetSegmentLengthInDisc(Vec2 const& start, Vec2 const& end, Vec2 const& center, float radius)
+{
+	Vec2 segment = end - start;
+	Vec2 toStart = start - center;
+	float a = segment.x * segment.x + segment.y * segment.y;
+	if (a <= 0.0f) return 0.0f;
+
+	float b = 2.0f * (toStart.x * segment.x + toStart.y * segment.y);
+	float c = toStart.x * toStart.x + toStart.y * toStart.y - radius * radius;
+	float discriminant = b * b - 4.0f * a * c;
+	if (discriminant <= 0.0f) return 0.0f;
+
+	float root = sqrtf(discriminant);
+	float enterT = (-b - root) / (2.0f * a);
+	float exitT = (-b + root) / (2.0f * a);
+	enterT = enterT < 0.0f ? 0.0f : enterT;
+	exitT = exitT > 1.0f ? 1.0f : exitT;
+	if (exitT <= enterT) return 0.0f;
+
+	return (exitT - enterT) * sqrtf(a);
+}
+
+
+static bool IsImmune(BloonDefinition const* bloonDef, DamageType damageType)
+{
+	for (int immunityIndex = 0; immunityIndex < bloonDef->m_immunities.size(); immunityIndex++)
+	{
+		if (bloonDef->m_immunities[immunityIndex] == damageType) return true;
+	}
+	return false;
+}
+
+
+//hits of the given damage it takes to pop a bloon and everything inside it, or -1 if some layer is immune
+static float GetHitsToPop(BloonDefinition const* bloonDef, int damage, DamageType damageType, std::vector<float>& memo)
+{
+	int defIndex = static_cast<int>(bloonDef - BloonDefinition::s_bloonDefinitions.data());
+	if (memo[defIndex] != 0.0f) return memo[defIndex];
+
+	float hits = -1.0f;
+	if (damage > 0 && !IsImmune(bloonDef, damageType))
+	{
+		hits = static_cast<float>((bloonDef->m_health + damage - 1) / damage);
+		for (int childIndex = 0; childIndex < bloonDef->m_children.size(); childIndex++)
+		{
+			float childHits = GetHitsToPop(bloonDef->m_children[childIndex], damage, damageType, memo);
+			if (childHits < 0.0f)
+			{
+				hits = -1.0f;
+				break;
+			}
+			hits += childHits;
+		}
+	}
+
+	memo[defIndex] = hits;
+	return hits;
+}
+
+
+//
+//constructor
+//
+CoverageEstimator::CoverageEstimator(Map const& map)
+	: m_map(map)
+{
+	for (int towerSlot = 0; towerSlot < map.m_towers.size(); towerSlot++)
+	{
+		Tower const* tower = map.m_towers[towerSlot];
+		if (tower == nullptr) continue;
+
+		TowerCoverageEstimate coverage;
+		coverage.m_towerSlot = towerSlot;
+
+		//the arc length tables hold the same tessellation bloons move along
+		for (int curveIndex = 0; curveIndex < map.m_trackArcLengths.size(); curveIndex++)
+		{
+			Vec2 const* points = map.m_trackArcLengths[curveIndex].m_points;
+			for (int segmentIndex = 0; segmentIndex < NUM_CURVE_SUBDIVISIONS; segmentIndex++)
+			{
+				coverage.m_coveredTrackLength += GetSegmentLengthInDisc(points[segmentIndex], points[segmentIndex + 1], tower->m_position, tower->m_definition->m_range);
+			}
+		}
+
+		float cooldown = tower->m_definition->m_attackCooldown;
+		coverage.m_shotsPerSecond = cooldown > 0.0f ? 1.0f / cooldown : 0.0f;
+
+		ProjectileDefinition const* projDef = tower->m_definition->m_projectileDef;
+		std::vector<float> memo(BloonDefinition::s_bloonDefinitions.size(), 0.0f);
+		coverage.m_hitsToPop.resize(BloonDefinition::s_bloonDefinitions.size(), 0.0f);
+		for (int bloonDefIndex = 0; bloonDefIndex < coverage.m_hitsToPop.size(); bloonDefIndex++)
+		{
+			float hits = projDef != nullptr ? GetHitsToPop(&BloonDefinition::s_bloonDefinitions[bloonDefIndex], projDef->m_damage, projDef->m_damageType, memo) : -1.0f;
+			coverage.m_hitsToPop[bloonDefIndex] = hits > 0.0f ? hits : 0.0f;
+		}
+
+		m_towers.emplace_back(coverage);
+	}
+}
+
+
+//
+//public member functions
+//
+RoundEstimate CoverageEstimator::EstimateRound(int roundNumber, uint32_t freeplaySeed) const
+{
+	RoundEstimate estimate;
+	estimate.m_roundNumber = roundNumber;
+
+	if (FreeplayRound::IsFreeplayRound(roundNumber))
+	{
+		FreeplayRound round = FreeplayRound(freeplaySeed, roundNumber);
+		for (int waveIndex = 0; waveIndex < round.GetNumWaves(); waveIndex++)
+		{
+			AddWave(round.GetWave(waveIndex), estimate);
+		}
+	}
+	else
+	{
+		RoundDefinition const* roundDef = RoundDefinition::GetRoundDefinitionByIndex(roundNumber - 1);
+		if (roundDef == nullptr) return estimate;
+
+		for (int waveIndex = 0; waveIndex < roundDef->m_waves.size(); waveIndex++)
+		{
+			AddWave(roundDef->m_waves[waveIndex], estimate);
+		}
+	}
+
+	return estimate;
+}
+
+
+int CoverageEstimator::EstimateSurvivalRound(int startingLives, int firstRound, int lastRound, uint32_t freeplaySeed) const
+{
+	float lives = static_cast<float>(startingLives);
+	for (int roundNumber = firstRound; roundNumber <= lastRound; roundNumber++)
+	{
+		lives -= EstimateRound(roundNumber, freeplaySeed).m_leakedRBE;
+		if (lives <= 0.0f)
+		{
+			return roundNumber - 1;
+		}
+	}
+	return lastRound;
+}
+
+
+//
+//private member functions
+//
+void CoverageEstimator::AddWave(Wave const& wave, RoundEstimate& estimate) const
+{
+	BloonDefinition const* bloonDef = wave.m_bloonDef;
+	if (bloonDef == nullptr || wave.m_numBloons <= 0) return;
+
+	int bloonDefIndex = static_cast<int>(bloonDef - BloonDefinition::s_bloonDefinitions.data());
+	float numBloons = static_cast<float>(wave.m_numBloons);
+
+	//each tower removes a share of every bloon that passes; a bloon whose shares reach 1 never gets out
+	float poppedShare = 0.0f;
+	for (int towerIndex = 0; towerIndex < m_towers.size() && poppedShare < 1.0f; towerIndex++)
+	{
+		TowerCoverageEstimate const& coverage = m_towers[towerIndex];
+		float hitsToPop = coverage.m_hitsToPop[bloonDefIndex];
+		if (hitsToPop <= 0.0f || coverage.m_coveredTrackLength <= 0.0f || bloonDef->m_speed <= 0.0f) continue;
+
+		float secondsInRange = coverage.m_coveredTrackLength / bloonDef->m_speed;
+		float numInRange = wave.m_timeBetweenSpawns > 0.0f ? secondsInRange / wave.m_timeBetweenSpawns : numBloons;
+		numInRange = numInRange < 1.0f ? 1.0f : (numInRange > numBloons ? numBloons : numInRange);
+
+		//a shot's pierce is shared out over the bloons in range at the time
+		Tower const& tower = *m_map.m_towers[coverage.m_towerSlot];
+		float hitsPerShot = GetHitsPerShot(tower, bloonDef);
+		int pierce = tower.m_definition->m_projectileDef->m_pierce + tower.m_definition->m_addedPierce;
+		float bloonsHitPerProjectile = static_cast<float>(pierce) < numInRange ? static_cast<float>(pierce) : numInRange;
+		float hitsPerBloon = secondsInRange * coverage.m_shotsPerSecond * hitsPerShot * bloonsHitPerProjectile / numInRange;
+
+		poppedShare += hitsPerBloon / hitsToPop;
+	}
+	poppedShare = poppedShare > 1.0f ? 1.0f : poppedShare;
+
+	float waveRBE = numBloons * static_cast<float>(bloonDef->m_RBE);
+	estimate.m_numBloons += wave.m_numBloons;
+	estimate.m_totalRBE += wave.m_numBloons * bloonDef->m_RBE;
+	estimate.m_poppedRBE += waveRBE * poppedShare;
+	estimate.m_leakedRBE += waveRBE * (1.0f - poppedShare);
+}
+
+
+//projectiles fan out evenly from the tower's facing; a tracking tower's first one is aimed, and the rest (or all of them
+//for a tower that doesn't track) hit about as often as a ray from the tower crosses a bloon halfway out to the range
+float CoverageEstimator::GetHitsPerShot(Tower const& tower, BloonDefinition const* bloonDef) const
+{
+	TowerDefinition const* towerDef = tower.m_definition;
+	ProjectileDefinition const* projDef = towerDef->m_projectileDef;
+
+	float hitWidth = 2.0f * (projDef->m_size + towerDef->m_addedSize + bloonDef->m_size);
+	float rayHitChance = towerDef->m_range > 0.0f ? hitWidth / (3.14159265f * towerDef->m_range) : 1.0f;
+	rayHitChance = rayHitChance > 1.0f ? 1.0f : rayHitChance;
+
+	int numAimed = towerDef->m_isTracking && towerDef->m_numProjectiles > 0 ? 1 : 0;
+	float directHitsPerShot = static_cast<float>(numAimed) + static_cast<float>(towerDef->m_numProjectiles - numAimed) * rayHitChance;
+
+	//what a projectile spawns when it runs out of pierce hits the same spot again; each spawned projectile scales the
+	//direct hits on its own, so the entries add up instead of compounding on each other
+	float hitsPerShot = directHitsPerShot;
+	float directDamage = static_cast<float>(projDef->m_damage > 0 ? projDef->m_damage : 1);
+	for (int spawnIndex = 0; spawnIndex < projDef->m_projectilesToSpawn.size(); spawnIndex++)
+	{
+		ProjectileDefinition const* spawnDef = ProjectileDefinition::GetProjectileDefinitionByName(projDef->m_projectilesToSpawn[spawnIndex]);
+		if (spawnDef != nullptr && spawnDef->m_damage > 0 && !IsImmune(bloonDef, spawnDef->m_damageType))
+		{
+			hitsPerShot += directHitsPerShot * static_cast<float>(spawnDef->m_damage) / directDamage;
+		}
+	}
+
+	return hitsPerShot;
+}
+
+
+//
+//validation
+//
+CoverageValidationResult ValidateCoverageEstimate(Game const& game, int firstRound, int lastRound)
+{
+	CoverageValidationResult result;
+
+	std::vector<uint8_t> snapshot;
+	game.WriteSnapshot(snapshot);
+
+	std::vector<Game*> headlessGames = Game::CreateHeadlessGames(1);
+	Game* headlessGame = headlessGames[0];
+	if (!headlessGame->ReadSnapshot(snapshot) || headlessGame->m_isRoundActive)
+	{
+		Game::DestroyHeadlessGames(headlessGames);
+		return result;
+	}
+
+	//plenty of lives so every round is played out in full, and freeplay for rounds past the authored ones
+	headlessGame->m_numLives = 1000000000;
+	headlessGame->m_isFreeplayEnabled = true;
+	headlessGame->m_roundNumber = firstRound;
+
+	double estimateStartTime = GetCurrentTimeSeconds();
+	CoverageEstimator estimator = CoverageEstimator(*headlessGame->m_currentMap);
+	for (int roundNumber = firstRound; roundNumber <= lastRound; roundNumber++)
+	{
+		CoverageValidationRound round;
+		round.m_estimate = estimator.EstimateRound(roundNumber, headlessGame->m_freeplaySeed);
+		result.m_rounds.emplace_back(round);
+	}
+	result.m_estimateMicroseconds = (GetCurrentTimeSeconds() - estimateStartTime) * 1000000.0;
+
+	double simulateStartTime = GetCurrentTimeSeconds();
+	for (int roundIndex = 0; roundIndex < result.m_rounds.size(); roundIndex++)
+	{
+		GameCommand startCommand;
+		startCommand.m_type = GameCommandType::START_ROUND;
+		if (!headlessGame->ExecuteCommand(startCommand)) break;
+
+		int livesBefore = headlessGame->m_numLives;
+		for (int tickIndex = 0; tickIndex < MAX_VALIDATION_TICKS_PER_ROUND && headlessGame->m_isRoundActive; tickIndex++)
+		{
+			headlessGame->UpdateSimulation(VALIDATION_DELTA_SECONDS);
+		}
+		result.m_rounds[roundIndex].m_simulatedLeakedRBE = livesBefore - headlessGame->m_numLives;
+	}
+	result.m_simulateSeconds = GetCurrentTimeSeconds() - simulateStartTime;
+
+	Game::DestroyHeadlessGames(headlessGames);
+	return result;
+}
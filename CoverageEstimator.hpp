@@ -0,0 +1,76 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+
+
+class Map;
+class Game;
+class Tower;
+class BloonDefinition;
+struct Wave;
+
+
+struct TowerCoverageEstimate
+{
+	int	  m_towerSlot = -1;
+	float m_coveredTrackLength = 0.0f;	//length of tessellated track inside the range disc
+	float m_shotsPerSecond = 0.0f;		//while something is in range
+	std::vector<float> m_hitsToPop;		//by bloon definition: this tower's hits to pop one and all its children, 0 if it can't
+};
+
+
+struct RoundEstimate
+{
+	int	  m_roundNumber = 0;
+	int	  m_numBloons = 0;
+	int	  m_totalRBE = 0;
+	float m_poppedRBE = 0.0f;
+	float m_leakedRBE = 0.0f;	//also the lives the round costs
+};
+
+
+struct CoverageValidationRound
+{
+	RoundEstimate m_estimate;
+	int	m_simulatedLeakedRBE = 0;
+};
+
+
+struct CoverageValidationResult
+{
+	std::vector<CoverageValidationRound> m_rounds;
+	double m_estimateMicroseconds = 0.0;	//building the estimator and estimating every round
+	double m_simulateSeconds = 0.0;
+};
+
+
+//predicts what a tower layout pops without simulating it. Each tower's covered stretch of track and the bloon's speed give
+//how long a bloon spends in range, the cooldown gives the shots it takes there, and projectile count, pierce and damage give
+//how much of the bloon each shot removes, shared out over however many bloons of the wave are in range at once. The towers'
+//shares of a bloon add up along the track; whatever is left over leaks. Ignores freezing, children moving faster than their
+//parents and waves overlapping, so it's for pruning layouts, not for replacing the simulation.
+class CoverageEstimator
+{
+//public member functions
+public:
+	explicit CoverageEstimator(Map const& map);
+
+	RoundEstimate EstimateRound(int roundNumber, uint32_t freeplaySeed) const;
+	int			  EstimateSurvivalRound(int startingLives, int firstRound, int lastRound, uint32_t freeplaySeed) const;	//last round finished with lives left
+
+//public member variables
+public:
+	std::vector<TowerCoverageEstimate> m_towers;
+
+//private member functions
+private:
+	void  AddWave(Wave const& wave, RoundEstimate& estimate) const;
+	float GetHitsPerShot(Tower const& tower, BloonDefinition const* bloonDef) const;
+
+//private member variables
+private:
+	Map const& m_map;
+};
+
+
+//checks the estimator against the headless simulator, round by round, on a copy of the game's current layout
+CoverageValidationResult ValidateCoverageEstimate(Game const& game, int firstRound, int lastRound);
@@ -0,0 +1,62 @@
+#include "Game/DeterminismCheck.hpp"
+#include "Game/Replay.hpp"
+#include "Game/Game.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+
+
+DeterminismResult RunDeterminismCheck(Replay const& replay, SimulationConfig const& configA, SimulationConfig const& configB, std::string const& dumpName)
+{
+	DeterminismResult result;
+
+	std::vector<Game*> games = Game::CreateHeadlessGames(2);
+	Game* gameA = games[0];
+	Game* gameB = games[1];
+	gameA->m_simConfig = configA;
+	gameB->m_simConfig = configB;
+
+	if (!gameA->ReadSnapshot(replay.m_initialSnapshot) || !gameB->ReadSnapshot(replay.m_initialSnapshot))
+	{
+		result.m_succeeded = false;
+		result.m_divergence = "Couldn't load the replay's starting snapshot";
+	}
+
+	int commandIndexA = 0;
+	int commandIndexB = 0;
+	for (uint32_t tickIndex = 0; tickIndex < replay.m_ticks.size() && result.m_succeeded; tickIndex++)
+	{
+		float deltaSeconds = replay.m_ticks[tickIndex].m_deltaSeconds;
+
+		double startTime = GetCurrentTimeSeconds();
+		replay.ApplyCommandsForTick(*gameA, tickIndex, commandIndexA);
+		gameA->UpdateSimulation(deltaSeconds);
+		double midTime = GetCurrentTimeSeconds();
+		replay.ApplyCommandsForTick(*gameB, tickIndex, commandIndexB);
+		gameB->UpdateSimulation(deltaSeconds);
+		double endTime = GetCurrentTimeSeconds();
+
+		result.m_secondsElapsedA += midTime - startTime;
+		result.m_secondsElapsedB += endTime - midTime;
+		result.m_numTicksRun++;
+
+		if (gameA->GetTickStateHash() != gameB->GetTickStateHash())
+		{
+			result.m_succeeded = false;
+			result.m_firstDivergentTick = tickIndex;
+			gameA->FindFirstDivergence(*gameB, result.m_divergence);
+
+			//text dumps for reading, snapshots so both sides can be opened in game with LoadGame
+			gameA->WriteStateDump(Stringf("Data/Determinism/%s_A.txt", dumpName.c_str()));
+			gameB->WriteStateDump(Stringf("Data/Determinism/%s_B.txt", dumpName.c_str()));
+
+			std::vector<uint8_t> snapshotBuffer;
+			gameA->WriteSnapshot(snapshotBuffer);
+			FileWriteFromBuffer(snapshotBuffer, Stringf("Data/Saves/%s_A.sav", dumpName.c_str()));
+			gameB->WriteSnapshot(snapshotBuffer);
+			FileWriteFromBuffer(snapshotBuffer, Stringf("Data/Saves/%s_B.sav", dumpName.c_str()));
+		}
+	}
+
+	Game::DestroyHeadlessGames(games);
+	return result;
+}
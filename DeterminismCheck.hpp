@@ -0,0 +1,22 @@
+#pragma once
+#include "Game/SimulationConfig.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+
+class Replay;
+
+
+struct DeterminismResult
+{
+	bool		m_succeeded = true;
+	uint32_t	m_numTicksRun = 0;
+	uint32_t	m_firstDivergentTick = 0;
+	std::string m_divergence;			//first mismatching value or entity, with both states
+	double		m_secondsElapsedA = 0.0;
+	double		m_secondsElapsedB = 0.0;
+};
+
+
+//steps two headless games with different configs through the same replay in lockstep,
+//stopping at the first tick whose state hashes differ and dumping both states as text and snapshots
+DeterminismResult RunDeterminismCheck(Replay const& replay, SimulationConfig const& configA, SimulationConfig const& configB, std::string const& dumpName);
@@ -0,0 +1,53 @@
+#include "Game/FrameArena.hpp"
+#include <cstdarg>
+#include <cstdio>
+
+
+//
+//public member functions
+//
+void FrameArena::Reset()
+{
+	m_numVertListsUsed = 0;
+	m_numStringsUsed = 0;
+}
+
+
+std::vector<Vertex_PCU>& FrameArena::AcquireVerts()
+{
+	if (m_numVertListsUsed == m_vertLists.size())
+	{
+		m_vertLists.emplace_back();
+	}
+
+	std::vector<Vertex_PCU>& verts = m_vertLists[m_numVertListsUsed];
+	m_numVertListsUsed++;
+
+	verts.clear();
+	return verts;
+}
+
+
+std::string const& FrameArena::FormatString(char const* format, ...)
+{
+	if (m_numStringsUsed == m_strings.size())
+	{
+		m_strings.emplace_back();
+	}
+
+	std::string& string = m_strings[m_numStringsUsed];
+	m_numStringsUsed++;
+
+	char buffer[FRAME_ARENA_MAX_STRING_LENGTH];
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(buffer, FRAME_ARENA_MAX_STRING_LENGTH, format, args);
+	va_end(args);
+
+	if (length < 0) length = 0;
+	if (length >= FRAME_ARENA_MAX_STRING_LENGTH) length = FRAME_ARENA_MAX_STRING_LENGTH - 1;
+
+	//assigning within the existing capacity doesn't allocate
+	string.assign(buffer, static_cast<size_t>(length));
+	return string;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Engine/Core/Vertex_PCU.hpp"
+#include <deque>
+#include <string>
+#include <vector>
+
+
+constexpr int FRAME_ARENA_MAX_STRING_LENGTH = 2048;
+
+
+//linear arena for things that only live for one frame. Vertex lists and strings are handed out in order
+//and all reclaimed at once by Reset, keeping their capacity, so once the frame's shape settles nothing
+//handed out here touches the heap. Everything acquired is invalid after the next Reset.
+class FrameArena
+{
+//public member functions
+public:
+	void Reset();
+
+	std::vector<Vertex_PCU>& AcquireVerts();
+	std::string const& FormatString(char const* format, ...);
+
+	int GetNumVertListsUsed() const { return m_numVertListsUsed; }
+	int GetNumStringsUsed() const { return m_numStringsUsed; }
+
+//private member variables
+private:
+	//deques so growing the pools never moves lists or strings already handed out this frame
+	std::deque<std::vector<Vertex_PCU>> m_vertLists;
+	std::deque<std::string> m_strings;
+	int m_numVertListsUsed = 0;
+	int m_numStringsUsed = 0;
+};
@@ -7,8 +7,23 @@
 #include "Game/RoundDefinition.hpp"
 #include "Game/Map.hpp"
 #include "Game/Bloon.hpp"
-#include "Game/Projectile.hpp"
+#include "Game/ProjectilePool.hpp"
 #include "Game/Tower.hpp"
+#include "Game/Snapshot.hpp"
+#include "Game/Replay.hpp"
+#include "Game/StateHash.hpp"
+#include "Game/DeterminismCheck.hpp"
+#include "Game/LayoutOptimizer.hpp"
+#include "Game/CoverageEstimator.hpp"
+#include "Game/ProjectileBenchmark.hpp"
+#include "Game/StressTest.hpp"
+#include "Game/RoundTelemetry.hpp"
+#include "Game/BatchRunner.hpp"
+#include "Game/VectorEnvironment.hpp"
+#include "Game/AllocationCounter.hpp"
+#include "Game/FrameArena.hpp"
+#include "Game/TrackData.hpp"
+#include "Game/WorkerPool.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Core/Time.hpp"
 #include "Engine/Renderer/Renderer.hpp"
@@ -19,9 +34,9 @@
 #include "Engine/Window/Window.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
-#include "Engine/Core/BufferUtils.hpp"
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Core/DevConsole.hpp"
 
 
 //game flow functions
@@ -29,8 +44,11 @@ void Game::Startup()
 {
 	LoadDefinitions();
 	
-	m_gameMusic = g_theAudio->CreateOrGetSound("Data/Audio/Music.mp3");
-	m_frozenHitSound = g_theAudio->CreateOrGetSound("Data/Audio/Frozen.mp3");
+	{
+		ScopedMemoryTag memoryTag(MemoryTag::AUDIO);
+		m_gameMusic = g_theAudio->CreateOrGetSound("Data/Audio/Music.mp3");
+		m_frozenHitSound = g_theAudio->CreateOrGetSound("Data/Audio/Frozen.mp3");
+	}
 
 	m_menuFont = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/SquirrelFixedFont");
 	
@@ -39,6 +57,11 @@ void Game::Startup()
 	g_theRenderer->SetModelConstants();
 
 	AddButtonsForShop();
+	AddVertsForAABB2(m_sidebarBaseVerts, m_UIBaseBounds, Rgba8(195, 210, 225));
+	constexpr float SELECT_MAP_TEXT_HEIGHT = 32.0f;
+	Vec2 selectMapMins = Vec2(SCREEN_CAMERA_SIZE_X - SCREEN_CAMERA_SIZE_Y * 0.02f - SELECT_MAP_TEXT_HEIGHT * 11.0f, SCREEN_CAMERA_SIZE_Y * 0.9f - SELECT_MAP_TEXT_HEIGHT * 0.5f);
+	m_menuFont->AddVertsForText2D(m_selectMapTextVerts, selectMapMins, SELECT_MAP_TEXT_HEIGHT, "Select Map:");
+
 	m_sellButton = Button(g_theRenderer, g_theInput, m_sellButtonBounds, Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y), nullptr, "[sell text]", AABB2(0.05f, 0.15f, 0.95f, 0.85f),
 		Rgba8(200, 0, 50), Rgba8(), Rgba8(255, 25, 25), Rgba8());
 	EventArgs blankArgs;
@@ -67,6 +90,7 @@ void Game::Startup()
 
 	//subscribe to events
 	SubscribeEventCallbackFunction("WriteMap", Event_WriteMap);
+	SubscribeEventCallbackFunction("ExportTracks", Event_ExportTracks);
 	SubscribeEventCallbackFunction("BuyTower", Event_BuyTower);
 	SubscribeEventCallbackFunction("SellTower", Event_SellTower);
 	SubscribeEventCallbackFunction("BuyUpgrade1", Event_BuyUpgrade1);
@@ -74,12 +98,77 @@ void Game::Startup()
 	SubscribeEventCallbackFunction("StartRound", Event_StartRound);
 	SubscribeEventCallbackFunction("ToggleTargetingMode", Event_ToggleTargetingMode);
 	SubscribeEventCallbackFunction("SelectMap", Event_SelectMap);
+	SubscribeEventCallbackFunction("SaveGame", Event_SaveGame);
+	SubscribeEventCallbackFunction("LoadGame", Event_LoadGame);
+	SubscribeEventCallbackFunction("StartRecording", Event_StartRecording);
+	SubscribeEventCallbackFunction("StopRecording", Event_StopRecording);
+	SubscribeEventCallbackFunction("PlayReplay", Event_PlayReplay);
+	SubscribeEventCallbackFunction("CheckDeterminism", Event_CheckDeterminism);
+	SubscribeEventCallbackFunction("OptimizeLayout", Event_OptimizeLayout);
+	SubscribeEventCallbackFunction("ThreadedSimulation", Event_ThreadedSimulation);
+	SubscribeEventCallbackFunction("BenchmarkProjectiles", Event_BenchmarkProjectiles);
+	SubscribeEventCallbackFunction("MemoryStats", Event_MemoryStats);
+	SubscribeEventCallbackFunction("Freeplay", Event_Freeplay);
+	SubscribeEventCallbackFunction("SpawnBloons", Event_SpawnBloons);
+	SubscribeEventCallbackFunction("PlaceTowerGrid", Event_PlaceTowerGrid);
+	SubscribeEventCallbackFunction("RunTicks", Event_RunTicks);
+	SubscribeEventCallbackFunction("Telemetry", Event_Telemetry);
+	SubscribeEventCallbackFunction("RunBatch", Event_RunBatch);
+	SubscribeEventCallbackFunction("EstimateCoverage", Event_EstimateCoverage);
+	SubscribeEventCallbackFunction("StepEnvironments", Event_StepEnvironments);
+
+	m_simulationWorker = new WorkerPool(1);
 
 	//EnterAttractMode();
 	EnterGameplay();
 }
 
 
+//simulation-only startup for replays and tools; no rendering, audio, UI, or events
+void Game::StartupHeadless()
+{
+	m_isHeadless = true;
+
+	LoadDefinitions();
+}
+
+
+//tools that spread games over worker threads create them all here on the calling thread, which also loads the
+//definitions once; after that each worker only touches its own game
+std::vector<Game*> Game::CreateHeadlessGames(int numGames)
+{
+	std::vector<Game*> games;
+	for (int gameIndex = 0; gameIndex < numGames; gameIndex++)
+	{
+		Game* game = new Game();
+		game->StartupHeadless();
+		games.emplace_back(game);
+	}
+	return games;
+}
+
+
+void Game::DestroyHeadlessGames(std::vector<Game*>& games)
+{
+	for (int gameIndex = 0; gameIndex < games.size(); gameIndex++)
+	{
+		games[gameIndex]->Shutdown();
+		delete games[gameIndex];
+	}
+	games.clear();
+}
+
+
+//swaps in a freshly opened map and captures it, along with everything else about this game, as the state runs restore to
+void Game::WriteFreshMapSnapshot(int mapIndex, std::vector<uint8_t>& out_snapshot)
+{
+	delete m_currentMap;
+	m_currentMap = nullptr;
+	OpenMap(mapIndex);
+	WriteSnapshot(out_snapshot);
+}
+
+
 void Game::Update()
 {
 	//if in attract mode, just update that and don't bother with anything else
@@ -121,18 +210,8 @@ void Game::Update()
 		m_gameClock.StepSingleFrame();
 	}
 
-	//if game over, increment reset timer, then reset game once reset timer is done
-	if (m_resetTimer > 0.0f)
-	{
-		m_resetTimer -= m_gameClock.GetDeltaSeconds();
-		/*std::string resetStr = Stringf("Reset timer: %.2f", m_resetTimer);
-		DebugAddMessage(resetStr, 0.0f);*/
-		if (m_resetTimer <= 0.0f)
-		{
-			m_isFinished = true;
-		}
-	}
-	else
+	//player input is ignored while the game over timer is running
+	if (m_resetTimer <= 0.0f)
 	{
 		//select tower with left click
 		if (g_theInput->WasKeyJustPressed(KEYCODE_LMB))
@@ -180,6 +259,14 @@ void Game::Update()
 		{
 			m_showAllTowerRanges = !m_showAllTowerRanges;
 		}
+		if (g_theInput->WasKeyJustPressed(KEYCODE_F5))
+		{
+			m_useBloonLOD = !m_useBloonLOD;
+		}
+		if (g_theInput->WasKeyJustPressed(KEYCODE_F6))
+		{
+			m_showMemoryOverlay = !m_showMemoryOverlay;
+		}
 
 		if (g_theInput->WasKeyJustPressed(KEYCODE_F3))
 		{
@@ -192,55 +279,50 @@ void Game::Update()
 
 		if (g_theInput->WasKeyJustPressed('K'))
 		{
-			for (int bloonIndex = 0; bloonIndex < m_currentMap->m_bloons.size(); bloonIndex++)
-			{
-				if (m_currentMap->m_bloons[bloonIndex] != nullptr)
-				{
-					m_numMoney += m_currentMap->m_bloons[bloonIndex]->m_definition->m_RBE;
-					delete m_currentMap->m_bloons[bloonIndex];
-					m_currentMap->m_bloons[bloonIndex] = nullptr;
-				}
-			}
-
-			EndRound();
+			GameCommand command;
+			command.m_type = GameCommandType::CLEAR_BLOONS;
+			IssueCommand(command);
 		}
 
 		if (g_theInput->WasKeyJustPressed('M'))
 		{
-			m_numMoney += 10000;
+			GameCommand command;
+			command.m_type = GameCommandType::ADD_MONEY;
+			command.m_index = 10000;
+			IssueCommand(command);
 		}
 		//bloon spawning debug controls
 		if (g_theInput->WasKeyJustPressed('1') || (g_theInput->IsKeyDown(KEYCODE_SHIFT) && g_theInput->IsKeyDown('1')))
 		{
-			m_currentMap->SpawnBloonAtStart(BloonDefinition::GetBloonDefinitionByName("Red"));
+			IssueSpawnBloonCommand("Red");
 		}
 		if (g_theInput->WasKeyJustPressed('2') || (g_theInput->IsKeyDown(KEYCODE_SHIFT) && g_theInput->IsKeyDown('2')))
 		{
-			m_currentMap->SpawnBloonAtStart(BloonDefinition::GetBloonDefinitionByName("Blue"));
+			IssueSpawnBloonCommand("Blue");
 		}
 		if (g_theInput->WasKeyJustPressed('3') || (g_theInput->IsKeyDown(KEYCODE_SHIFT) && g_theInput->IsKeyDown('3')))
 		{
-			m_currentMap->SpawnBloonAtStart(BloonDefinition::GetBloonDefinitionByName("Green"));
+			IssueSpawnBloonCommand("Green");
 		}
 		if (g_theInput->WasKeyJustPressed('4') || (g_theInput->IsKeyDown(KEYCODE_SHIFT) && g_theInput->IsKeyDown('4')))
 		{
-			m_currentMap->SpawnBloonAtStart(BloonDefinition::GetBloonDefinitionByName("Yellow"));
+			IssueSpawnBloonCommand("Yellow");
 		}
 		if (g_theInput->WasKeyJustPressed('5') || (g_theInput->IsKeyDown(KEYCODE_SHIFT) && g_theInput->IsKeyDown('5')))
 		{
-			m_currentMap->SpawnBloonAtStart(BloonDefinition::GetBloonDefinitionByName("Black"));
+			IssueSpawnBloonCommand("Black");
 		}
 		if (g_theInput->WasKeyJustPressed('6') || (g_theInput->IsKeyDown(KEYCODE_SHIFT) && g_theInput->IsKeyDown('6')))
 		{
-			m_currentMap->SpawnBloonAtStart(BloonDefinition::GetBloonDefinitionByName("White"));
+			IssueSpawnBloonCommand("White");
 		}
 		if (g_theInput->WasKeyJustPressed('7') || (g_theInput->IsKeyDown(KEYCODE_SHIFT) && g_theInput->IsKeyDown('7')))
 		{
-			m_currentMap->SpawnBloonAtStart(BloonDefinition::GetBloonDefinitionByName("Rainbow"));
+			IssueSpawnBloonCommand("Rainbow");
 		}
 		if (g_theInput->WasKeyJustPressed('8') || (g_theInput->IsKeyDown(KEYCODE_SHIFT) && g_theInput->IsKeyDown('8')))
 		{
-			m_currentMap->SpawnBloonAtStart(BloonDefinition::GetBloonDefinitionByName("Lead"));
+			IssueSpawnBloonCommand("Lead");
 		}
 
 		//update spline editor and map
@@ -249,16 +331,47 @@ void Game::Update()
 			UpdateSplineEditor(orthoMousePos);
 		}
 	}
+
+	if (m_currentMap != nullptr)
+	{
+		//update held tower
+		if (m_heldTower != nullptr)
+		{
+			m_heldTower->m_position = orthoMousePos;
+			m_canPlaceTower = m_currentMap->IsValidTowerPlacement(m_heldTower->m_definition, m_heldTower->m_position);
+		}
+	}
 	
+	if(m_resetTimer == 0.0f) UpdateUISidebar(orthoMousePos);
+}
+
+
+//everything that changes game state on its own each tick; player actions come in through commands
+void Game::UpdateSimulation(float deltaSeconds)
+{
+	ScopedMemoryTag memoryTag(MemoryTag::MAP_ENTITIES);
+
+	//if game over, count down reset timer, then reset game once reset timer is done
+	if (m_resetTimer > 0.0f)
+	{
+		m_resetTimer -= deltaSeconds;
+		if (m_resetTimer <= 0.0f)
+		{
+			m_isFinished = true;
+		}
+	}
+
 	if (m_currentMap != nullptr)
 	{
 		if (m_isRoundActive)
 		{
 			bool allWavesFinishedSpawning = true;
+			bool isFreeplayRound = FreeplayRound::IsFreeplayRound(m_roundNumber);
+			bool useSwarms = m_simConfig.m_useBloonSwarms && m_simConfig.m_useArcLengthTables;	//swarm zones are measured on the arc-length tables
 			
-			for (int waveIndex = 0; waveIndex < m_roundDef->m_waves.size(); waveIndex++)
+			for (int waveIndex = 0; waveIndex < m_waveCounts.size(); waveIndex++)
 			{
-				Wave const& wave = m_roundDef->m_waves[waveIndex];
+				Wave const& wave = isFreeplayRound ? m_freeplayLaneWaves[waveIndex] : m_roundDef->m_waves[waveIndex];
 				int& waveCount = m_waveCounts[waveIndex];
 				float& waveTimer = m_waveTimers[waveIndex];
 				
@@ -266,67 +379,117 @@ void Game::Update()
 				{
 					allWavesFinishedSpawning = false;
 
-					waveTimer -= m_gameClock.GetDeltaSeconds();
-					if (waveTimer <= 0.0f)
+					waveTimer -= deltaSeconds;
+					//members of a swarm need distinct track positions, so waves that spawn all at once go out one by one
+					if (waveTimer <= 0.0f && useSwarms && waveCount > 1 && waveCount <= MAX_SWARM_MEMBERS && wave.m_bloonDef->m_speed * wave.m_timeBetweenSpawns > 0.0f)
+					{
+						//the rest of the wave goes out as one swarm, so the lane's next wave waits as long as spawning one by one would have
+						float secondsToSpawnRest = wave.m_timeBetweenSpawns * static_cast<float>(waveCount - 1);
+						m_currentMap->SpawnBloonSwarmAtStart(wave.m_bloonDef, waveCount, wave.m_bloonDef->m_speed * wave.m_timeBetweenSpawns);
+						waveCount = 0;
+
+						if (isFreeplayRound && StartNextFreeplayWave(waveIndex))
+						{
+							m_waveTimers[waveIndex] += secondsToSpawnRest;
+						}
+					}
+					else if (waveTimer <= 0.0f)
 					{
 						m_currentMap->SpawnBloonAtStart(wave.m_bloonDef);
 						waveTimer = wave.m_timeBetweenSpawns;
 						waveCount--;
+
+						if (waveCount == 0 && isFreeplayRound)
+						{
+							StartNextFreeplayWave(waveIndex);
+						}
 					}
 				}
 			}
 
-			if (allWavesFinishedSpawning)
+			if (allWavesFinishedSpawning && !m_currentMap->HasBloonsLeft())
 			{
-				bool allBloonsDead = true;
-
-				for (int bloonIndex = 0; bloonIndex < m_currentMap->m_bloons.size(); bloonIndex++)
-				{
-					if (m_currentMap->m_bloons[bloonIndex] != nullptr)
-					{
-						allBloonsDead = false;
-						break;
-					}
-				}
-
-				if (allBloonsDead)
-				{
-					EndRound();
-				}
+				EndRound();
 			}
 		}
 
-		m_currentMap->Update(m_gameClock.GetDeltaSeconds());
+		m_currentMap->Update(deltaSeconds);
+	}
 
-		//update held tower
-		if (m_heldTower != nullptr)
+	//record the tick so a replay can step with the same time and verify the result
+	if (m_recordingReplay != nullptr)
+	{
+		ReplayTick tick;
+		tick.m_deltaSeconds = deltaSeconds;
+		tick.m_stateHash = GetTickStateHash();
+		m_recordingReplay->m_ticks.emplace_back(tick);
+	}
+	m_simTick++;
+}
+
+
+//App calls this between Update and Render; the step's snapshot becomes visible once EndSimulationStep swaps it to the front
+void Game::BeginSimulationStep()
+{
+	float deltaSeconds = m_gameClock.GetDeltaSeconds();
+	int backSnapshotIndex = 1 - m_frontRenderSnapshotIndex;
+
+	//UI state is the main thread's, so the capture gets its own copy taken here
+	RenderSnapshotOptions snapshotOptions;
+	snapshotOptions.m_selectedTowerSlot = m_selectedTower != nullptr ? m_selectedTower->m_slotIndex : -1;
+	snapshotOptions.m_showAllTowerRanges = m_showAllTowerRanges;
+	snapshotOptions.m_useBloonLOD = m_useBloonLOD;
+
+	if (m_isSimulationThreaded && m_simulationWorker != nullptr)
+	{
+		m_simulationWorker->AddJob([this, deltaSeconds, backSnapshotIndex, snapshotOptions](int workerIndex)
 		{
-			m_heldTower->m_position = orthoMousePos;
-			m_canPlaceTower = true;
+			UNUSED(workerIndex);
+			UpdateSimulation(deltaSeconds);
+			m_renderSnapshots[backSnapshotIndex].Capture(*this, snapshotOptions);
+		});
+		return;
+	}
 
-			//check if currently over any other towers
-			for (int towerIndex = 0; towerIndex < m_currentMap->m_towers.size(); towerIndex++)
-			{
-				Tower* const& tower = m_currentMap->m_towers[towerIndex];
+	UpdateSimulation(deltaSeconds);
+	m_renderSnapshots[backSnapshotIndex].Capture(*this, snapshotOptions);
+}
 
-				if (tower == nullptr) continue;
 
-				if (DoDiscsOverlap(m_heldTower->m_position, m_heldTower->m_definition->m_size, tower->m_position, tower->m_definition->m_size))
-				{
-					m_canPlaceTower = false;
-				}
-			}
+//App calls this after Render, so input, UI and console commands never run while a step is in flight
+void Game::EndSimulationStep()
+{
+	if (m_simulationWorker != nullptr)
+	{
+		m_simulationWorker->WaitForAllJobs();
+	}
 
-			//#ToDo: Check if tower is over the track
-			Vec2 nearestPointOnTrack = m_currentMap->GetNearestPointOnTrack(m_heldTower->m_position);
-			if (DoDiscsOverlap(nearestPointOnTrack, TRACK_WIDTH, m_heldTower->m_position, m_heldTower->m_definition->m_size))
-			{
-				m_canPlaceTower = false;
-			}
+	m_frontRenderSnapshotIndex = 1 - m_frontRenderSnapshotIndex;
+	FlushSimulationEvents();
+}
+
+
+//side effects the simulation can't perform itself because the systems involved aren't thread safe
+void Game::FlushSimulationEvents()
+{
+	{
+		ScopedMemoryTag memoryTag(MemoryTag::AUDIO);
+		for (int soundIndex = 0; soundIndex < m_pendingSounds.size(); soundIndex++)
+		{
+			g_theAudio->StartSound(m_pendingSounds[soundIndex].m_sound, false, m_pendingSounds[soundIndex].m_volume);
 		}
+		m_pendingSounds.clear();
+	}
+
+	if (!m_pendingEndScreenText.empty())
+	{
+		DebugAddScreenText(m_pendingEndScreenText, Vec2(SCREEN_CAMERA_CENTER_X, SCREEN_CAMERA_CENTER_Y), SCREEN_CAMERA_SIZE_Y * 0.2f, Vec2(0.5f, 0.5f), m_timeBeforeReset,
+			m_pendingEndScreenColor, m_pendingEndScreenColor);
+		m_pendingEndScreenText.clear();
+
+		delete m_heldTower;
+		m_heldTower = nullptr;
 	}
-	
-	if(m_resetTimer == 0.0f) UpdateUISidebar(orthoMousePos);
 }
 
 
@@ -344,8 +507,8 @@ void Game::Render() const
 	g_theRenderer->BindShader(nullptr);
 
 	//render map texture
-	std::vector<Vertex_PCU> backgroundVerts;
-	AABB2 backgroundBounds = AABB2(0.0f, 0.0f, SCREEN_CAMERA_CENTER_X + SCREEN_CAMERA_SIZE_X * 0.25f, SCREEN_CAMERA_SIZE_Y);
+	std::vector<Vertex_PCU>& backgroundVerts = g_frameArena.AcquireVerts();
+	AABB2 backgroundBounds = AABB2(0.0f, 0.0f, PLAYFIELD_SIZE_X, SCREEN_CAMERA_SIZE_Y);
 	AddVertsForAABB2(backgroundVerts, backgroundBounds);
 
 	g_theRenderer->BindTexture(m_currentMap->m_definition->m_texture);
@@ -356,10 +519,7 @@ void Game::Render() const
 	{
 		RenderSplineEditor();
 	}
-	if (m_currentMap != nullptr)
-	{
-		m_currentMap->Render();
-	}
+	GetFrontRenderSnapshot().Render();
 
 	//render tower being held
 	if (m_heldTower != nullptr)
@@ -370,13 +530,27 @@ void Game::Render() const
 
 	RenderUISidebar();
 
-	//debug rendering
+	//debug rendering, drawn straight from the font since debug render text is re-allocated every frame
+	constexpr float HUD_TEXT_HEIGHT = 16.0f;
+	std::vector<Vertex_PCU>& hudVerts = g_frameArena.AcquireVerts();
+
 	Clock& sysClock = Clock::GetSystemClock();
-	std::string timeInfo = Stringf("Time: %.2f  FPS: %.1f  Time Scale: %.2f", m_gameClock.GetTotalSeconds(), 1.0f / sysClock.GetDeltaSeconds(), m_gameClock.GetTimeScale());
-	DebugAddScreenText(timeInfo, Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y), 16.0f, Vec2(1.0f, 1.0f), 0.0f, Rgba8(), Rgba8());
+	std::string const& timeInfo = g_frameArena.FormatString("Time: %.2f  FPS: %.1f  Time Scale: %.2f  Allocs: %i (render %i)", m_gameClock.GetTotalSeconds(),
+		1.0f / sysClock.GetDeltaSeconds(), m_gameClock.GetTimeScale(), g_theApp->GetLastFrameNumAllocations(), g_theApp->GetLastRenderNumAllocations());
+	Vec2 timeInfoMins = Vec2(SCREEN_CAMERA_SIZE_X - HUD_TEXT_HEIGHT * static_cast<float>(timeInfo.size()), SCREEN_CAMERA_SIZE_Y - HUD_TEXT_HEIGHT);
+	m_menuFont->AddVertsForText2D(hudVerts, timeInfoMins, HUD_TEXT_HEIGHT, timeInfo);
+
+	RenderSnapshot const& snapshot = GetFrontRenderSnapshot();
+	std::string const& gameInfo = g_frameArena.FormatString("Round: %i   Lives: %i   Money: %i", snapshot.m_roundNumber, snapshot.m_numLives, snapshot.m_numMoney);
+	m_menuFont->AddVertsForText2D(hudVerts, Vec2(0.0f, SCREEN_CAMERA_SIZE_Y - HUD_TEXT_HEIGHT), HUD_TEXT_HEIGHT, gameInfo);
 
-	std::string gameInfo = Stringf("Round: %i   Lives: %i   Money: %i", m_roundNumber, m_numLives, m_numMoney);
-	DebugAddMessage(gameInfo, 0.0f);
+	if (m_showMemoryOverlay)
+	{
+		AddVertsForMemoryOverlay(hudVerts, HUD_TEXT_HEIGHT);
+	}
+
+	g_theRenderer->BindTexture(&m_menuFont->GetTexture());
+	g_theRenderer->DrawVertexArray(hudVerts);
 
 	g_theRenderer->EndCamera(m_screenCamera);
 
@@ -386,9 +560,16 @@ void Game::Render() const
 
 void Game::Shutdown()
 {
-	g_theAudio->StopSound(m_gameMusicPlayback);
+	if (!m_isHeadless)
+	{
+		g_theAudio->StopSound(m_gameMusicPlayback);
+	}
+	delete m_simulationWorker;
+	delete m_recordingReplay;
+	delete m_roundTelemetry;
 	delete m_heldTower;
 	delete m_currentMap;
+	delete m_restoreMap;
 }
 
 
@@ -399,7 +580,8 @@ void Game::OpenMap(unsigned int mapIndex)
 {
 	MapDefinition const* def = MapDefinition::GetMapDefinitionByIndex(mapIndex);
 
-	m_currentMap = new Map(def);
+	m_currentMap = new Map(def, this);
+	m_isSidebarDirty = true;
 }
 
 
@@ -418,36 +600,43 @@ void Game::GameOver()
 {
 	if (m_resetTimer > 0.0f) return;
 
-	DebugAddScreenText("Game Over", Vec2(SCREEN_CAMERA_CENTER_X, SCREEN_CAMERA_CENTER_Y), SCREEN_CAMERA_SIZE_Y * 0.2f, Vec2(0.5f, 0.5f), m_timeBeforeReset, Rgba8(255, 25, 25), Rgba8(255, 25, 25));
 	m_resetTimer = m_timeBeforeReset;
 
-	delete m_heldTower;
-	m_heldTower = nullptr;
+	//the held tower and debug text belong to the main thread, so FlushSimulationEvents handles them
+	m_pendingEndScreenText = "Game Over";
+	m_pendingEndScreenColor = Rgba8(255, 25, 25);
 }
 
 
 void Game::EndRound()
 {
+	if (m_roundTelemetry != nullptr)
+	{
+		m_roundTelemetry->EndRound(*m_currentMap, m_roundNumber);
+	}
+
 	m_numMoney += m_roundNumber + 100;
 	m_isRoundActive = false;
 	m_roundNumber++;
 
 	m_waveTimers.clear();
 	m_waveCounts.clear();
+	m_freeplayLaneWaveIndexes.clear();
+	m_freeplayLaneWaves.clear();
+	m_currentMap->ClearSoldTowerSwarmZones();
 
-	for (int projIndex = 0; projIndex < m_currentMap->m_projectiles.size(); projIndex++)
+	ProjectilePool& projectiles = m_currentMap->m_projectiles;
+	for (int projIndex = 0; projIndex < projectiles.GetNumSlots(); projIndex++)
 	{
-		Projectile*& projectile = m_currentMap->m_projectiles[projIndex];
-
-		if (projectile != nullptr && projectile->m_definition->m_isRoadItem)
+		if (projectiles.IsAlive(projIndex) && projectiles.GetDefinition(projIndex)->m_isRoadItem)
 		{
-			projectile->m_outOfLifespan = true;
+			projectiles.DieFromLifespan(projIndex);
 		}
 	}
 
 	//DebugAddMessage("End Round!", 5.0f);
 
-	if (m_roundNumber > RoundDefinition::s_roundDefinitions.size())
+	if (m_roundNumber > RoundDefinition::s_roundDefinitions.size() && !m_isFreeplayEnabled)
 	{
 		m_roundNumber = static_cast<int>(RoundDefinition::s_roundDefinitions.size());
 		WinGame();
@@ -459,11 +648,10 @@ void Game::WinGame()
 {
 	if (m_resetTimer > 0.0f) return;
 
-	DebugAddScreenText("YOU WIN!", Vec2(SCREEN_CAMERA_CENTER_X, SCREEN_CAMERA_CENTER_Y), SCREEN_CAMERA_SIZE_Y * 0.2f, Vec2(0.5f, 0.5f), m_timeBeforeReset, Rgba8(25, 255, 25), Rgba8(25, 255, 25));
 	m_resetTimer = m_timeBeforeReset;
 
-	delete m_heldTower;
-	m_heldTower = nullptr;
+	m_pendingEndScreenText = "YOU WIN!";
+	m_pendingEndScreenColor = Rgba8(25, 255, 25);
 }
 
 
@@ -490,215 +678,1356 @@ void Game::BuyTower(TowerDefinition const* def)
 }
 
 
-bool Game::PlaceHeldTower()
+bool Game::PlaceHeldTower()
+{
+	if (!m_canPlaceTower) return false;
+
+	GameCommand command;
+	command.m_type = GameCommandType::PLACE_TOWER;
+	command.m_index = static_cast<int>(m_heldTower->m_definition - TowerDefinition::s_towerDefinitions.data());
+	command.m_position = m_heldTower->m_position;
+	if (!IssueCommand(command))
+	{
+		return false;
+	}
+
+	//the placed tower is a fresh copy at the end of the map's list, so the held one can go
+	m_selectedTower = m_currentMap->m_towers.back();
+	delete m_heldTower;
+	m_heldTower = nullptr;
+
+	return true;
+}
+
+
+void Game::PlaySound(SoundID sound, float volume) const
+{
+	if (m_isHeadless) return;
+
+	//may be running on the simulation thread, so just queue it
+	PendingSound pendingSound;
+	pendingSound.m_sound = sound;
+	pendingSound.m_volume = volume;
+	m_pendingSounds.emplace_back(pendingSound);
+}
+
+
+//
+//player command functions
+//
+bool Game::IssueCommand(GameCommand const& command)
+{
+	if (m_recordingReplay != nullptr)
+	{
+		GameCommand recordedCommand = command;
+		recordedCommand.m_tick = m_simTick;
+		m_recordingReplay->m_commands.emplace_back(recordedCommand);
+	}
+
+	return ExecuteCommand(command);
+}
+
+
+bool Game::ExecuteCommand(GameCommand const& command)
+{
+	if (m_currentMap == nullptr) return false;
+
+	switch (command.m_type)
+	{
+		case GameCommandType::PLACE_TOWER:
+		{
+			TowerDefinition const* def = TowerDefinition::GetTowerDefinitionByIndex(command.m_index);
+			if (def == nullptr)
+			{
+				return false;
+			}
+
+			//check cost, deduct if player has enough or disallow placing if player somehow doesn't
+			if (m_numMoney < def->m_cost)
+			{
+				AddErrorMessage("Not enough money!");
+				return false;
+			}
+			m_numMoney -= def->m_cost;
+
+			m_currentMap->m_towers.emplace_back(new Tower(def, m_currentMap, command.m_position));
+			m_currentMap->m_towers.back()->m_slotIndex = static_cast<int>(m_currentMap->m_towers.size()) - 1;
+			return true;
+		}
+		case GameCommandType::SELL_TOWER:
+		{
+			if (command.m_index < 0 || command.m_index >= m_currentMap->m_towers.size() || m_currentMap->m_towers[command.m_index] == nullptr)
+			{
+				return false;
+			}
+
+			if (m_selectedTower == m_currentMap->m_towers[command.m_index])
+			{
+				m_selectedTower = nullptr;
+			}
+			m_currentMap->SellTower(command.m_index);
+			return true;
+		}
+		case GameCommandType::BUY_UPGRADE_1:
+		case GameCommandType::BUY_UPGRADE_2:
+		{
+			if (command.m_index < 0 || command.m_index >= m_currentMap->m_towers.size() || m_currentMap->m_towers[command.m_index] == nullptr)
+			{
+				return false;
+			}
+
+			TowerDefinition const* towerDef = m_currentMap->m_towers[command.m_index]->m_definition;
+			if (command.m_type == GameCommandType::BUY_UPGRADE_1)
+			{
+				return BuyUpgrade(command.m_index, towerDef->m_upgrade1, towerDef->m_upgrade1Cost);
+			}
+			return BuyUpgrade(command.m_index, towerDef->m_upgrade2, towerDef->m_upgrade2Cost);
+		}
+		case GameCommandType::TOGGLE_TARGETING_MODE:
+		{
+			if (command.m_index < 0 || command.m_index >= m_currentMap->m_towers.size() || m_currentMap->m_towers[command.m_index] == nullptr)
+			{
+				return false;
+			}
+
+			Tower* tower = m_currentMap->m_towers[command.m_index];
+			switch (tower->m_targetingMode)
+			{
+				case TargetingMode::FIRST:
+				{
+					tower->m_targetingMode = TargetingMode::LAST;
+					return true;
+				}
+				case TargetingMode::LAST:
+				{
+					tower->m_targetingMode = TargetingMode::NEAR;
+					return true;
+				}
+				case TargetingMode::NEAR:
+				{
+					tower->m_targetingMode = TargetingMode::STRONG;
+					return true;
+				}
+				case TargetingMode::STRONG:
+				{
+					tower->m_targetingMode = TargetingMode::WEAK;
+					return true;
+				}
+				case TargetingMode::WEAK:
+				{
+					tower->m_targetingMode = TargetingMode::FIRST;
+					return true;
+				}
+			}
+			return false;
+		}
+		case GameCommandType::START_ROUND:
+		{
+			//the button is hidden mid-round, but replays and agents can still ask; a second start would queue the waves twice
+			if (m_isRoundActive)
+			{
+				return false;
+			}
+
+			if (FreeplayRound::IsFreeplayRound(m_roundNumber))
+			{
+				if (!StartFreeplayRound())
+				{
+					AddErrorMessage("No more rounds!");
+					return false;
+				}
+				return true;
+			}
+
+			m_roundDef = RoundDefinition::GetRoundDefinitionByIndex(m_roundNumber - 1);
+			if (m_roundDef == nullptr)
+			{
+				AddErrorMessage("No more rounds!");
+				return false;
+			}
+
+			m_isRoundActive = true;
+			for (int waveIndex = 0; waveIndex < m_roundDef->m_waves.size(); waveIndex++)
+			{
+				Wave const& wave = m_roundDef->m_waves[waveIndex];
+
+				m_waveTimers.emplace_back(wave.m_timeToStart);
+				m_waveCounts.emplace_back(wave.m_numBloons);
+			}
+			return true;
+		}
+		case GameCommandType::SPAWN_BLOON:
+		{
+			BloonDefinition const* def = BloonDefinition::GetBloonDefinitionByIndex(command.m_index);
+			if (def == nullptr)
+			{
+				return false;
+			}
+
+			m_currentMap->SpawnBloonAtStart(def);
+			return true;
+		}
+		case GameCommandType::SPAWN_BLOONS:
+		{
+			BloonDefinition const* def = BloonDefinition::GetBloonDefinitionByIndex(command.m_index);
+			int numBloons = static_cast<int>(command.m_position.x);
+			float spacing = command.m_position.y;
+			if (def == nullptr || numBloons <= 0 || spacing < 0.0f)
+			{
+				return false;
+			}
+
+			//laid down the track from the start, wrapping round short of the end if there are more than fit
+			float wrapDistance = m_currentMap->GetBloonTrackLength() * 0.95f;
+			for (int bloonIndex = 0; bloonIndex < numBloons; bloonIndex++)
+			{
+				float trackDistance = spacing * static_cast<float>(bloonIndex);
+				if (wrapDistance > 0.0f)
+				{
+					trackDistance = fmodf(trackDistance, wrapDistance);
+				}
+				m_currentMap->AddBloon(new Bloon(def, m_currentMap, &m_currentMap->m_trackSpline[0], trackDistance));
+			}
+			return true;
+		}
+		case GameCommandType::CLEAR_BLOONS:
+		{
+			m_numMoney += m_currentMap->ClearBloons();
+
+			EndRound();
+			return true;
+		}
+		case GameCommandType::ADD_MONEY:
+		{
+			m_numMoney += command.m_index;
+			return true;
+		}
+		case GameCommandType::ENTER_FREEPLAY:
+		{
+			m_isFreeplayEnabled = true;
+			m_freeplaySeed = static_cast<uint32_t>(command.m_index);
+
+			//skipping ahead only makes sense between rounds
+			int skipToRound = static_cast<int>(command.m_position.x);
+			if (!m_isRoundActive && skipToRound > m_roundNumber)
+			{
+				m_roundNumber = skipToRound;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+int Game::GetTowerIndex(Tower const* tower) const
+{
+	if (tower == nullptr || m_currentMap == nullptr) return -1;
+
+	for (int towerIndex = 0; towerIndex < m_currentMap->m_towers.size(); towerIndex++)
+	{
+		if (m_currentMap->m_towers[towerIndex] == tower)
+		{
+			return towerIndex;
+		}
+	}
+
+	return -1;
+}
+
+
+void Game::IssueSpawnBloonCommand(std::string const& bloonDefName)
+{
+	BloonDefinition const* def = BloonDefinition::GetBloonDefinitionByName(bloonDefName);
+	if (def == nullptr) return;
+
+	GameCommand command;
+	command.m_type = GameCommandType::SPAWN_BLOON;
+	command.m_index = static_cast<int>(def - BloonDefinition::s_bloonDefinitions.data());
+	IssueCommand(command);
+}
+
+
+bool Game::IssueTowerCommand(GameCommandType type, Tower const* tower)
+{
+	GameCommand command;
+	command.m_type = type;
+	command.m_index = GetTowerIndex(tower);
+	if (command.m_index < 0) return false;
+
+	return IssueCommand(command);
+}
+
+
+bool Game::BuyUpgrade(int towerIndex, std::string const& upgradeDefName, int upgradeCost)
+{
+	Tower* tower = m_currentMap->m_towers[towerIndex];
+	if (m_numMoney < upgradeCost)
+	{
+		AddErrorMessage("Can't afford upgrade!");
+		return false;
+	}
+
+	//replace the tower's definition with the definition of its upgrade
+	TowerDefinition const* upgradeDef = TowerDefinition::GetTowerDefinitionByName(upgradeDefName);
+	if (upgradeDef == nullptr)
+	{
+		AddErrorMessage("Upgrade was null!");
+		return false;
+	}
+
+	m_numMoney -= upgradeCost;
+	tower->m_definition = upgradeDef;
+	tower->Wake();
+	return true;
+}
+
+
+void Game::AddErrorMessage(std::string const& message) const
+{
+	if (m_isHeadless) return;
+
+	DebugAddMessage(message, 7.0f, Rgba8(190, 20, 30), Rgba8(255, 255, 255, 0));
+}
+
+
+uint64_t Game::CombineWithGameStateHash(uint64_t mapHash) const
+{
+	uint64_t hash = STATE_HASH_SEED;
+	hash = HashWord(hash, m_numMoney);
+	hash = HashWord(hash, m_numLives);
+	hash = HashWord(hash, m_roundNumber);
+	hash = HashWord(hash, m_isRoundActive);
+	if (m_isFreeplayEnabled)
+	{
+		hash = HashWord(hash, m_freeplaySeed);
+		hash = HashWord(hash, m_nextFreeplayWaveIndex);
+	}
+	return HashCombine(hash, mapHash);
+}
+
+
+//
+//round sub-functions
+//
+bool Game::StartFreeplayRound()
+{
+	if (!m_isFreeplayEnabled) return false;
+
+	//only the lanes' current waves exist at any time; the rest are generated as lanes free up
+	m_roundDef = nullptr;
+	m_freeplayRound = FreeplayRound(m_freeplaySeed, m_roundNumber);
+	m_nextFreeplayWaveIndex = 0;
+	m_waveTimers.assign(NUM_FREEPLAY_LANES, 0.0f);
+	m_waveCounts.assign(NUM_FREEPLAY_LANES, 0);
+	m_freeplayLaneWaveIndexes.assign(NUM_FREEPLAY_LANES, -1);
+	m_freeplayLaneWaves.assign(NUM_FREEPLAY_LANES, Wave());
+	for (int laneIndex = 0; laneIndex < NUM_FREEPLAY_LANES; laneIndex++)
+	{
+		StartNextFreeplayWave(laneIndex);
+	}
+
+	m_isRoundActive = true;
+	return true;
+}
+
+
+bool Game::StartNextFreeplayWave(int laneIndex)
+{
+	if (m_nextFreeplayWaveIndex >= m_freeplayRound.GetNumWaves())
+	{
+		m_freeplayLaneWaveIndexes[laneIndex] = -1;
+		return false;
+	}
+
+	int waveIndex = m_nextFreeplayWaveIndex;
+	m_nextFreeplayWaveIndex++;
+
+	Wave wave = m_freeplayRound.GetWave(waveIndex);
+	m_freeplayLaneWaveIndexes[laneIndex] = waveIndex;
+	m_freeplayLaneWaves[laneIndex] = wave;
+	m_waveTimers[laneIndex] = wave.m_timeToStart;
+	m_waveCounts[laneIndex] = wave.m_numBloons;
+	return true;
+}
+
+
+//lane waves aren't saved, since the seed and each lane's wave index regenerate them exactly
+void Game::RefreshFreeplayLaneWaves()
+{
+	m_freeplayRound = FreeplayRound(m_freeplaySeed, m_roundNumber);
+	m_freeplayLaneWaves.resize(m_freeplayLaneWaveIndexes.size());
+	for (int laneIndex = 0; laneIndex < m_freeplayLaneWaveIndexes.size(); laneIndex++)
+	{
+		m_freeplayLaneWaves[laneIndex] = m_freeplayRound.GetWave(m_freeplayLaneWaveIndexes[laneIndex]);
+	}
+}
+
+
+void Game::BeginHeadlessMemoryReport(MemoryTagStats* out_startStats)
+{
+	CaptureMemoryTagStats(out_startStats);
+	ResetMemoryHighWaterMarks();
+}
+
+
+//prints the per-subsystem summary for the run and keeps a copy in Data/Memory
+void Game::EndHeadlessMemoryReport(std::string const& runName, MemoryTagStats const* startStats)
+{
+	std::string summary = GetMemoryTrackingSummary(startStats);
+
+	std::vector<uint8_t> buffer(summary.begin(), summary.end());
+	FileWriteFromBuffer(buffer, Stringf("Data/Memory/%s.txt", runName.c_str()));
+
+	if (g_theDevConsole == nullptr) return;
+
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Memory for %s (written to Data/Memory/%s.txt):", runName.c_str(), runName.c_str()));
+	size_t lineStart = 0;
+	while (lineStart < summary.size())
+	{
+		size_t lineEnd = summary.find('\n', lineStart);
+		if (lineEnd == std::string::npos) lineEnd = summary.size();
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, summary.substr(lineStart, lineEnd - lineStart));
+		lineStart = lineEnd + 1;
+	}
+}
+
+
+//
+//determinism functions
+//
+uint64_t Game::ComputeStateHash() const
+{
+	return CombineWithGameStateHash(m_currentMap != nullptr ? m_currentMap->ComputeStateHash() : 0);
+}
+
+
+//cheap per-tick version that reuses the hash the map builds during its update
+uint64_t Game::GetTickStateHash() const
+{
+	return CombineWithGameStateHash(m_currentMap != nullptr ? m_currentMap->m_tickStateHash : 0);
+}
+
+
+bool Game::FindFirstDivergence(Game const& other, std::string& out_description) const
+{
+	if (m_numMoney != other.m_numMoney)
+	{
+		out_description = Stringf("Money: A %i, B %i", m_numMoney, other.m_numMoney);
+		return true;
+	}
+	if (m_numLives != other.m_numLives)
+	{
+		out_description = Stringf("Lives: A %i, B %i", m_numLives, other.m_numLives);
+		return true;
+	}
+	if (m_roundNumber != other.m_roundNumber || m_isRoundActive != other.m_isRoundActive)
+	{
+		out_description = Stringf("Round: A %i (%s), B %i (%s)", m_roundNumber, m_isRoundActive ? "active" : "inactive", other.m_roundNumber, other.m_isRoundActive ? "active" : "inactive");
+		return true;
+	}
+
+	if (m_currentMap == nullptr || other.m_currentMap == nullptr)
+	{
+		return false;
+	}
+	return m_currentMap->FindFirstDivergence(*other.m_currentMap, out_description);
+}
+
+
+void Game::WriteStateDump(std::string const& filePath) const
+{
+	std::string dump = Stringf("Tick %u, state hash %016llx, config %s\n", m_simTick, static_cast<unsigned long long>(ComputeStateHash()), m_simConfig.GetDescription().c_str());
+	dump += Stringf("Money %i, lives %i, round %i (%s)\n", m_numMoney, m_numLives, m_roundNumber, m_isRoundActive ? "active" : "inactive");
+	if (m_currentMap != nullptr)
+	{
+		m_currentMap->AppendStateDump(dump);
+	}
+
+	std::vector<uint8_t> buffer(dump.begin(), dump.end());
+	FileWriteFromBuffer(buffer, filePath);
+}
+
+
+//
+//snapshot functions
+//
+void Game::WriteSnapshot(std::vector<uint8_t>& buffer) const
+{
+	SnapshotWriter writer = SnapshotWriter(buffer);
+
+	writer.Write(SNAPSHOT_MAGIC);
+	writer.Write(SNAPSHOT_VERSION);
+	writer.Write(static_cast<int>(m_currentMap->m_definition - MapDefinition::s_mapDefinitions.data()));
+
+	//economy and round progress
+	writer.Write(m_numLives);
+	writer.Write(m_numMoney);
+	writer.Write(m_roundNumber);
+	writer.Write(m_isRoundActive);
+	writer.Write(m_resetTimer);
+	writer.Write(static_cast<int>(m_waveTimers.size()));
+	writer.WriteBytes(m_waveTimers.data(), m_waveTimers.size() * sizeof(float));
+	writer.WriteBytes(m_waveCounts.data(), m_waveCounts.size() * sizeof(int));
+	writer.Write(m_isFreeplayEnabled);
+	writer.Write(m_freeplaySeed);
+	writer.Write(m_nextFreeplayWaveIndex);
+	writer.Write(static_cast<int>(m_freeplayLaneWaveIndexes.size()));
+	writer.WriteBytes(m_freeplayLaneWaveIndexes.data(), m_freeplayLaneWaveIndexes.size() * sizeof(int));
+
+	m_currentMap->WriteSnapshot(writer);
+
+	//selection is stored as a tower slot so it survives the restore
+	int selectedTowerIndex = -1;
+	for (int towerIndex = 0; towerIndex < m_currentMap->m_towers.size(); towerIndex++)
+	{
+		if (m_selectedTower != nullptr && m_currentMap->m_towers[towerIndex] == m_selectedTower)
+		{
+			selectedTowerIndex = towerIndex;
+			break;
+		}
+	}
+	writer.Write(selectedTowerIndex);
+
+	writer.Finish();
+}
+
+
+bool Game::ReadSnapshot(std::vector<uint8_t> const& buffer)
+{
+	SnapshotReader reader = SnapshotReader(buffer.data(), buffer.size());
+
+	if (reader.Read<uint32_t>() != SNAPSHOT_MAGIC || reader.Read<uint32_t>() != SNAPSHOT_VERSION)
+	{
+		return false;
+	}
+
+	MapDefinition const* mapDef = MapDefinition::GetMapDefinitionByIndex(reader.Read<int>());
+	if (mapDef == nullptr)
+	{
+		return false;
+	}
+
+	//everything is decoded on the side and only committed once the whole snapshot has been read, so a bad one changes nothing
+	int numLives = reader.Read<int>();
+	int numMoney = reader.Read<int>();
+	int roundNumber = reader.Read<int>();
+	bool isRoundActive = reader.Read<bool>();
+	float resetTimer = reader.Read<float>();
+	int numWaves = reader.Read<int>();
+	if (!reader.CanHoldCount(numWaves, sizeof(float) + sizeof(int)))
+	{
+		return false;
+	}
+	std::vector<float> waveTimers;
+	std::vector<int> waveCounts;
+	waveTimers.resize(numWaves);
+	waveCounts.resize(numWaves);
+	reader.ReadBytes(waveTimers.data(), numWaves * sizeof(float));
+	reader.ReadBytes(waveCounts.data(), numWaves * sizeof(int));
+	RoundDefinition const* roundDef = isRoundActive ? RoundDefinition::GetRoundDefinitionByIndex(roundNumber - 1) : nullptr;
+
+	bool isFreeplayEnabled = reader.Read<bool>();
+	uint32_t freeplaySeed = reader.Read<uint32_t>();
+	int nextFreeplayWaveIndex = reader.Read<int>();
+	int numFreeplayLanes = reader.Read<int>();
+	if (!reader.CanHoldCount(numFreeplayLanes, sizeof(int)) || (isRoundActive && roundDef == nullptr && numFreeplayLanes != numWaves))
+	{
+		return false;
+	}
+	std::vector<int> freeplayLaneWaveIndexes;
+	freeplayLaneWaveIndexes.resize(numFreeplayLanes);
+	reader.ReadBytes(freeplayLaneWaveIndexes.data(), numFreeplayLanes * sizeof(int));
+
+	//a partially restored map may hold dangling references, so it's thrown away if anything went wrong
+	if (m_restoreMap != nullptr && m_restoreMap->m_definition != mapDef)
+	{
+		delete m_restoreMap;
+		m_restoreMap = nullptr;
+	}
+	if (m_restoreMap == nullptr)
+	{
+		m_restoreMap = new Map(mapDef, this);
+	}
+	if (!m_restoreMap->ReadSnapshot(reader))
+	{
+		delete m_restoreMap;
+		m_restoreMap = nullptr;
+		return false;
+	}
+
+	int selectedTowerIndex = reader.Read<int>();
+	if (!reader.IsValid() || !reader.IsAtEnd())
+	{
+		return false;
+	}
+
+	//anything held or selected points into the old state, including the spline editor's picks on the old track
+	delete m_heldTower;
+	m_heldTower = nullptr;
+	m_selectedTower = nullptr;
+	m_highlightedControlPoint = nullptr;
+	m_selectedControlPoint = nullptr;
+	m_highlightedCurve = nullptr;
+	m_selectedCurve = nullptr;
+	m_isSidebarDirty = true;
+	m_isMapSelection = false;
+
+	std::swap(m_currentMap, m_restoreMap);
+	m_numLives = numLives;
+	m_numMoney = numMoney;
+	m_roundNumber = roundNumber;
+	m_isRoundActive = isRoundActive;
+	m_resetTimer = resetTimer;
+	m_waveTimers.swap(waveTimers);
+	m_waveCounts.swap(waveCounts);
+	m_roundDef = roundDef;
+	m_isFreeplayEnabled = isFreeplayEnabled;
+	m_freeplaySeed = freeplaySeed;
+	m_nextFreeplayWaveIndex = nextFreeplayWaveIndex;
+	m_freeplayLaneWaveIndexes.swap(freeplayLaneWaveIndexes);
+	RefreshFreeplayLaneWaves();
+	if (selectedTowerIndex >= 0 && selectedTowerIndex < m_currentMap->m_towers.size())
+	{
+		m_selectedTower = m_currentMap->m_towers[selectedTowerIndex];
+	}
+
+	return true;
+}
+
+
+//
+//commands
+//
+bool Game::Event_WriteMap(EventArgs& args)
+{
+	if (g_theGame == nullptr || g_theGame->m_currentMap == nullptr) return false;
+
+	std::string mapName = args.GetValue("Name", "UnnamedMap");
+	g_theGame->WriteCurrentMapToDisk(mapName);
+	return true;
+}
+
+
+//writes every loaded map's track as a binary .track file; point a MapDefinition's trackFile attribute at one to skip XML parsing at startup
+bool Game::Event_ExportTracks(EventArgs& args)
+{
+	UNUSED(args);
+
+	double startTime = GetCurrentTimeSeconds();
+	int numTracksExported = 0;
+	for (int defIndex = 0; defIndex < MapDefinition::s_mapDefinitions.size(); defIndex++)
+	{
+		MapDefinition const& mapDef = MapDefinition::s_mapDefinitions[defIndex];
+		std::string filePath = Stringf("Data/Tracks/%s.track", mapDef.m_name.c_str());
+		if (!mapDef.m_track.WriteToFile(filePath))
+		{
+			g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Map %s has no track to export!", mapDef.m_name.c_str()));
+			continue;
+		}
+		numTracksExported++;
+	}
+	double endTime = GetCurrentTimeSeconds();
+
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Exported %i tracks to Data/Tracks (%.3f ms)", numTracksExported, (endTime - startTime) * 1000.0));
+	return true;
+}
+
+
+bool Game::Event_BuyTower(EventArgs& args)
+{
+	if (g_theGame == nullptr || g_theGame->m_currentMap == nullptr) return false;
+
+	std::string towerDefName = args.GetValue("Name", "invalid");
+	TowerDefinition const* towerDef = TowerDefinition::GetTowerDefinitionByName(towerDefName);
+	g_theGame->BuyTower(towerDef);
+
+	return true;
+}
+
+
+bool Game::Event_SellTower(EventArgs& args)
+{
+	UNUSED(args);
+
+	if (g_theGame->m_selectedTower == nullptr)
+	{
+		return false;
+	}
+
+	if (g_theGame->GetTowerIndex(g_theGame->m_selectedTower) < 0)
+	{
+		//should never get here
+		ERROR_RECOVERABLE("Attempted to sell tower that is not part of map");
+		return false;
+	}
+
+	return g_theGame->IssueTowerCommand(GameCommandType::SELL_TOWER, g_theGame->m_selectedTower);
+}
+
+
+bool Game::Event_BuyUpgrade1(EventArgs& args)
+{
+	UNUSED(args);
+
+	if (g_theGame->m_selectedTower == nullptr)
+	{
+		return false;
+	}
+
+	return g_theGame->IssueTowerCommand(GameCommandType::BUY_UPGRADE_1, g_theGame->m_selectedTower);
+}
+
+
+bool Game::Event_BuyUpgrade2(EventArgs& args)
+{
+	UNUSED(args);
+
+	if (g_theGame->m_selectedTower == nullptr)
+	{
+		return false;
+	}
+
+	return g_theGame->IssueTowerCommand(GameCommandType::BUY_UPGRADE_2, g_theGame->m_selectedTower);
+}
+
+
+bool Game::Event_StartRound(EventArgs& args)
+{
+	UNUSED(args);
+
+	//DebugAddMessage("Start Round!", 5.0f);
+
+	GameCommand command;
+	command.m_type = GameCommandType::START_ROUND;
+	g_theGame->IssueCommand(command);
+	
+	return true;
+}
+
+
+bool Game::Event_ToggleTargetingMode(EventArgs& args)
+{
+	UNUSED(args);
+
+	if (g_theGame->m_selectedTower == nullptr)
+	{
+		return false;
+	}
+
+	return g_theGame->IssueTowerCommand(GameCommandType::TOGGLE_TARGETING_MODE, g_theGame->m_selectedTower);
+}
+
+
+bool Game::Event_SelectMap(EventArgs& args)
+{
+	UNUSED(args);
+
+	g_theGame->m_isMapSelection = false;
+
+	return true;
+}
+
+
+bool Game::Event_SaveGame(EventArgs& args)
+{
+	if (g_theGame == nullptr || g_theGame->m_currentMap == nullptr) return false;
+
+	std::string saveName = args.GetValue("Name", "QuickSave");
+
+	double startTime = GetCurrentTimeSeconds();
+	g_theGame->WriteSnapshot(g_theGame->m_snapshotBuffer);
+	double endTime = GetCurrentTimeSeconds();
+
+	std::string filePath = Stringf("Data/Saves/%s.sav", saveName.c_str());
+	FileWriteFromBuffer(g_theGame->m_snapshotBuffer, filePath);
+
+	DebugAddMessage(Stringf("Saved %s (%i bytes, %.3f ms)", filePath.c_str(), static_cast<int>(g_theGame->m_snapshotBuffer.size()), (endTime - startTime) * 1000.0), 5.0f);
+	return true;
+}
+
+
+bool Game::Event_LoadGame(EventArgs& args)
+{
+	if (g_theGame == nullptr) return false;
+
+	std::string saveName = args.GetValue("Name", "QuickSave");
+	std::string filePath = Stringf("Data/Saves/%s.sav", saveName.c_str());
+
+	g_theGame->m_snapshotBuffer.clear();
+	FileReadToBuffer(g_theGame->m_snapshotBuffer, filePath);
+	if (g_theGame->m_snapshotBuffer.empty())
+	{
+		DebugAddMessage(Stringf("Couldn't read save file %s!", filePath.c_str()), 7.0f, Rgba8(190, 20, 30), Rgba8(255, 255, 255, 0));
+		return false;
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+	bool succeeded = g_theGame->ReadSnapshot(g_theGame->m_snapshotBuffer);
+	double endTime = GetCurrentTimeSeconds();
+
+	if (!succeeded)
+	{
+		DebugAddMessage(Stringf("Save file %s is invalid or from another version!", filePath.c_str()), 7.0f, Rgba8(190, 20, 30), Rgba8(255, 255, 255, 0));
+		return false;
+	}
+
+	DebugAddMessage(Stringf("Loaded %s (%.3f ms)", filePath.c_str(), (endTime - startTime) * 1000.0), 5.0f);
+	return true;
+}
+
+
+bool Game::Event_StartRecording(EventArgs& args)
+{
+	UNUSED(args);
+
+	if (g_theGame == nullptr || g_theGame->m_currentMap == nullptr) return false;
+
+	//the replay starts from a snapshot of the current state, so recording can begin mid-game
+	delete g_theGame->m_recordingReplay;
+	g_theGame->m_recordingReplay = new Replay();
+	g_theGame->WriteSnapshot(g_theGame->m_recordingReplay->m_initialSnapshot);
+	g_theGame->m_simTick = 0;
+
+	DebugAddMessage("Recording started", 5.0f);
+	return true;
+}
+
+
+bool Game::Event_StopRecording(EventArgs& args)
+{
+	if (g_theGame == nullptr || g_theGame->m_recordingReplay == nullptr) return false;
+
+	std::string replayName = args.GetValue("Name", "QuickReplay");
+	std::string filePath = Stringf("Data/Replays/%s.replay", replayName.c_str());
+
+	Replay* replay = g_theGame->m_recordingReplay;
+	g_theGame->m_recordingReplay = nullptr;
+	replay->WriteToFile(filePath);
+
+	DebugAddMessage(Stringf("Saved %s (%i ticks, %i commands)", filePath.c_str(), static_cast<int>(replay->m_ticks.size()), static_cast<int>(replay->m_commands.size())), 5.0f);
+	delete replay;
+	return true;
+}
+
+
+bool Game::Event_PlayReplay(EventArgs& args)
+{
+	std::string replayName = args.GetValue("Name", "QuickReplay");
+	std::string filePath = Stringf("Data/Replays/%s.replay", replayName.c_str());
+
+	Replay replay;
+	if (!replay.ReadFromFile(filePath))
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Couldn't read replay file %s!", filePath.c_str()));
+		return false;
+	}
+
+	MemoryTagStats startMemoryStats[static_cast<int>(MemoryTag::NUM_MEMORY_TAGS)];
+	BeginHeadlessMemoryReport(startMemoryStats);
+	ReplayVerification result = replay.RunHeadless();
+	EndHeadlessMemoryReport(Stringf("PlayReplay_%s", replayName.c_str()), startMemoryStats);
+
+	double ticksPerSecond = result.m_secondsElapsed > 0.0 ? static_cast<double>(result.m_numTicksRun) / result.m_secondsElapsed : 0.0;
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Replay %s: %u ticks in %.3f s (%.0f ticks/s)", filePath.c_str(), result.m_numTicksRun, result.m_secondsElapsed, ticksPerSecond));
+	if (result.m_succeeded)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, "Replay verified, every tick matched the recording");
+	}
+	else
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Replay diverged at tick %u: expected %016llx, got %016llx", result.m_firstMismatchTick,
+			static_cast<unsigned long long>(result.m_expectedHash), static_cast<unsigned long long>(result.m_actualHash)));
+	}
+
+	return result.m_succeeded;
+}
+
+
+bool Game::Event_CheckDeterminism(EventArgs& args)
+{
+	if (g_theGame == nullptr || g_theGame->m_currentMap == nullptr) return false;
+
+	std::string replayName = args.GetValue("Replay", "");
+	std::string optionName = args.GetValue("Option", "ArcLengthTables");
+	std::string dumpName = args.GetValue("Dump", "Divergence");
+	int numTicks = args.GetValue("Ticks", 3600);
+
+	//side A runs the current config, side B flips one option
+	SimulationConfig configA = g_theGame->m_simConfig;
+	SimulationConfig configB = configA;
+	bool optionValue = false;
+	if (!configB.GetOption(optionName, optionValue))
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Unknown simulation option %s!", optionName.c_str()));
+		return false;
+	}
+	configB.SetOption(optionName, !optionValue);
+
+	//without a replay file, run forward from the current state at a fixed step with no input
+	Replay replay;
+	if (replayName.empty())
+	{
+		g_theGame->WriteSnapshot(replay.m_initialSnapshot);
+		ReplayTick tick;
+		tick.m_deltaSeconds = 1.0f / 60.0f;
+		replay.m_ticks.resize(numTicks, tick);
+	}
+	else if (!replay.ReadFromFile(Stringf("Data/Replays/%s.replay", replayName.c_str())))
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Couldn't read replay file Data/Replays/%s.replay!", replayName.c_str()));
+		return false;
+	}
+
+	MemoryTagStats startMemoryStats[static_cast<int>(MemoryTag::NUM_MEMORY_TAGS)];
+	BeginHeadlessMemoryReport(startMemoryStats);
+	DeterminismResult result = RunDeterminismCheck(replay, configA, configB, dumpName);
+	EndHeadlessMemoryReport(Stringf("CheckDeterminism_%s", dumpName.c_str()), startMemoryStats);
+
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Determinism check, %u ticks: A (%s) %.3f s, B (%s) %.3f s", result.m_numTicksRun, configA.GetDescription().c_str(),
+		result.m_secondsElapsedA, configB.GetDescription().c_str(), result.m_secondsElapsedB));
+	if (result.m_succeeded)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, "No divergence, every tick matched");
+	}
+	else
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Diverged at tick %u: %s", result.m_firstDivergentTick, result.m_divergence.c_str()));
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("States dumped to Data/Determinism/%s_A.txt/_B.txt and Data/Saves/%s_A.sav/_B.sav", dumpName.c_str(), dumpName.c_str()));
+	}
+
+	return result.m_succeeded;
+}
+
+
+bool Game::Event_OptimizeLayout(EventArgs& args)
+{
+	if (g_theGame == nullptr) return false;
+
+	LayoutOptimizerSettings settings;
+	std::string mapName = args.GetValue("Map", "");
+	if (!mapName.empty())
+	{
+		MapDefinition const* mapDef = MapDefinition::GetMapDefinitionByName(mapName);
+		if (mapDef == nullptr)
+		{
+			g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Unknown map %s!", mapName.c_str()));
+			return false;
+		}
+		settings.m_mapIndex = static_cast<int>(mapDef - MapDefinition::s_mapDefinitions.data());
+	}
+	else if (g_theGame->m_currentMap != nullptr)
+	{
+		settings.m_mapIndex = static_cast<int>(g_theGame->m_currentMap->m_definition - MapDefinition::s_mapDefinitions.data());
+	}
+	settings.m_budget = args.GetValue("Budget", settings.m_budget);
+	settings.m_numCandidates = args.GetValue("Candidates", settings.m_numCandidates);
+	settings.m_maxRounds = args.GetValue("Rounds", settings.m_maxRounds);
+	settings.m_numResults = args.GetValue("Results", settings.m_numResults);
+	settings.m_numWorkers = args.GetValue("Workers", settings.m_numWorkers);
+	settings.m_seed = static_cast<uint32_t>(args.GetValue("Seed", 0));
+	settings.m_pruneBelowEstimatedRound = args.GetValue("PruneBelow", settings.m_pruneBelowEstimatedRound);
+	std::string cacheName = args.GetValue("Cache", "");
+	if (!cacheName.empty())
+	{
+		settings.m_roundCachePath = Stringf("Data/Saves/%s.roundcache", cacheName.c_str());
+	}
+
+	MemoryTagStats startMemoryStats[static_cast<int>(MemoryTag::NUM_MEMORY_TAGS)];
+	BeginHeadlessMemoryReport(startMemoryStats);
+	LayoutOptimizerResult result = RunLayoutOptimizer(settings);
+	EndHeadlessMemoryReport("OptimizeLayout", startMemoryStats);
+
+	double roundsPerSecond = result.m_secondsElapsed > 0.0 ? static_cast<double>(result.m_numRoundsSimulated) / result.m_secondsElapsed : 0.0;
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Optimized %s with $%i: %i candidates (%i pruned by estimate, %i failed to restore), %i rounds (%i more from cache) in %.2f s on %i workers (%.1f rounds/s/core)",
+		MapDefinition::s_mapDefinitions[settings.m_mapIndex].m_name.c_str(), settings.m_budget, result.m_numCandidatesRun, result.m_numCandidatesPruned, result.m_numCandidatesFailed,
+		result.m_numRoundsSimulated, result.m_numRoundsFromCache, result.m_secondsElapsed,
+		result.m_numWorkers, roundsPerSecond / static_cast<double>(result.m_numWorkers)));
+	for (int layoutIndex = 0; layoutIndex < result.m_bestLayouts.size(); layoutIndex++)
+	{
+		TowerLayout const& layout = result.m_bestLayouts[layoutIndex];
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("#%i: survived round %i with %i lives, cost $%i: %s", layoutIndex + 1, layout.m_survivalRound, layout.m_livesLeft,
+			layout.m_cost, layout.m_description.c_str()));
+	}
+
+	return true;
+}
+
+
+bool Game::Event_ThreadedSimulation(EventArgs& args)
+{
+	if (g_theGame == nullptr) return false;
+
+	g_theGame->m_isSimulationThreaded = args.GetValue("Enabled", !g_theGame->m_isSimulationThreaded);
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Simulation now runs %s", g_theGame->m_isSimulationThreaded ? "on its own thread, overlapping rendering" : "on the main thread"));
+	return true;
+}
+
+
+bool Game::Event_Freeplay(EventArgs& args)
+{
+	if (g_theGame == nullptr) return false;
+
+	GameCommand command;
+	command.m_type = GameCommandType::ENTER_FREEPLAY;
+	command.m_index = args.GetValue("Seed", static_cast<int>(g_theGame->m_freeplaySeed));
+	command.m_position.x = static_cast<float>(args.GetValue("Round", 0));
+	g_theGame->IssueCommand(command);
+
+	int numAuthoredRounds = static_cast<int>(RoundDefinition::s_roundDefinitions.size());
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Freeplay on with seed %u; rounds past %i are generated", g_theGame->m_freeplaySeed, numAuthoredRounds));
+	if (FreeplayRound::IsFreeplayRound(g_theGame->m_roundNumber))
+	{
+		FreeplayRound nextRound = FreeplayRound(g_theGame->m_freeplaySeed, g_theGame->m_roundNumber);
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Round %i: %i bloons in %i waves", g_theGame->m_roundNumber, nextRound.GetNumBloons(), nextRound.GetNumWaves()));
+	}
+	return true;
+}
+
+
+bool Game::Event_SpawnBloons(EventArgs& args)
 {
-	if (!m_canPlaceTower) return false;
+	if (g_theGame == nullptr || g_theGame->m_currentMap == nullptr) return false;
 
-	//check cost, deduct if player has enough or disallow placing if player somehow doesn't
-	if (m_numMoney < m_heldTower->m_definition->m_cost)
+	std::string bloonDefName = args.GetValue("Bloon", "Red");
+	BloonDefinition const* bloonDef = BloonDefinition::GetBloonDefinitionByName(bloonDefName);
+	if (bloonDef == nullptr)
 	{
-		DebugAddMessage("Not enough money!", 7.0f, Rgba8(190, 20, 30), Rgba8(255, 255, 255, 0));
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Unknown bloon %s!", bloonDefName.c_str()));
 		return false;
 	}
-	m_numMoney -= m_heldTower->m_definition->m_cost;
 
-	//add tower to map
-	m_currentMap->m_towers.emplace_back(m_heldTower);
-	m_selectedTower = m_heldTower;
-
-	//make tower no longer held
-	m_heldTower->m_isBeingHeld = false;
-	m_heldTower = nullptr;
+	GameCommand command;
+	command.m_type = GameCommandType::SPAWN_BLOONS;
+	command.m_index = static_cast<int>(bloonDef - BloonDefinition::s_bloonDefinitions.data());
+	command.m_position = Vec2(static_cast<float>(args.GetValue("Count", 1000)), args.GetValue("Spacing", 4.0f));
+	if (!g_theGame->IssueCommand(command))
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, "Count must be positive and spacing can't be negative!");
+		return false;
+	}
 
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Spawned %i %s bloons %.1f apart", static_cast<int>(command.m_position.x), bloonDef->m_name.c_str(), command.m_position.y));
 	return true;
 }
 
 
-//
-//commands
-//
-bool Game::Event_WriteMap(EventArgs& args)
+bool Game::Event_PlaceTowerGrid(EventArgs& args)
 {
 	if (g_theGame == nullptr || g_theGame->m_currentMap == nullptr) return false;
 
-	std::string mapName = args.GetValue("Name", "UnnamedMap");
-	g_theGame->WriteCurrentMapToDisk(mapName);
+	std::string towerDefName = args.GetValue("Tower", "");
+	TowerDefinition const* towerDef = TowerDefinition::GetTowerDefinitionByName(towerDefName);
+	if (towerDef == nullptr)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Unknown tower %s!", towerDefName.c_str()));
+		return false;
+	}
+
+	float spacing = args.GetValue("Spacing", 40.0f);
+	int upgradePath = args.GetValue("Path", 1);
+	int numUpgrades = args.GetValue("Upgrades", 0);
+	int maxTowers = args.GetValue("Max", 1000);
+
+	int numPlaced = PlaceStressTowerGrid(*g_theGame, towerDef, spacing, upgradePath, numUpgrades, maxTowers);
+	g_theGame->m_isSidebarDirty = true;
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Placed %i %s towers %.0f apart with %i path %i upgrades each", numPlaced, towerDef->m_name.c_str(), spacing,
+		numUpgrades, upgradePath));
 	return true;
 }
 
 
-bool Game::Event_BuyTower(EventArgs& args)
+bool Game::Event_RunTicks(EventArgs& args)
 {
 	if (g_theGame == nullptr || g_theGame->m_currentMap == nullptr) return false;
 
-	std::string towerDefName = args.GetValue("Name", "invalid");
-	TowerDefinition const* towerDef = TowerDefinition::GetTowerDefinitionByName(towerDefName);
-	g_theGame->BuyTower(towerDef);
-
+	int numTicks = args.GetValue("Ticks", 600);
+	float deltaSeconds = args.GetValue("DeltaSeconds", 1.0f / 60.0f);
+
+	//console commands only run between steps, so the live game can be driven directly; running as headless keeps
+	//thousands of ticks' worth of sounds and messages from piling up
+	bool wasHeadless = g_theGame->m_isHeadless;
+	g_theGame->m_isHeadless = true;
+	StressRunResult result = RunStressTicks(*g_theGame, numTicks, deltaSeconds);
+	g_theGame->m_isHeadless = wasHeadless;
+	g_theGame->m_isSidebarDirty = true;
+
+	double ticks = result.m_numTicksRun > 0 ? static_cast<double>(result.m_numTicksRun) : 1.0;
+	double msPerTick = result.m_secondsElapsed * 1000.0 / ticks;
+	double ticksPerSecond = result.m_secondsElapsed > 0.0 ? static_cast<double>(result.m_numTicksRun) / result.m_secondsElapsed : 0.0;
+	MapPhaseTimings const& timings = result.m_mapTimings;
+	double mapSeconds = timings.m_bloonSeconds + timings.m_towerSeconds + timings.m_projectileSeconds + timings.m_collisionSeconds + timings.m_cleanupSeconds;
+
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("%i ticks of %.4f s in %.1f ms: %.3f ms/tick, %.0f ticks/s (%.1fx real time)", result.m_numTicksRun, deltaSeconds,
+		result.m_secondsElapsed * 1000.0, msPerTick, ticksPerSecond, ticksPerSecond * deltaSeconds));
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("ms/tick: bloons %.3f  towers %.3f  projectiles %.3f  collisions %.3f  cleanup+hash %.3f  rounds %.3f",
+		timings.m_bloonSeconds * 1000.0 / ticks, timings.m_towerSeconds * 1000.0 / ticks, timings.m_projectileSeconds * 1000.0 / ticks, timings.m_collisionSeconds * 1000.0 / ticks,
+		timings.m_cleanupSeconds * 1000.0 / ticks, (result.m_secondsElapsed - mapSeconds) * 1000.0 / ticks));
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("start/peak/end: bloons %i/%i/%i  swarmed %i/%i/%i  towers %i/%i/%i  projectiles %i/%i/%i",
+		result.m_startCounts.m_numBloons, result.m_peakCounts.m_numBloons, result.m_endCounts.m_numBloons,
+		result.m_startCounts.m_numSwarmBloons, result.m_peakCounts.m_numSwarmBloons, result.m_endCounts.m_numSwarmBloons,
+		result.m_startCounts.m_numTowers, result.m_peakCounts.m_numTowers, result.m_endCounts.m_numTowers,
+		result.m_startCounts.m_numProjectiles, result.m_peakCounts.m_numProjectiles, result.m_endCounts.m_numProjectiles));
 	return true;
 }
 
 
-bool Game::Event_SellTower(EventArgs& args)
+bool Game::Event_Telemetry(EventArgs& args)
 {
-	UNUSED(args);
+	if (g_theGame == nullptr) return false;
 
-	if (g_theGame->m_selectedTower == nullptr)
+	if (!args.GetValue("Enabled", true))
 	{
-		return false;
+		if (g_theGame->m_roundTelemetry == nullptr) return true;
+
+		int numRoundsRecorded = g_theGame->m_roundTelemetry->m_numRoundsRecorded;
+		delete g_theGame->m_roundTelemetry;
+		g_theGame->m_roundTelemetry = nullptr;
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Telemetry off after %i rounds", numRoundsRecorded));
+		return true;
 	}
 
-	//find the selected tower in the vector and delete it
-	for (int towerIndex = 0; towerIndex < g_theGame->m_currentMap->m_towers.size(); towerIndex++)
+	TelemetryFormat format = TelemetryFormat::CSV;
+	std::string formatName = args.GetValue("Format", "csv");
+	if (!RoundTelemetry::GetFormatFromString(formatName, format))
 	{
-		Tower*& tower = g_theGame->m_currentMap->m_towers[towerIndex];
-		
-		if (tower == g_theGame->m_selectedTower)
-		{
-			g_theGame->m_selectedTower = nullptr;
-			g_theGame->m_currentMap->SellTower(towerIndex);
-			return true;
-		}
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Unknown telemetry format %s! Use csv, json or both", formatName.c_str()));
+		return false;
 	}
+	std::string runName = args.GetValue("Run", "Telemetry");
 
-	//should never get here
-	ERROR_RECOVERABLE("Attempted to sell tower that is not part of map");
-	return false;
+	delete g_theGame->m_roundTelemetry;
+	g_theGame->m_roundTelemetry = new RoundTelemetry(runName, format);
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Recording per-round telemetry to Data/Telemetry/%s_Round<n>.%s", runName.c_str(), formatName.c_str()));
+	return true;
 }
 
 
-bool Game::Event_BuyUpgrade1(EventArgs& args)
+bool Game::Event_RunBatch(EventArgs& args)
 {
-	UNUSED(args);
-
-	if (g_theGame->m_selectedTower == nullptr)
-	{
-		return false;
-	}
+	if (g_theGame == nullptr) return false;
 
-	Tower*& tower = g_theGame->m_selectedTower;
-	TowerDefinition const* towerDef = tower->m_definition;
-	if (g_theGame->m_numMoney < towerDef->m_upgrade1Cost)
-	{
-		DebugAddMessage("Can't afford upgrade!", 7.0f, Rgba8(190, 20, 30), Rgba8(255, 255, 255, 0));
-		return false;
-	}
+	std::string filePath = args.GetValue("File", "Data/Batches/Batch.xml");
+	int numWorkers = args.GetValue("Workers", 0);
 
-	//replace the tower's definition with the definition of its first upgrade
-	TowerDefinition const* upgrade1Def = TowerDefinition::GetTowerDefinitionByName(towerDef->m_upgrade1);
-	if (upgrade1Def == nullptr)
+	std::string summary;
+	if (!RunBatchFile(filePath, numWorkers, summary))
 	{
-		DebugAddMessage("Upgrade was null!", 7.0f, Rgba8(190, 20, 30), Rgba8(255, 255, 255, 0));
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, summary);
 		return false;
 	}
 
-	g_theGame->m_numMoney -= towerDef->m_upgrade1Cost;
-	tower->m_definition = upgrade1Def;
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, summary);
 	return true;
 }
 
 
-bool Game::Event_BuyUpgrade2(EventArgs& args)
+bool Game::Event_EstimateCoverage(EventArgs& args)
 {
-	UNUSED(args);
+	if (g_theGame == nullptr || g_theGame->m_currentMap == nullptr) return false;
 
-	if (g_theGame->m_selectedTower == nullptr)
+	int firstRound = args.GetValue("First", g_theGame->m_roundNumber);
+	int lastRound = args.GetValue("Last", firstRound + 9);
+	bool validate = args.GetValue("Validate", false);
+
+	if (!validate)
 	{
-		return false;
+		double startTime = GetCurrentTimeSeconds();
+		CoverageEstimator estimator = CoverageEstimator(*g_theGame->m_currentMap);
+		int survivalRound = estimator.EstimateSurvivalRound(g_theGame->m_numLives, firstRound, lastRound, g_theGame->m_freeplaySeed);
+		double microseconds = (GetCurrentTimeSeconds() - startTime) * 1000000.0;
+
+		for (int towerIndex = 0; towerIndex < estimator.m_towers.size(); towerIndex++)
+		{
+			TowerCoverageEstimate const& coverage = estimator.m_towers[towerIndex];
+			g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Tower %i (%s): %.1f track in range, %.2f shots/s", coverage.m_towerSlot,
+				g_theGame->m_currentMap->m_towers[coverage.m_towerSlot]->m_definition->m_name.c_str(), coverage.m_coveredTrackLength, coverage.m_shotsPerSecond));
+		}
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Estimated survival through round %i of %i-%i with %i lives in %.1f us", survivalRound, firstRound, lastRound,
+			g_theGame->m_numLives, microseconds));
+		return true;
 	}
 
-	Tower*& tower = g_theGame->m_selectedTower;
-	TowerDefinition const* towerDef = tower->m_definition;
-	if (g_theGame->m_numMoney < towerDef->m_upgrade2Cost)
+	if (g_theGame->m_isRoundActive)
 	{
-		DebugAddMessage("Can't afford upgrade!", 7.0f, Rgba8(190, 20, 30), Rgba8(255, 255, 255, 0));
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, "Validate the estimate between rounds!");
 		return false;
 	}
 
-	//replace the tower's definition with the definition of its first upgrade
-	TowerDefinition const* upgrade2Def = TowerDefinition::GetTowerDefinitionByName(towerDef->m_upgrade2);
-	if (upgrade2Def == nullptr)
+	CoverageValidationResult result = ValidateCoverageEstimate(*g_theGame, firstRound, lastRound);
+	float totalAbsoluteError = 0.0f;
+	for (int roundIndex = 0; roundIndex < result.m_rounds.size(); roundIndex++)
 	{
-		DebugAddMessage("Upgrade was null!", 7.0f, Rgba8(190, 20, 30), Rgba8(255, 255, 255, 0));
-		return false;
+		CoverageValidationRound const& round = result.m_rounds[roundIndex];
+		float error = round.m_estimate.m_leakedRBE - static_cast<float>(round.m_simulatedLeakedRBE);
+		totalAbsoluteError += fabsf(error);
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Round %i: %i RBE, estimated %.1f leaked, simulated %i leaked", round.m_estimate.m_roundNumber,
+			round.m_estimate.m_totalRBE, round.m_estimate.m_leakedRBE, round.m_simulatedLeakedRBE));
 	}
-
-	g_theGame->m_numMoney -= towerDef->m_upgrade2Cost;
-	tower->m_definition = upgrade2Def;
+	int numRounds = static_cast<int>(result.m_rounds.size());
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Estimated %i rounds in %.1f us, simulated in %.2f s, mean leak error %.1f RBE/round", numRounds,
+		result.m_estimateMicroseconds, result.m_simulateSeconds, numRounds > 0 ? totalAbsoluteError / static_cast<float>(numRounds) : 0.0f));
 	return true;
 }
 
 
-bool Game::Event_StartRound(EventArgs& args)
+//drives a vector environment through its C ABI the way training code would: a tower placement on the first step,
+//then starting rounds every step, checking along the way that each step cleared the actions it applied and that no
+//round was started while one was already running
+bool Game::Event_StepEnvironments(EventArgs& args)
 {
-	UNUSED(args);
+	if (g_theGame == nullptr) return false;
 
-	//DebugAddMessage("Start Round!", 5.0f);
+	int numEnvironments = args.GetValue("Envs", 64);
+	int numSteps = args.GetValue("Steps", 100);
+	int mapIndex = args.GetValue("Map", 0);
+	int gridSize = args.GetValue("Grid", 0);
 
-	g_theGame->m_isRoundActive = true;
-	g_theGame->m_roundDef = RoundDefinition::GetRoundDefinitionByIndex(g_theGame->m_roundNumber - 1);
-	if (g_theGame->m_roundDef == nullptr)
+	int result = VECTOR_ENVIRONMENT_OK;
+	VectorEnvironment* environment = VectorEnvironment_Create(numEnvironments, &mapIndex, 1, 60, 1.0f / 60.0f, 0, gridSize, gridSize, &result);
+	if (environment == nullptr)
 	{
-		DebugAddMessage("No more rounds!", 5.0f);
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Could not create %i environments on map %i (error %i)!", numEnvironments, mapIndex, result));
+		return false;
 	}
-	else
-	{
-		for (int waveIndex = 0; waveIndex < g_theGame->m_roundDef->m_waves.size(); waveIndex++)
-		{
-			Wave const& wave = g_theGame->m_roundDef->m_waves[waveIndex];
 
-			g_theGame->m_waveTimers.emplace_back(wave.m_timeToStart);
-			g_theGame->m_waveCounts.emplace_back(wave.m_numBloons);
-		}
+	std::vector<EnvironmentAction> placeActions(numEnvironments);
+	for (int envIndex = 0; envIndex < numEnvironments; envIndex++)
+	{
+		placeActions[envIndex].m_type = static_cast<int32_t>(EnvironmentActionType::PLACE_TOWER);
+		placeActions[envIndex].m_index = 0;
+		placeActions[envIndex].m_x = PLAYFIELD_SIZE_X * static_cast<float>(envIndex + 1) / static_cast<float>(numEnvironments + 1);
+		placeActions[envIndex].m_y = SCREEN_CAMERA_SIZE_Y * 0.5f;
 	}
-	
-	return true;
-}
-
-
-bool Game::Event_ToggleTargetingMode(EventArgs& args)
-{
-	UNUSED(args);
 
-	switch (g_theGame->m_selectedTower->m_targetingMode)
+	double startTime = GetCurrentTimeSeconds();
+	float totalReward = 0.0f;
+	int numDone = 0;
+	int numAccepted = 0;
+	int numLeftoverActions = 0;
+	int numMidRoundStarts = 0;
+	std::vector<uint8_t> wasRoundActive(numEnvironments, 0);
+	for (int stepIndex = 0; stepIndex < numSteps && result == VECTOR_ENVIRONMENT_OK; stepIndex++)
 	{
-		case TargetingMode::FIRST:
+		float const* observations = VectorEnvironment_GetObservations(environment);
+		for (int envIndex = 0; envIndex < numEnvironments; envIndex++)
 		{
-			g_theGame->m_selectedTower->m_targetingMode = TargetingMode::LAST;
-			return true;
+			wasRoundActive[envIndex] = observations[envIndex * ENV_OBSERVATION_SIZE + 3] > 0.0f ? 1 : 0;
 		}
-		case TargetingMode::LAST:
+
+		if (stepIndex == 0)
 		{
-			g_theGame->m_selectedTower->m_targetingMode = TargetingMode::NEAR;
-			return true;
+			result = VectorEnvironment_Step(environment, placeActions.data(), numEnvironments);
 		}
-		case TargetingMode::NEAR:
+		else
 		{
-			g_theGame->m_selectedTower->m_targetingMode = TargetingMode::STRONG;
-			return true;
+			EnvironmentAction* actions = VectorEnvironment_GetActions(environment);
+			for (int envIndex = 0; envIndex < numEnvironments; envIndex++)
+			{
+				numLeftoverActions += actions[envIndex].m_type != static_cast<int32_t>(EnvironmentActionType::NONE) ? 1 : 0;
+				actions[envIndex].m_type = static_cast<int32_t>(EnvironmentActionType::START_ROUND);
+			}
+			result = VectorEnvironment_Step(environment, nullptr, 0);
 		}
-		case TargetingMode::STRONG:
+
+		float const* rewards = VectorEnvironment_GetRewards(environment);
+		uint8_t const* dones = VectorEnvironment_GetDones(environment);
+		uint8_t const* accepted = VectorEnvironment_GetActionsAccepted(environment);
+		for (int envIndex = 0; envIndex < numEnvironments; envIndex++)
 		{
-			g_theGame->m_selectedTower->m_targetingMode = TargetingMode::WEAK;
-			return true;
+			totalReward += rewards[envIndex];
+			numDone += dones[envIndex];
+			numAccepted += accepted[envIndex];
+			numMidRoundStarts += stepIndex > 0 && wasRoundActive[envIndex] != 0 && accepted[envIndex] != 0 ? 1 : 0;
 		}
-		case TargetingMode::WEAK:
+	}
+	double seconds = GetCurrentTimeSeconds() - startTime;
+	VectorEnvironment_Destroy(environment);
+
+	if (result != VECTOR_ENVIRONMENT_OK || numLeftoverActions > 0 || numMidRoundStarts > 0)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Vector environment step failed (error %i, %i actions left over from the previous step, %i rounds started mid-round)!",
+			result, numLeftoverActions, numMidRoundStarts));
+		return false;
+	}
+
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("Stepped %i environments %i times in %.2f s (%.0f env steps/s): %i actions accepted, %i episodes ended, total reward %.2f",
+		numEnvironments, numSteps, seconds, seconds > 0.0 ? static_cast<double>(numEnvironments) * numSteps / seconds : 0.0, numAccepted, numDone, totalReward));
+	return true;
+}
+
+
+bool Game::Event_BenchmarkProjectiles(EventArgs& args)
+{
+	if (g_theGame == nullptr) return false;
+
+	int numProjectiles = args.GetValue("Count", 100000);
+	int numTicks = args.GetValue("Ticks", 600);
+	std::string projDefName = args.GetValue("Projectile", "");
+
+	//without a name, use the first projectile that flies straight and runs out of lifespan
+	ProjectileDefinition const* projDef = nullptr;
+	if (!projDefName.empty())
+	{
+		projDef = ProjectileDefinition::GetProjectileDefinitionByName(projDefName);
+	}
+	for (int defIndex = 0; defIndex < ProjectileDefinition::s_projectileDefinitions.size() && projDefName.empty(); defIndex++)
+	{
+		ProjectileDefinition const& def = ProjectileDefinition::s_projectileDefinitions[defIndex];
+		if (!def.m_curvedArc && !def.m_isRoadItem)
 		{
-			g_theGame->m_selectedTower->m_targetingMode = TargetingMode::FIRST;
-			return true;
+			projDef = &def;
+			break;
 		}
 	}
+	if (projDef == nullptr)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Unknown projectile %s!", projDefName.c_str()));
+		return false;
+	}
 
-	return false;
+	int mapIndex = 0;
+	if (g_theGame->m_currentMap != nullptr)
+	{
+		mapIndex = static_cast<int>(g_theGame->m_currentMap->m_definition - MapDefinition::s_mapDefinitions.data());
+	}
+
+	MemoryTagStats startMemoryStats[static_cast<int>(MemoryTag::NUM_MEMORY_TAGS)];
+	BeginHeadlessMemoryReport(startMemoryStats);
+	ProjectileBenchmarkResult result = RunProjectileBenchmark(mapIndex, projDef, numProjectiles, numTicks);
+	EndHeadlessMemoryReport("BenchmarkProjectiles", startMemoryStats);
+
+	double secondsPerTick = result.m_numTicksRun > 0 ? result.m_secondsElapsed / static_cast<double>(result.m_numTicksRun) : 0.0;
+	double updatesPerSecond = result.m_secondsElapsed > 0.0 ? static_cast<double>(result.m_numProjectiles) * static_cast<double>(result.m_numTicksRun) / result.m_secondsElapsed : 0.0;
+	double bytesPerProjectile = result.m_numProjectiles > 0 ? static_cast<double>(result.m_numBytesAllocated) / static_cast<double>(result.m_numProjectiles) : 0.0;
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, Stringf("%i %s projectiles, %i ticks: %.3f ms/tick, %.1f M projectile updates/s", result.m_numProjectiles,
+		projDef->m_name.c_str(), result.m_numTicksRun, secondsPerTick * 1000.0, updatesPerSecond / 1000000.0));
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("%.1f bytes per projectile allocated, %i of them touched every tick (budget %i)", bytesPerProjectile,
+		static_cast<int>(PROJECTILE_HOT_BYTES), static_cast<int>(PROJECTILE_HOT_BYTES_TARGET)));
+	return true;
 }
 
 
-bool Game::Event_SelectMap(EventArgs& args)
+bool Game::Event_MemoryStats(EventArgs& args)
 {
-	UNUSED(args);
+	std::string summary = GetMemoryTrackingSummary();
 
-	g_theGame->m_isMapSelection = false;
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, "Memory by subsystem since startup:");
+	size_t lineStart = 0;
+	while (lineStart < summary.size())
+	{
+		size_t lineEnd = summary.find('\n', lineStart);
+		if (lineEnd == std::string::npos) lineEnd = summary.size();
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, summary.substr(lineStart, lineEnd - lineStart));
+		lineStart = lineEnd + 1;
+	}
 
+	if (args.GetValue("ResetPeaks", false))
+	{
+		ResetMemoryHighWaterMarks();
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MAJOR, "Peaks reset to current live bytes");
+	}
 	return true;
 }
 
@@ -737,6 +2066,8 @@ bool Game::Event_SelectMap(EventArgs& args)
 
 void Game::UpdateUISidebar(Vec2 orthoMousePos)
 {
+	ScopedMemoryTag memoryTag(MemoryTag::UI);
+
 	if (m_isMapSelection)
 	{
 		m_map1Button.Update();
@@ -759,96 +2090,162 @@ void Game::UpdateUISidebar(Vec2 orthoMousePos)
 		return;
 	}
 
-	bool drawingShopInfo = false;
+	RefreshUISidebar();
+
 	for (int buttonIndex = 0; buttonIndex < m_shopButtons.size(); buttonIndex++)
 	{
-		Button& button = m_shopButtons[buttonIndex];
-
-		button.Update();
-
-		if (button.IsMouseInsideBounds())
-		{
-			drawingShopInfo = true;
-		}
+		m_shopButtons[buttonIndex].Update();
 	}
 
-	if (m_selectedTower != nullptr && !drawingShopInfo)
+	if (m_selectedTower != nullptr && m_sidebarState.m_hoveredShopButtonIndex == -1)
 	{
-		TowerDefinition const* towerDef = m_selectedTower->m_definition;
-
-		if (TowerDefinition::GetTowerDefinitionByName(towerDef->m_upgrade1) == nullptr)
-		{
-			m_upgrade1Button.m_text = "Upgraded";
-			m_upgrade1Button.m_color = Rgba8(100, 255, 100);
-			m_upgrade1Button.m_selectedColor = Rgba8(100, 255, 100);
-		}
-		else
+		if (m_canBuyUpgrade1)
 		{
-			m_upgrade1Button.m_text = Stringf("%s: $%i", towerDef->m_upgrade1Name.c_str(), towerDef->m_upgrade1Cost);
-			if (g_theGame->m_numMoney < towerDef->m_upgrade1Cost)
-			{
-				m_upgrade1Button.m_color = Rgba8(200, 50, 50);
-				m_upgrade1Button.m_selectedColor = Rgba8(200, 50, 50);
-			}
-			else
-			{
-				m_upgrade1Button.m_color = Rgba8(50, 200, 50);
-				m_upgrade1Button.m_selectedColor = Rgba8(100, 255, 100);
-			}
 			m_upgrade1Button.Update();
 		}
-		
-		if (TowerDefinition::GetTowerDefinitionByName(towerDef->m_upgrade2) == nullptr)
-		{
-			m_upgrade2Button.m_text = "Upgraded";
-			m_upgrade2Button.m_color = Rgba8(100, 255, 100);
-			m_upgrade2Button.m_selectedColor = Rgba8(100, 255, 100);
-		}
-		else
+		if (m_canBuyUpgrade2)
 		{
-			m_upgrade2Button.m_text = Stringf("%s: $%i", towerDef->m_upgrade2Name.c_str(), towerDef->m_upgrade2Cost);
-			if (g_theGame->m_numMoney < towerDef->m_upgrade2Cost)
-			{
-				m_upgrade2Button.m_color = Rgba8(200, 50, 50);
-				m_upgrade2Button.m_selectedColor = Rgba8(200, 50, 50);
-			}
-			else
-			{
-				m_upgrade2Button.m_color = Rgba8(50, 200, 50);
-				m_upgrade2Button.m_selectedColor = Rgba8(100, 255, 100);
-			}
 			m_upgrade2Button.Update();
 		}
-		
-		if (towerDef->m_isTracking)
+		if (m_selectedTower->m_definition->m_isTracking)
 		{
-			m_targetModeButton.m_text = Stringf("Targeting Mode: %s", m_selectedTower->GetTargetingModeAsString().c_str());
 			m_targetModeButton.Update();
 		}
-
-		int sellPrice = towerDef->m_cost * 8 / 10;
-		std::string sellButtonText = Stringf("Sell for: %i", sellPrice);
-		m_sellButton.m_text = sellButtonText;
 		m_sellButton.Update();
 	}
 	else if(m_selectedTower == nullptr && m_heldTower == nullptr && !m_isRoundActive)
 	{
 		m_startButton.Update();
 	}
+
+	//pick up anything the buttons just changed so this frame renders it
+	RefreshUISidebar();
+}
+
+
+UISidebarState Game::GetCurrentUISidebarState() const
+{
+	UISidebarState state;
+	state.m_numMoney = m_numMoney;
+
+	for (int buttonIndex = 0; buttonIndex < m_shopButtons.size(); buttonIndex++)
+	{
+		if (m_shopButtons[buttonIndex].IsMouseInsideBounds())
+		{
+			state.m_hoveredShopButtonIndex = buttonIndex;
+			break;
+		}
+	}
+
+	if (m_selectedTower != nullptr)
+	{
+		state.m_selectedTower = m_selectedTower;
+		state.m_selectedTowerDef = m_selectedTower->m_definition;
+		state.m_targetingMode = static_cast<int>(m_selectedTower->m_targetingMode);
+	}
+
+	return state;
+}
+
+
+bool UISidebarState::operator==(UISidebarState const& other) const
+{
+	return m_selectedTower == other.m_selectedTower
+		&& m_selectedTowerDef == other.m_selectedTowerDef
+		&& m_targetingMode == other.m_targetingMode
+		&& m_numMoney == other.m_numMoney
+		&& m_hoveredShopButtonIndex == other.m_hoveredShopButtonIndex;
+}
+
+
+//texts, colors and info box only change when the sidebar state does
+void Game::RefreshUISidebar()
+{
+	UISidebarState currentState = GetCurrentUISidebarState();
+	if (m_isSidebarDirty || !(currentState == m_sidebarState))
+	{
+		m_sidebarState = currentState;
+		RebuildUISidebar();
+	}
+}
+
+
+void Game::RebuildUISidebar()
+{
+	m_isSidebarDirty = false;
+
+	//hovered shop tower info
+	m_towerInfoBoxVerts.clear();
+	m_towerInfoTextVerts.clear();
+	if (m_sidebarState.m_hoveredShopButtonIndex != -1)
+	{
+		TowerDefinition const* def = m_shopButtonDefs[m_sidebarState.m_hoveredShopButtonIndex];
+
+		AddVertsForAABB2(m_towerInfoBoxVerts, m_infoBounds, Rgba8(235, 245, 255));
+		m_menuFont->AddVertsForTextInBox2D(m_towerInfoTextVerts, m_infoBounds, 16.0f, Stringf("Cost: %i", def->m_cost), Rgba8(0, 0, 0), 1.0f, Vec2(0.5f, 1.0f));
+
+		AABB2 descBounds = AABB2(m_infoBounds.m_mins, m_infoBounds.m_maxs - Vec2(0.0f, 22.0f));
+		m_menuFont->AddVertsForTextInBox2D(m_towerInfoTextVerts, descBounds, 14.0f, def->m_description, Rgba8(0, 0, 0), 1.0f, Vec2(0.5f, 1.0f));
+	}
+
+	//selected tower menu
+	m_canBuyUpgrade1 = false;
+	m_canBuyUpgrade2 = false;
+	TowerDefinition const* towerDef = m_sidebarState.m_selectedTowerDef;
+	if (towerDef == nullptr)
+	{
+		return;
+	}
+
+	m_canBuyUpgrade1 = TowerDefinition::GetTowerDefinitionByName(towerDef->m_upgrade1) != nullptr;
+	m_canBuyUpgrade2 = TowerDefinition::GetTowerDefinitionByName(towerDef->m_upgrade2) != nullptr;
+	RebuildUpgradeButton(m_upgrade1Button, towerDef->m_upgrade1, towerDef->m_upgrade1Name, towerDef->m_upgrade1Cost);
+	RebuildUpgradeButton(m_upgrade2Button, towerDef->m_upgrade2, towerDef->m_upgrade2Name, towerDef->m_upgrade2Cost);
+
+	if (towerDef->m_isTracking)
+	{
+		m_targetModeButton.m_text = Stringf("Targeting Mode: %s", m_selectedTower->GetTargetingModeAsString().c_str());
+	}
+
+	int sellPrice = towerDef->m_cost * 8 / 10;
+	m_sellButton.m_text = Stringf("Sell for: %i", sellPrice);
+}
+
+
+void Game::RebuildUpgradeButton(Button& button, std::string const& upgradeDefName, std::string const& upgradeName, int upgradeCost)
+{
+	if (TowerDefinition::GetTowerDefinitionByName(upgradeDefName) == nullptr)
+	{
+		button.m_text = "Upgraded";
+		button.m_color = Rgba8(100, 255, 100);
+		button.m_selectedColor = Rgba8(100, 255, 100);
+		return;
+	}
+
+	button.m_text = Stringf("%s: $%i", upgradeName.c_str(), upgradeCost);
+	if (m_numMoney < upgradeCost)
+	{
+		button.m_color = Rgba8(200, 50, 50);
+		button.m_selectedColor = Rgba8(200, 50, 50);
+	}
+	else
+	{
+		button.m_color = Rgba8(50, 200, 50);
+		button.m_selectedColor = Rgba8(100, 255, 100);
+	}
 }
 
 
 void Game::RenderUISidebar() const
 {
 	//draw base rectangle
-	std::vector<Vertex_PCU> baseVerts;
-	AddVertsForAABB2(baseVerts, m_UIBaseBounds, Rgba8(195, 210, 225));
 	g_theRenderer->BindTexture(nullptr);
-	g_theRenderer->DrawVertexArray(baseVerts);
+	g_theRenderer->DrawVertexArray(m_sidebarBaseVerts);
 
 	if (m_isMapSelection)
 	{
-		DebugAddScreenText("Select Map:", Vec2(SCREEN_CAMERA_SIZE_X - SCREEN_CAMERA_SIZE_Y * 0.02f, SCREEN_CAMERA_SIZE_Y * 0.9f), 32.0f, Vec2(1.0f, 0.5f), 0.0f);
+		g_theRenderer->BindTexture(&m_menuFont->GetTexture());
+		g_theRenderer->DrawVertexArray(m_selectMapTextVerts);
 
 		m_map1Button.Render();
 		m_map2Button.Render();
@@ -858,20 +2255,17 @@ void Game::RenderUISidebar() const
 	}
 
 	//draw tower buying icons
-	bool drawingShopInfo = false;
 	for (int buttonIndex = 0; buttonIndex < m_shopButtons.size(); buttonIndex++)
 	{
-		Button const& button = m_shopButtons[buttonIndex];
-
-		button.Render();
+		m_shopButtons[buttonIndex].Render();
+	}
 
-		//render tower info if icon is hovered
-		if (button.IsMouseInsideBounds() && m_resetTimer == 0.0f)
-		{
-			TowerDefinition const* def = TowerDefinition::GetTowerDefinitionByName(button.m_args.GetValue("Name", "invalid"));
-			RenderTowerInfo(def);
-			drawingShopInfo = true;
-		}
+	//render tower info if icon is hovered
+	RenderSnapshot const& snapshot = GetFrontRenderSnapshot();
+	bool drawingShopInfo = m_sidebarState.m_hoveredShopButtonIndex != -1 && snapshot.m_resetTimer == 0.0f;
+	if (drawingShopInfo)
+	{
+		RenderTowerInfo();
 	}
 
 	//render upgrade menu if tower is selected
@@ -885,32 +2279,22 @@ void Game::RenderUISidebar() const
 		}
 		m_sellButton.Render();
 	}
-	else if (m_selectedTower == nullptr && m_heldTower == nullptr && !m_isRoundActive)
+	else if (m_selectedTower == nullptr && m_heldTower == nullptr && !snapshot.m_isRoundActive)
 	{
 		m_startButton.Render();
 	}
 }
 
 
-void Game::RenderTowerInfo(TowerDefinition const* def) const
+void Game::RenderTowerInfo() const
 {
 	//render underlying quad
-	std::vector<Vertex_PCU> boxVerts;
-	AddVertsForAABB2(boxVerts, m_infoBounds, Rgba8(235, 245, 255));
 	g_theRenderer->BindTexture(nullptr);
-	g_theRenderer->DrawVertexArray(boxVerts);
-
-	//render cost
-	std::vector<Vertex_PCU> textVerts;
-	std::string costString = Stringf("Cost: %i", def->m_cost);
-	m_menuFont->AddVertsForTextInBox2D(textVerts, m_infoBounds, 16.0f, costString, Rgba8(0, 0, 0), 1.0f, Vec2(0.5f, 1.0f));
-
-	//render description
-	AABB2 descBounds = AABB2(m_infoBounds.m_mins, m_infoBounds.m_maxs - Vec2(0.0f, 22.0f));
-	m_menuFont->AddVertsForTextInBox2D(textVerts, descBounds, 14.0f, def->m_description, Rgba8(0, 0, 0), 1.0f, Vec2(0.5f, 1.0f));
+	g_theRenderer->DrawVertexArray(m_towerInfoBoxVerts);
 
+	//render cost and description
 	g_theRenderer->BindTexture(&m_menuFont->GetTexture());
-	g_theRenderer->DrawVertexArray(textVerts);
+	g_theRenderer->DrawVertexArray(m_towerInfoTextVerts);
 }
 
 
@@ -1041,6 +2425,8 @@ void Game::UpdateSplineEditor(Vec2 orthoMousePos)
 		m_currentMap->m_trackSpline.emplace_back(CubicBezierCurve2D(Vec2(SCREEN_CAMERA_CENTER_X, SCREEN_CAMERA_CENTER_Y), Vec2(SCREEN_CAMERA_CENTER_X, SCREEN_CAMERA_CENTER_Y + 33.3f),
 			Vec2(SCREEN_CAMERA_CENTER_X, SCREEN_CAMERA_CENTER_Y + 66.7f), Vec2(SCREEN_CAMERA_CENTER_X, SCREEN_CAMERA_CENTER_Y + 100.0f)));
 	}
+
+	RefreshSplineEditorCache();
 }
 
 
@@ -1051,15 +2437,66 @@ void Game::RenderSplineEditor() const
 		return;
 	}
 
-	std::vector<Vertex_PCU> splineVerts;
+	g_theRenderer->BindTexture(nullptr);
+	g_theRenderer->DrawVertexArray(m_splineEditorVerts);
 
+	std::vector<Vertex_PCU>& highlightVerts = g_frameArena.AcquireVerts();
 	for (int curveIndex = 0; curveIndex < m_currentMap->m_trackSpline.size(); curveIndex++)
 	{
-		AddVertsForBezierCurve(splineVerts, m_currentMap->m_trackSpline[curveIndex]);
+		AddVertsForControlPointHighlights(highlightVerts, m_currentMap->m_trackSpline[curveIndex]);
+	}
+	if (!highlightVerts.empty())
+	{
+		g_theRenderer->DrawVertexArray(highlightVerts);
 	}
+}
 
-	g_theRenderer->BindTexture(nullptr);
-	g_theRenderer->DrawVertexArray(splineVerts);
+
+//re-tessellates only the curves whose control points moved since the last call and tells the map which ones changed
+void Game::RefreshSplineEditorCache()
+{
+	std::vector<CubicBezierCurve2D> const& spline = m_currentMap->m_trackSpline;
+	int numCurves = static_cast<int>(spline.size());
+	int numCachedCurves = static_cast<int>(m_tessellatedCurves.size());
+
+	bool anyCurveChanged = numCurves != numCachedCurves;
+	m_tessellatedCurves.resize(numCurves);
+	m_curveEditorVerts.resize(numCurves);
+
+	int firstChangedCurveIndex = numCurves;
+	int lastChangedCurveIndex = -1;
+	for (int curveIndex = 0; curveIndex < numCurves; curveIndex++)
+	{
+		CubicBezierCurve2D const& curve = spline[curveIndex];
+		CubicBezierCurve2D const& tessellatedCurve = m_tessellatedCurves[curveIndex];
+
+		bool isNewCurve = curveIndex >= numCachedCurves;
+		if (!isNewCurve && curve.A == tessellatedCurve.A && curve.B == tessellatedCurve.B && curve.C == tessellatedCurve.C && curve.D == tessellatedCurve.D)
+		{
+			continue;
+		}
+
+		m_tessellatedCurves[curveIndex] = curve;
+		m_curveEditorVerts[curveIndex].clear();
+		AddVertsForBezierCurve(m_curveEditorVerts[curveIndex], curve);
+
+		if (firstChangedCurveIndex > curveIndex) firstChangedCurveIndex = curveIndex;
+		lastChangedCurveIndex = curveIndex;
+		anyCurveChanged = true;
+	}
+
+	if (!anyCurveChanged)
+	{
+		return;
+	}
+
+	m_currentMap->OnTrackCurvesChanged(firstChangedCurveIndex, lastChangedCurveIndex);
+
+	m_splineEditorVerts.clear();
+	for (int curveIndex = 0; curveIndex < numCurves; curveIndex++)
+	{
+		m_splineEditorVerts.insert(m_splineEditorVerts.end(), m_curveEditorVerts[curveIndex].begin(), m_curveEditorVerts[curveIndex].end());
+	}
 }
 
 
@@ -1068,8 +2505,6 @@ void Game::AddVertsForBezierCurve(std::vector<Vertex_PCU>& verts, CubicBezierCur
 	//constexpr float SPLINE_THICKNESS = 5.0f;
 	Rgba8 const splineColor = Rgba8(225, 0, 225);
 	Rgba8 const discColor = Rgba8(225, 0, 50);
-	Rgba8 const highlightedDiscColor = Rgba8(100, 175, 50);
-	Rgba8 const selectedDiscColor = Rgba8(50, 255, 50);
 
 	//render lines from control points to curve
 	Vec2 oneThirdPoint = curve.EvaluateAtParametric(0.333f);
@@ -1101,6 +2536,13 @@ void Game::AddVertsForBezierCurve(std::vector<Vertex_PCU>& verts, CubicBezierCur
 	AddVertsForDisc2D(verts, curve.B, TRACK_WIDTH * 2.5f, discColor);
 	AddVertsForDisc2D(verts, curve.C, TRACK_WIDTH * 2.5f, discColor);
 	AddVertsForDisc2D(verts, curve.D, TRACK_WIDTH * 2.5f, discColor);
+}
+
+
+void Game::AddVertsForControlPointHighlights(std::vector<Vertex_PCU>& verts, CubicBezierCurve2D const& curve) const
+{
+	Rgba8 const highlightedDiscColor = Rgba8(100, 175, 50);
+	Rgba8 const selectedDiscColor = Rgba8(50, 255, 50);
 
 	//render selected/highlighted control point
 	if (m_highlightedControlPoint != nullptr)
@@ -1144,6 +2586,25 @@ void Game::AddVertsForBezierCurve(std::vector<Vertex_PCU>& verts, CubicBezierCur
 }
 
 
+//one line per subsystem: what it holds now, its peak, and what it allocated last frame
+void Game::AddVertsForMemoryOverlay(std::vector<Vertex_PCU>& verts, float textHeight) const
+{
+	int numTags = static_cast<int>(MemoryTag::NUM_MEMORY_TAGS);
+	for (int tagIndex = 0; tagIndex < numTags; tagIndex++)
+	{
+		MemoryTag tag = static_cast<MemoryTag>(tagIndex);
+		MemoryTagStats stats = GetMemoryTagStats(tag);
+		MemoryTagStats frameStats = GetLastFrameMemoryStats(tag);
+
+		std::string const& line = g_frameArena.FormatString("%-12s live %9.1f KB  peak %9.1f KB  frame %5llu / %8.1f KB", GetMemoryTagName(tag),
+			static_cast<double>(stats.m_numLiveBytes) / 1024.0, static_cast<double>(stats.m_highWaterBytes) / 1024.0, static_cast<unsigned long long>(frameStats.m_numAllocations),
+			static_cast<double>(frameStats.m_numBytesAllocated) / 1024.0);
+		Vec2 lineMins = Vec2(SCREEN_CAMERA_SIZE_X - textHeight * static_cast<float>(line.size()), SCREEN_CAMERA_SIZE_Y - textHeight * static_cast<float>(tagIndex + 2));
+		m_menuFont->AddVertsForText2D(verts, lineMins, textHeight, line);
+	}
+}
+
+
 //
 //setup functions
 //
@@ -1154,6 +2615,7 @@ void Game::AddButtonsForShop()
 	AABB2 dartMonkeyButtonBounds = AABB2(dartMonkeyButtonMins, dartMonkeyButtonMins + Vec2(SCREEN_CAMERA_SIZE_Y * 0.05f, SCREEN_CAMERA_SIZE_Y * 0.05f));
 	TowerDefinition const* dartMonkeyDef = TowerDefinition::GetTowerDefinitionByName("Dart Monkey");
 	m_shopButtons.emplace_back(Button(g_theRenderer, g_theInput, dartMonkeyButtonBounds, Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y), dartMonkeyDef->m_texture));
+	m_shopButtonDefs.push_back(dartMonkeyDef);
 	EventArgs args;
 	args.SetValue("Name", "Dart Monkey");
 	m_shopButtons[0].AddEvent("BuyTower", args);
@@ -1163,6 +2625,7 @@ void Game::AddButtonsForShop()
 	AABB2 tackShooterButtonBounds = AABB2(tackShooterButtonMins, tackShooterButtonMins + Vec2(SCREEN_CAMERA_SIZE_Y * 0.05f, SCREEN_CAMERA_SIZE_Y * 0.05f));
 	TowerDefinition const* tackShooterDef = TowerDefinition::GetTowerDefinitionByName("Tack Shooter");
 	m_shopButtons.emplace_back(Button(g_theRenderer, g_theInput, tackShooterButtonBounds, Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y), tackShooterDef->m_texture));
+	m_shopButtonDefs.push_back(tackShooterDef);
 	args.SetValue("Name", "Tack Shooter");
 	m_shopButtons[1].AddEvent("BuyTower", args);
 
@@ -1171,6 +2634,7 @@ void Game::AddButtonsForShop()
 	AABB2 boomerangMonkeyButtonBounds = AABB2(boomerangMonkeyButtonMins, boomerangMonkeyButtonMins + Vec2(SCREEN_CAMERA_SIZE_Y * 0.05f, SCREEN_CAMERA_SIZE_Y * 0.05f));
 	TowerDefinition const* boomerangMonkeyDef = TowerDefinition::GetTowerDefinitionByName("Boomerang Monkey");
 	m_shopButtons.emplace_back(Button(g_theRenderer, g_theInput, boomerangMonkeyButtonBounds, Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y), boomerangMonkeyDef->m_texture));
+	m_shopButtonDefs.push_back(boomerangMonkeyDef);
 	args.SetValue("Name", "Boomerang Monkey");
 	m_shopButtons[2].AddEvent("BuyTower", args);
 
@@ -1179,6 +2643,7 @@ void Game::AddButtonsForShop()
 	AABB2 cannonButtonBounds = AABB2(cannonButtonMins, cannonButtonMins + Vec2(SCREEN_CAMERA_SIZE_Y * 0.05f, SCREEN_CAMERA_SIZE_Y * 0.05f));
 	TowerDefinition const* cannonDef = TowerDefinition::GetTowerDefinitionByName("Cannon");
 	m_shopButtons.emplace_back(Button(g_theRenderer, g_theInput, cannonButtonBounds, Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y), cannonDef->m_texture));
+	m_shopButtonDefs.push_back(cannonDef);
 	args.SetValue("Name", "Cannon");
 	m_shopButtons[3].AddEvent("BuyTower", args);
 
@@ -1187,6 +2652,7 @@ void Game::AddButtonsForShop()
 	AABB2 iceBallButtonBounds = AABB2(iceBallButtonMins, iceBallButtonMins + Vec2(SCREEN_CAMERA_SIZE_Y * 0.05f, SCREEN_CAMERA_SIZE_Y * 0.05f));
 	TowerDefinition const* iceBallDef = TowerDefinition::GetTowerDefinitionByName("Ice Ball");
 	m_shopButtons.emplace_back(Button(g_theRenderer, g_theInput, iceBallButtonBounds, Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y), iceBallDef->m_texture));
+	m_shopButtonDefs.push_back(iceBallDef);
 	args.SetValue("Name", "Ice Ball");
 	m_shopButtons[4].AddEvent("BuyTower", args);
 
@@ -1195,6 +2661,7 @@ void Game::AddButtonsForShop()
 	AABB2 superMonkeyButtonBounds = AABB2(superMonkeyButtonMins, superMonkeyButtonMins + Vec2(SCREEN_CAMERA_SIZE_Y * 0.05f, SCREEN_CAMERA_SIZE_Y * 0.05f));
 	TowerDefinition const* superMonkeyDef = TowerDefinition::GetTowerDefinitionByName("Super Monkey");
 	m_shopButtons.emplace_back(Button(g_theRenderer, g_theInput, superMonkeyButtonBounds, Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y), superMonkeyDef->m_texture));
+	m_shopButtonDefs.push_back(superMonkeyDef);
 	args.SetValue("Name", "Super Monkey");
 	m_shopButtons[5].AddEvent("BuyTower", args);
 
@@ -1219,7 +2686,10 @@ void Game::EnterGameplay()
 	//m_isAttractMode = false;
 	m_isMapSelection = true;
 
-	m_gameMusicPlayback = g_theAudio->StartSound(m_gameMusic, true, 0.6f);
+	{
+		ScopedMemoryTag memoryTag(MemoryTag::AUDIO);
+		m_gameMusicPlayback = g_theAudio->StartSound(m_gameMusic, true, 0.6f);
+	}
 
 	OpenMap(0);
 }
@@ -1230,6 +2700,8 @@ void Game::EnterGameplay()
 //
 void Game::LoadDefinitions()
 {
+	ScopedMemoryTag memoryTag(MemoryTag::DEFINITIONS);
+
 	if (BloonDefinition::s_bloonDefinitions.size() == 0)
 	{
 		BloonDefinition::InitializeBloonDefinitions();
@@ -1255,24 +2727,12 @@ void Game::LoadDefinitions()
 
 void Game::WriteCurrentMapToDisk(std::string const& mapName)
 {
-	//use buffer writer to write map data out
-	std::vector<uint8_t> splineBuffer;
-	BufferWriter bw = BufferWriter(splineBuffer);
-	std::vector<CubicBezierCurve2D>& spline = m_currentMap->m_trackSpline;
-
-	for (int curveIndex = 0; curveIndex < spline.size(); curveIndex++)
-	{
-		CubicBezierCurve2D& curve = spline[curveIndex];
-		/*std::string splineDesc = Stringf("A: %6.1f, %6.1f  -  B: %6.1f, %6.1f  -  C: %6.1f, %6.1f  -  D: %6.1f. %6.1f\n", curve.A.x, curve.A.y, curve.B.x, curve.B.y, curve.C.x, curve.C.y,
-			curve.D.x, curve.D.y);*/
-		std::string splineDesc = Stringf("<Curve a=\"%.1f, %.1f\" b=\"%.1f, %.1f\" c=\"%.1f, %.1f\" d=\"%.1f, %.1f\"/>\n", curve.A.x, curve.A.y, curve.B.x, curve.B.y, curve.C.x, curve.C.y, 
-			curve.D.x, curve.D.y);
-		for (int charIndex = 0; charIndex < splineDesc.length(); charIndex++)
-		{
-			bw.AppendChar(splineDesc[charIndex]);
-		}
-	}
-
-	std::string filePath = Stringf("Data/Exported/%s.txt", mapName.c_str());
-	FileWriteFromBuffer(splineBuffer, filePath);
+	//the live map's tables are already current, so exporting is just the two bulk writes
+	TrackData track;
+	track.m_curves = m_currentMap->m_trackSpline;
+	track.m_arcLengths = m_currentMap->m_trackArcLengths;
+	track.m_curveStartDistances = m_currentMap->m_trackCurveStartDistances;
+
+	track.WriteXmlToFile(Stringf("Data/Exported/%s.txt", mapName.c_str()));
+	track.WriteToFile(Stringf("Data/Exported/%s.track", mapName.c_str()));
 }
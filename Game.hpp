@@ -1,5 +1,9 @@
 #pragma once
 #include "Game/GameCommon.hpp"
+#include "Game/Replay.hpp"
+#include "Game/SimulationConfig.hpp"
+#include "Game/RenderSnapshot.hpp"
+#include "Game/RoundDefinition.hpp"
 #include "Engine/Renderer/Camera.hpp"
 #include "Engine/Audio/AudioSystem.hpp"
 #include "Engine/Core/Clock.hpp"
@@ -11,9 +15,24 @@
 class Map;
 class Tower;
 class TowerDefinition;
-class RoundDefinition;
 class ProjectileDefinition;
 class BitmapFont;
+class WorkerPool;
+class RoundTelemetry;
+struct MemoryTagStats;
+
+
+//everything the sidebar's look depends on; its cached geometry is only rebuilt when this changes
+struct UISidebarState
+{
+	Tower const*		   m_selectedTower = nullptr;
+	TowerDefinition const* m_selectedTowerDef = nullptr;
+	int  m_targetingMode = 0;
+	int  m_numMoney = 0;
+	int  m_hoveredShopButtonIndex = -1;
+
+	bool operator==(UISidebarState const& other) const;
+};
 
 
 class Game 
@@ -22,10 +41,20 @@ class Game
 public:
 	//game flow functions
 	void Startup();
+	void StartupHeadless();
 	void Update();
+	void UpdateSimulation(float deltaSeconds);
+	void BeginSimulationStep();
+	void EndSimulationStep();
 	void Render() const;
 	void Shutdown();
 
+	//headless tool functions
+	static std::vector<Game*> CreateHeadlessGames(int numGames);
+	static void DestroyHeadlessGames(std::vector<Game*>& games);
+	static void LoadDefinitions();
+	void WriteFreshMapSnapshot(int mapIndex, std::vector<uint8_t>& out_snapshot);
+
 	//gameplay functions
 	void OpenMap(unsigned int mapIndex);
 	void DeductLives(int livesLost);
@@ -35,9 +64,26 @@ public:
 	void BuyTower(TowerDefinition const* def);
 	//void BuyProjectile(ProjectileDefinition const* def);
 	bool PlaceHeldTower();
+	void PlaySound(SoundID sound, float volume = 1.0f) const;
+
+	//player command functions
+	bool IssueCommand(GameCommand const& command);
+	bool ExecuteCommand(GameCommand const& command);
+	int  GetTowerIndex(Tower const* tower) const;
+
+	//snapshot functions
+	void WriteSnapshot(std::vector<uint8_t>& buffer) const;
+	bool ReadSnapshot(std::vector<uint8_t> const& buffer);
+
+	//determinism functions
+	uint64_t ComputeStateHash() const;
+	uint64_t GetTickStateHash() const;
+	bool FindFirstDivergence(Game const& other, std::string& out_description) const;
+	void WriteStateDump(std::string const& filePath) const;
 
 	//commands
 	static bool Event_WriteMap(EventArgs& args);
+	static bool Event_ExportTracks(EventArgs& args);
 	static bool Event_BuyTower(EventArgs& args);
 	static bool Event_SellTower(EventArgs& args);
 	static bool Event_BuyUpgrade1(EventArgs& args);
@@ -45,12 +91,31 @@ public:
 	static bool Event_StartRound(EventArgs& args);
 	static bool Event_ToggleTargetingMode(EventArgs& args);
 	static bool Event_SelectMap(EventArgs& args);
+	static bool Event_SaveGame(EventArgs& args);
+	static bool Event_LoadGame(EventArgs& args);
+	static bool Event_StartRecording(EventArgs& args);
+	static bool Event_StopRecording(EventArgs& args);
+	static bool Event_PlayReplay(EventArgs& args);
+	static bool Event_CheckDeterminism(EventArgs& args);
+	static bool Event_OptimizeLayout(EventArgs& args);
+	static bool Event_ThreadedSimulation(EventArgs& args);
+	static bool Event_BenchmarkProjectiles(EventArgs& args);
+	static bool Event_MemoryStats(EventArgs& args);
+	static bool Event_Freeplay(EventArgs& args);
+	static bool Event_SpawnBloons(EventArgs& args);
+	static bool Event_PlaceTowerGrid(EventArgs& args);
+	static bool Event_RunTicks(EventArgs& args);
+	static bool Event_Telemetry(EventArgs& args);
+	static bool Event_RunBatch(EventArgs& args);
+	static bool Event_EstimateCoverage(EventArgs& args);
+	static bool Event_StepEnvironments(EventArgs& args);
 
 //public member variables
 public:
 	bool m_isFinished = false;
 	//bool m_isAttractMode = true;
 	bool m_isMapSelection = false;
+	bool m_isHeadless = false;
 
 	float m_timeBeforeReset = 4.0f;
 	float m_resetTimer = 0.0f;
@@ -59,6 +124,7 @@ public:
 	BitmapFont* m_menuFont = nullptr;
 
 	Map* m_currentMap = nullptr;
+	Map* m_restoreMap = nullptr;	//snapshots are read into this and swapped in once valid, keeping its allocations for the next restore
 
 	Tower* m_selectedTower = nullptr;
 	Tower* m_heldTower = nullptr;
@@ -74,11 +140,32 @@ public:
 	std::vector<float> m_waveTimers;
 	std::vector<int> m_waveCounts;
 
+	//past the last authored round, rounds are generated and streamed a wave per lane instead of read from m_roundDef
+	bool		  m_isFreeplayEnabled = false;	//false wins the game after the last authored round
+	uint32_t	  m_freeplaySeed = 0x5EED0B10;
+	FreeplayRound m_freeplayRound;
+	int			  m_nextFreeplayWaveIndex = 0;
+	std::vector<int>  m_freeplayLaneWaveIndexes;	//-1 once a lane has nothing left to spawn
+	std::vector<Wave> m_freeplayLaneWaves;
+
 	SoundID m_gameMusic;
 	SoundPlaybackID m_gameMusicPlayback;
 	SoundID m_frozenHitSound;
 
 	bool m_showAllTowerRanges = false;
+	bool m_useBloonLOD = false;	//draw dense clumps of bloons as one sprite with a count
+	bool m_showMemoryOverlay = false;
+
+	std::vector<uint8_t> m_snapshotBuffer;
+
+	uint32_t m_simTick = 0;
+	Replay*  m_recordingReplay = nullptr;
+
+	SimulationConfig m_simConfig;
+
+	RoundTelemetry* m_roundTelemetry = nullptr;	//counts what each tower did each round while set
+
+	bool m_isSimulationThreaded = true;	//step the simulation on its own thread while the previous step's snapshot renders
 
 //private member functions
 private:
@@ -87,10 +174,37 @@ private:
 	//void RenderAttract() const;
 	void UpdateUISidebar(Vec2 orthoMousePos);
 	void RenderUISidebar() const;
-	void RenderTowerInfo(TowerDefinition const* def) const;
+	void RenderTowerInfo() const;
+	UISidebarState GetCurrentUISidebarState() const;
+	void RefreshUISidebar();
+	void RebuildUISidebar();
+	void RebuildUpgradeButton(Button& button, std::string const& upgradeDefName, std::string const& upgradeName, int upgradeCost);
 	void UpdateSplineEditor(Vec2 orthoMousePos);
 	void RenderSplineEditor() const;
+	void RefreshSplineEditorCache();
 	void AddVertsForBezierCurve(std::vector<Vertex_PCU>& verts, CubicBezierCurve2D const& curve) const;
+	void AddVertsForControlPointHighlights(std::vector<Vertex_PCU>& verts, CubicBezierCurve2D const& curve) const;
+	void AddVertsForMemoryOverlay(std::vector<Vertex_PCU>& verts, float textHeight) const;
+
+	//command sub-functions
+	void IssueSpawnBloonCommand(std::string const& bloonDefName);
+	bool IssueTowerCommand(GameCommandType type, Tower const* tower);
+	bool BuyUpgrade(int towerIndex, std::string const& upgradeDefName, int upgradeCost);
+	void AddErrorMessage(std::string const& message) const;
+	uint64_t CombineWithGameStateHash(uint64_t mapHash) const;
+
+	//round sub-functions
+	bool StartFreeplayRound();
+	bool StartNextFreeplayWave(int laneIndex);
+	void RefreshFreeplayLaneWaves();
+
+	//memory reporting for headless runs, which each happen inside one console command
+	static void BeginHeadlessMemoryReport(MemoryTagStats* out_startStats);
+	static void EndHeadlessMemoryReport(std::string const& runName, MemoryTagStats const* startStats);
+
+	//simulation thread functions
+	void FlushSimulationEvents();
+	RenderSnapshot const& GetFrontRenderSnapshot() const { return m_renderSnapshots[m_frontRenderSnapshotIndex]; }
 
 	//setup functions
 	void AddButtonsForShop();
@@ -98,7 +212,6 @@ private:
 	void EnterGameplay();
 
 	//data management functions
-	void LoadDefinitions();
 	void WriteCurrentMapToDisk(std::string const& mapName);
 
 //private member variables
@@ -110,9 +223,13 @@ private:
 	Vec2* m_selectedControlPoint = nullptr;
 	CubicBezierCurve2D* m_highlightedCurve = nullptr;
 	CubicBezierCurve2D* m_selectedCurve = nullptr;
+	std::vector<CubicBezierCurve2D>		 m_tessellatedCurves;	//control points each curve's cached verts were built from
+	std::vector<std::vector<Vertex_PCU>> m_curveEditorVerts;
+	std::vector<Vertex_PCU>				 m_splineEditorVerts;	//every curve's verts back to back
 
-	AABB2 m_UIBaseBounds = AABB2(SCREEN_CAMERA_CENTER_X + SCREEN_CAMERA_SIZE_X * 0.25f, 0.0f, SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y);
+	AABB2 m_UIBaseBounds = AABB2(PLAYFIELD_SIZE_X, 0.0f, SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y);
 	std::vector<Button> m_shopButtons;
+	std::vector<TowerDefinition const*> m_shopButtonDefs;	//parallel to m_shopButtons
 	AABB2 m_infoBounds = AABB2(m_UIBaseBounds.m_mins + Vec2(0.0f, SCREEN_CAMERA_SIZE_Y * 0.1f), m_UIBaseBounds.m_maxs - Vec2(0.0f, SCREEN_CAMERA_SIZE_Y * 0.3f));
 	Button m_sellButton;
 	AABB2 m_sellButtonBounds = AABB2(m_UIBaseBounds.m_mins.x + SCREEN_CAMERA_SIZE_X * 0.05f, SCREEN_CAMERA_SIZE_Y * 0.05f, SCREEN_CAMERA_SIZE_X - SCREEN_CAMERA_SIZE_X * 0.05f, SCREEN_CAMERA_SIZE_X * 0.08f);
@@ -130,4 +247,28 @@ private:
 	AABB2 m_map2ButtonBounds = AABB2(m_UIBaseBounds.m_mins.x + SCREEN_CAMERA_SIZE_Y * 0.14f, SCREEN_CAMERA_SIZE_Y * 0.4f, SCREEN_CAMERA_SIZE_X - SCREEN_CAMERA_SIZE_Y * 0.14f, SCREEN_CAMERA_SIZE_Y * 0.6f);
 	Button m_map3Button;
 	AABB2 m_map3ButtonBounds = AABB2(m_UIBaseBounds.m_mins.x + SCREEN_CAMERA_SIZE_Y * 0.14f, SCREEN_CAMERA_SIZE_Y * 0.15f, SCREEN_CAMERA_SIZE_X - SCREEN_CAMERA_SIZE_Y * 0.14f, SCREEN_CAMERA_SIZE_Y * 0.35f);
+
+	//simulation thread; while a step runs it owns the map and everything the simulation writes, and only the front snapshot may be read
+	struct PendingSound
+	{
+		SoundID m_sound;
+		float	m_volume = 1.0f;
+	};
+
+	WorkerPool*	   m_simulationWorker = nullptr;
+	RenderSnapshot m_renderSnapshots[2];
+	int			   m_frontRenderSnapshotIndex = 0;
+	mutable std::vector<PendingSound> m_pendingSounds;	//started on the main thread once the step finishes
+	std::string m_pendingEndScreenText;
+	Rgba8		m_pendingEndScreenColor;
+
+	//retained sidebar geometry
+	UISidebarState m_sidebarState;
+	bool m_isSidebarDirty = true;
+	bool m_canBuyUpgrade1 = false;
+	bool m_canBuyUpgrade2 = false;
+	std::vector<Vertex_PCU> m_sidebarBaseVerts;
+	std::vector<Vertex_PCU> m_selectMapTextVerts;
+	std::vector<Vertex_PCU> m_towerInfoBoxVerts;
+	std::vector<Vertex_PCU> m_towerInfoTextVerts;
 };
@@ -1,4 +1,5 @@
 #include "Game/GameCommon.hpp"
+#include "Game/FrameArena.hpp"
 #include "Engine/Core/Rgba8.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Math/Vec2.hpp"
@@ -9,6 +10,7 @@
 
 //global variables
 RandomNumberGenerator g_rng;
+FrameArena g_frameArena;
 
 
 //
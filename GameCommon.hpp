@@ -12,6 +12,7 @@ class AudioSystem;
 class Window;
 class RandomNumberGenerator;
 class Game;
+class FrameArena;
 
 //external declarations
 extern App* g_theApp;
@@ -22,12 +23,14 @@ extern Window* g_theWindow;
 extern Game* g_theGame;
 
 extern RandomNumberGenerator g_rng;
+extern FrameArena g_frameArena;
 
 //gameplay constants
 constexpr float SCREEN_CAMERA_SIZE_X = 1600.f;
 constexpr float SCREEN_CAMERA_SIZE_Y = 900.f;
 constexpr float SCREEN_CAMERA_CENTER_X = SCREEN_CAMERA_SIZE_X / 2.f;
 constexpr float SCREEN_CAMERA_CENTER_Y = SCREEN_CAMERA_SIZE_Y / 2.f;
+constexpr float PLAYFIELD_SIZE_X = SCREEN_CAMERA_CENTER_X + SCREEN_CAMERA_SIZE_X * 0.25f;	//everything right of this is the UI sidebar
 
 constexpr int   NUM_CURVE_SUBDIVISIONS = 64;
 constexpr float CHILD_SPACING = 20.0f;
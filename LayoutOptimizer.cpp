@@ -0,0 +1,300 @@
+#include "Game/LayoutOptimizer.hpp"
+#include "Game/WorkerPool.hpp"
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+#include "Game/Tower.hpp"
+#include "Game/TowerDefinition.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Game/CoverageEstimator.hpp"
+#include "Game/RoundOutcomeCache.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <random>
+
+
+constexpr float OPTIMIZER_DELTA_SECONDS = 1.0f / 60.0f;
+constexpr int	MAX_TICKS_PER_ROUND = 60 * 60 * 10;
+constexpr int	MAX_LAYOUT_ACTIONS = 64;
+constexpr float PLACE_TOWER_CHANCE = 0.7f;
+
+
+//
+//local helper functions
+//
+static std::vector<TowerDefinition const*> GetBuyableTowerDefinitions()
+{
+	//towers that are nobody's upgrade are the ones sold in the shop
+	std::vector<TowerDefinition const*> buyableDefs;
+	for (int defIndex = 0; defIndex < TowerDefinition::s_towerDefinitions.size(); defIndex++)
+	{
+		TowerDefinition const& def = TowerDefinition::s_towerDefinitions[defIndex];
+
+		bool isUpgrade = false;
+		for (int otherIndex = 0; otherIndex < TowerDefinition::s_towerDefinitions.size(); otherIndex++)
+		{
+			TowerDefinition const& other = TowerDefinition::s_towerDefinitions[otherIndex];
+			if (other.m_upgrade1 == def.m_name || other.m_upgrade2 == def.m_name)
+			{
+				isUpgrade = true;
+				break;
+			}
+		}
+
+		if (!isUpgrade && def.m_cost > 0)
+		{
+			buyableDefs.emplace_back(&def);
+		}
+	}
+
+	return buyableDefs;
+}
+
+
+static void GenerateLayout(Game& game, std::vector<TowerDefinition const*> const& buyableDefs, std::mt19937& rng, TowerLayout& layout)
+{
+	std::uniform_real_distribution<float> chanceDist(0.0f, 1.0f);
+	std::uniform_real_distribution<float> xDist(0.0f, PLAYFIELD_SIZE_X);
+	std::uniform_real_distribution<float> yDist(0.0f, SCREEN_CAMERA_SIZE_Y);
+	std::uniform_int_distribution<int> defDist(0, static_cast<int>(buyableDefs.size()) - 1);
+
+	int startingMoney = game.m_numMoney;
+	Map const* map = game.m_currentMap;
+
+	//spend the budget one random action at a time; actions the player couldn't take are just skipped
+	for (int actionIndex = 0; actionIndex < MAX_LAYOUT_ACTIONS; actionIndex++)
+	{
+		GameCommand command;
+
+		int numTowers = static_cast<int>(map->m_towers.size());
+		if (numTowers == 0 || chanceDist(rng) < PLACE_TOWER_CHANCE)
+		{
+			TowerDefinition const* def = buyableDefs[defDist(rng)];
+			Vec2 position = Vec2(xDist(rng), yDist(rng));
+			if (def->m_cost > game.m_numMoney || !map->IsValidTowerPlacement(def, position))
+			{
+				continue;
+			}
+
+			command.m_type = GameCommandType::PLACE_TOWER;
+			command.m_index = static_cast<int>(def - TowerDefinition::s_towerDefinitions.data());
+			command.m_position = position;
+		}
+		else
+		{
+			int towerIndex = std::uniform_int_distribution<int>(0, numTowers - 1)(rng);
+			TowerDefinition const* def = map->m_towers[towerIndex]->m_definition;
+			bool useUpgrade1 = chanceDist(rng) < 0.5f;
+			std::string const& upgradeName = useUpgrade1 ? def->m_upgrade1 : def->m_upgrade2;
+			int upgradeCost = useUpgrade1 ? def->m_upgrade1Cost : def->m_upgrade2Cost;
+			if (upgradeCost > game.m_numMoney || TowerDefinition::GetTowerDefinitionByName(upgradeName) == nullptr)
+			{
+				continue;
+			}
+
+			command.m_type = useUpgrade1 ? GameCommandType::BUY_UPGRADE_1 : GameCommandType::BUY_UPGRADE_2;
+			command.m_index = towerIndex;
+		}
+
+		if (game.ExecuteCommand(command))
+		{
+			layout.m_commands.emplace_back(command);
+		}
+	}
+
+	//random targeting mode for every tower that tracks
+	for (int towerIndex = 0; towerIndex < map->m_towers.size(); towerIndex++)
+	{
+		Tower const* tower = map->m_towers[towerIndex];
+		if (!tower->m_definition->m_isTracking) continue;
+
+		int numToggles = std::uniform_int_distribution<int>(0, static_cast<int>(TargetingMode::NUM_TARGETING_MODES) - 1)(rng);
+		for (int toggleIndex = 0; toggleIndex < numToggles; toggleIndex++)
+		{
+			GameCommand command;
+			command.m_type = GameCommandType::TOGGLE_TARGETING_MODE;
+			command.m_index = towerIndex;
+			if (game.ExecuteCommand(command))
+			{
+				layout.m_commands.emplace_back(command);
+			}
+		}
+
+		layout.m_description += Stringf("%s (%.0f, %.0f) %s; ", tower->m_definition->m_name.c_str(), tower->m_position.x, tower->m_position.y, tower->GetTargetingModeAsString().c_str());
+	}
+	for (int towerIndex = 0; towerIndex < map->m_towers.size(); towerIndex++)
+	{
+		Tower const* tower = map->m_towers[towerIndex];
+		if (tower->m_definition->m_isTracking) continue;
+
+		layout.m_description += Stringf("%s (%.0f, %.0f); ", tower->m_definition->m_name.c_str(), tower->m_position.x, tower->m_position.y);
+	}
+
+	layout.m_cost = startingMoney - game.m_numMoney;
+}
+
+
+//plays rounds until the game is lost, won or out of rounds, returns the number of rounds simulated
+static int PlayRounds(Game& game, int maxRounds, TowerLayout& layout, RoundOutcomeCache* roundCache, int& out_numCachedRounds)
+{
+	int numRoundsPlayed = 0;
+	std::vector<uint8_t> roundStartSnapshot;
+	std::vector<uint8_t> roundEndSnapshot;
+
+	for (int roundIndex = 0; roundIndex < maxRounds; roundIndex++)
+	{
+		//a layout entering a round in a state some earlier candidate or run already played restores where that round ended
+		uint64_t roundStartKey = 0;
+		if (roundCache != nullptr)
+		{
+			game.WriteSnapshot(roundStartSnapshot);
+			roundStartKey = roundCache->ComputeRoundStartKey(game, roundStartSnapshot, OPTIMIZER_DELTA_SECONDS);
+		}
+		if (roundStartKey != 0 && roundCache->Find(roundStartKey, roundEndSnapshot) && game.ReadSnapshot(roundEndSnapshot))
+		{
+			out_numCachedRounds++;
+		}
+		else
+		{
+			//simulate from the restored key state too, so a round's result only depends on what the key covers and a run
+			//plays out the same whatever the cache already holds
+			if (roundStartKey != 0 && !game.ReadSnapshot(roundStartSnapshot))
+			{
+				roundStartKey = 0;
+			}
+
+			GameCommand startCommand;
+			startCommand.m_type = GameCommandType::START_ROUND;
+			if (!game.ExecuteCommand(startCommand))
+			{
+				break;
+			}
+
+			for (int tickIndex = 0; tickIndex < MAX_TICKS_PER_ROUND && game.m_isRoundActive; tickIndex++)
+			{
+				game.UpdateSimulation(OPTIMIZER_DELTA_SECONDS);
+			}
+			numRoundsPlayed++;
+
+			if (roundStartKey != 0 && !game.m_isRoundActive)
+			{
+				game.WriteSnapshot(roundEndSnapshot);
+				roundCache->Store(roundStartKey, roundEndSnapshot);
+			}
+		}
+
+		//a round that never ends counts as a loss so stuck layouts can't win
+		if (game.m_numLives <= 0 || game.m_isRoundActive)
+		{
+			break;
+		}
+		layout.m_survivalRound = game.m_roundNumber - 1;
+
+		//the game over timer also starts when the last round is won
+		if (game.m_resetTimer > 0.0f)
+		{
+			layout.m_survivalRound = game.m_roundNumber;
+			break;
+		}
+	}
+
+	layout.m_livesLeft = game.m_numLives;
+	return numRoundsPlayed;
+}
+
+
+static bool IsBetterLayout(TowerLayout const& a, TowerLayout const& b)
+{
+	if (a.m_survivalRound != b.m_survivalRound) return a.m_survivalRound > b.m_survivalRound;
+	if (a.m_livesLeft != b.m_livesLeft) return a.m_livesLeft > b.m_livesLeft;
+	return a.m_cost < b.m_cost;
+}
+
+
+//
+//public functions
+//
+LayoutOptimizerResult RunLayoutOptimizer(LayoutOptimizerSettings const& settings)
+{
+	LayoutOptimizerResult result;
+
+	WorkerPool workerPool = WorkerPool(settings.m_numWorkers);
+	result.m_numWorkers = workerPool.GetNumWorkers();
+
+	std::vector<Game*> workerGames = Game::CreateHeadlessGames(result.m_numWorkers);
+
+	//every candidate starts by restoring the same fresh map snapshot
+	std::vector<uint8_t> baseSnapshot;
+	workerGames[0]->m_numMoney = settings.m_budget;
+	workerGames[0]->WriteFreshMapSnapshot(settings.m_mapIndex, baseSnapshot);
+
+	std::vector<TowerDefinition const*> buyableDefs = GetBuyableTowerDefinitions();
+	std::vector<TowerLayout> candidates;
+	candidates.resize(settings.m_numCandidates);
+	std::vector<int> numRoundsPerCandidate;
+	numRoundsPerCandidate.resize(settings.m_numCandidates);
+	std::vector<uint8_t> isCandidatePruned;
+	isCandidatePruned.resize(settings.m_numCandidates, 0);
+	std::vector<uint8_t> isCandidateFailed;
+	isCandidateFailed.resize(settings.m_numCandidates, 0);
+	std::vector<int> numCachedRoundsPerCandidate;
+	numCachedRoundsPerCandidate.resize(settings.m_numCandidates, 0);
+
+	RoundOutcomeCache roundCache;
+	RoundOutcomeCache* roundCachePtr = !settings.m_roundCachePath.empty() && roundCache.Open(settings.m_roundCachePath) ? &roundCache : nullptr;
+
+	double startTime = GetCurrentTimeSeconds();
+
+	for (int candidateIndex = 0; candidateIndex < settings.m_numCandidates && !buyableDefs.empty(); candidateIndex++)
+	{
+		workerPool.AddJob([&, candidateIndex](int workerIndex)
+		{
+			Game& game = *workerGames[workerIndex];
+			if (!game.ReadSnapshot(baseSnapshot))
+			{
+				isCandidateFailed[candidateIndex] = 1;
+				return;
+			}
+
+			std::mt19937 rng(settings.m_seed + static_cast<uint32_t>(candidateIndex));
+			TowerLayout& layout = candidates[candidateIndex];
+			GenerateLayout(game, buyableDefs, rng, layout);
+
+			//the estimate costs microseconds against seconds of simulation, so hopeless layouts are marked and never played
+			if (settings.m_pruneBelowEstimatedRound > 0)
+			{
+				CoverageEstimator estimator = CoverageEstimator(*game.m_currentMap);
+				int estimatedRound = estimator.EstimateSurvivalRound(game.m_numLives, game.m_roundNumber, game.m_roundNumber + settings.m_maxRounds - 1, game.m_freeplaySeed);
+				if (estimatedRound < settings.m_pruneBelowEstimatedRound)
+				{
+					layout.m_survivalRound = estimatedRound;
+					isCandidatePruned[candidateIndex] = 1;
+					return;
+				}
+			}
+
+			numRoundsPerCandidate[candidateIndex] = PlayRounds(game, settings.m_maxRounds, layout, roundCachePtr, numCachedRoundsPerCandidate[candidateIndex]);
+			layout.m_wasSimulated = true;
+		});
+	}
+	workerPool.WaitForAllJobs();
+
+	result.m_secondsElapsed = GetCurrentTimeSeconds() - startTime;
+	result.m_numCandidatesRun = buyableDefs.empty() ? 0 : settings.m_numCandidates;
+	for (int candidateIndex = 0; candidateIndex < numRoundsPerCandidate.size(); candidateIndex++)
+	{
+		result.m_numRoundsSimulated += numRoundsPerCandidate[candidateIndex];
+		result.m_numCandidatesPruned += isCandidatePruned[candidateIndex];
+		result.m_numCandidatesFailed += isCandidateFailed[candidateIndex];
+		result.m_numRoundsFromCache += numCachedRoundsPerCandidate[candidateIndex];
+	}
+
+	//an estimated survival round isn't comparable with a simulated one, and a failed restore has none, so only simulated layouts are ranked
+	candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](TowerLayout const& layout) { return !layout.m_wasSimulated; }), candidates.end());
+	std::sort(candidates.begin(), candidates.end(), IsBetterLayout);
+	int numResults = settings.m_numResults < static_cast<int>(candidates.size()) ? settings.m_numResults : static_cast<int>(candidates.size());
+	result.m_bestLayouts.assign(candidates.begin(), candidates.begin() + numResults);
+
+	Game::DestroyHeadlessGames(workerGames);
+
+	return result;
+}
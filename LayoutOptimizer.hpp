@@ -0,0 +1,47 @@
+#pragma once
+#include "Game/Replay.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+
+struct LayoutOptimizerSettings
+{
+	int		 m_mapIndex = 0;
+	int		 m_budget = 650;			//starting money spent on the layout before round 1
+	int		 m_numCandidates = 1000;
+	int		 m_maxRounds = 50;
+	int		 m_numResults = 5;
+	int		 m_numWorkers = 0;			//0 means one per hardware thread
+	uint32_t m_seed = 0;
+	int		 m_pruneBelowEstimatedRound = 0;	//skip simulating layouts the coverage estimate says die before this round, 0 simulates all.
+												//Off by default: the estimate's error against the simulator is unmeasured on most maps, so
+												//check it with EstimateCoverage Validate=true before trusting a threshold
+	std::string m_roundCachePath;				//memory-mapped round outcome cache shared between runs, empty simulates every round
+};
+
+
+struct TowerLayout
+{
+	std::vector<GameCommand> m_commands;	//place, upgrade and targeting commands, executed before round 1
+	std::string m_description;
+	int m_cost = 0;
+	int m_survivalRound = 0;				//last round finished with lives left, or the estimate's for a pruned layout
+	int m_livesLeft = 0;
+	bool m_wasSimulated = false;			//false for pruned layouts and ones whose restore failed, which are left out of the results
+};
+
+
+struct LayoutOptimizerResult
+{
+	std::vector<TowerLayout> m_bestLayouts;
+	int	   m_numCandidatesRun = 0;
+	int	   m_numCandidatesPruned = 0;
+	int	   m_numCandidatesFailed = 0;		//couldn't restore the base snapshot
+	int	   m_numRoundsSimulated = 0;
+	int	   m_numRoundsFromCache = 0;
+	int	   m_numWorkers = 0;
+	double m_secondsElapsed = 0.0;
+};
+
+
+//Monte Carlo search over random tower layouts, each scored by playing rounds in a headless game on a worker thread
+LayoutOptimizerResult RunLayoutOptimizer(LayoutOptimizerSettings const& settings);
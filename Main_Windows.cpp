@@ -1,13 +1,33 @@
 #include "Game/App.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/BatchRunner.hpp"
 #define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
 #include <windows.h>			// #include this (massive, platform-specific) header in very few places
+#include <cstdio>
 
 
 //-----------------------------------------------------------------------------------------------
 int WINAPI WinMain( HINSTANCE , HINSTANCE, LPSTR commandLineString, int )
 {
-	UNUSED( commandLineString );
+	//-batch=<file> plays a batch of scenarios headless and exits without opening a window
+	std::string commandLine = commandLineString;
+	if (commandLine.rfind("-batch=", 0) == 0)
+	{
+		std::string summary;
+		bool succeeded = RunBatchFile(commandLine.substr(7), 0, summary);
+
+		//this is a windowed exe with no console of its own, so print to the one it was launched from, if any;
+		//the summary is also in <name>_Summary.txt either way
+		if (AttachConsole(ATTACH_PARENT_PROCESS))
+		{
+			FILE* consoleOutput = nullptr;
+			freopen_s(&consoleOutput, "CONOUT$", "w", stdout);
+		}
+		fprintf(stdout, "%s\n", summary.c_str());
+		fflush(stdout);
+		OutputDebugStringA((summary + "\n").c_str());
+		return succeeded ? 0 : 1;
+	}
 
 	g_theApp = new App();
 	g_theApp->Startup();
@@ -3,12 +3,18 @@
 #include "Game/Tower.hpp"
 #include "Game/BloonDefinition.hpp"
 #include "Game/Game.hpp"
-#include "Game/Projectile.hpp"
+#include "Game/RoundTelemetry.hpp"
 #include "Game/ProjectileDefinition.hpp"
 #include "Game/TowerDefinition.hpp"
+#include "Game/Snapshot.hpp"
+#include "Game/StateHash.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Core/VertexUtils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
 
 
 //
@@ -24,10 +30,6 @@ Map::~Map()
 	{
 		delete m_towers[towerIndex];
 	}
-	for (int projIndex = 0; projIndex < m_projectiles.size(); projIndex++)
-	{
-		delete m_projectiles[projIndex];
-	}
 }
 
 
@@ -36,6 +38,13 @@ Map::~Map()
 //
 void Map::Update(float deltaSeconds)
 {
+	m_simulationSeconds += deltaSeconds;
+	if (m_game->m_roundTelemetry != nullptr)
+	{
+		m_game->m_roundTelemetry->EnsureTowerSlots(static_cast<int>(m_towers.size()));
+	}
+	double phaseStartSeconds = m_phaseTimings != nullptr ? GetCurrentTimeSeconds() : 0.0;
+
 	//update all map-owned entities
 	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
 	{
@@ -46,30 +55,20 @@ void Map::Update(float deltaSeconds)
 			bloon->Update(deltaSeconds);
 		}
 	}
-	if (g_theGame->m_resetTimer == 0.0f)	//towers only update if game isn't over
-	{
-		for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
-		{
-			Tower*& tower = m_towers[towerIndex];
-
-			if (tower != nullptr)
-			{
-				tower->Update(deltaSeconds);
-			}
-		}
-	}
-	for (int projIndex = 0; projIndex < m_projectiles.size(); projIndex++)
+	ProcessDueLeakChecks();
+	UpdateBloonSwarms(deltaSeconds);
+	if (m_phaseTimings != nullptr) phaseStartSeconds = RecordPhaseTime(m_phaseTimings->m_bloonSeconds, phaseStartSeconds);
+	if (m_game->m_resetTimer == 0.0f)	//towers only update if game isn't over
 	{
-		Projectile*& projectile = m_projectiles[projIndex];
-
-		if (projectile != nullptr)
-		{
-			projectile->Update(deltaSeconds);
-		}
+		UpdateTowers(deltaSeconds);
 	}
+	if (m_phaseTimings != nullptr) phaseStartSeconds = RecordPhaseTime(m_phaseTimings->m_towerSeconds, phaseStartSeconds);
+	m_projectiles.Update(*this, deltaSeconds);
+	if (m_phaseTimings != nullptr) phaseStartSeconds = RecordPhaseTime(m_phaseTimings->m_projectileSeconds, phaseStartSeconds);
 
 	//check each projectile against each bloon to check for collisions
 	CollideProjectilesAgainstBloons();
+	if (m_phaseTimings != nullptr) phaseStartSeconds = RecordPhaseTime(m_phaseTimings->m_collisionSeconds, phaseStartSeconds);
 
 	//spawn children and give money for all popped bloons
 	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
@@ -88,205 +87,196 @@ void Map::Update(float deltaSeconds)
 
 		if (bloon != nullptr && bloon->m_hasPopped)
 		{
-			g_theGame->m_numMoney++;
+			m_game->m_numMoney++;
 			delete bloon;
 			bloon = nullptr;
 		}
 	}
 	
-	//handle all leaked bloons
+	//the leak queue already counted the lives, so leaked bloons just go away while the survivors are hashed
+	if (m_numLivesLeaked > 0)
+	{
+		m_game->DeductLives(m_numLivesLeaked);
+		m_numLivesLeaked = 0;
+	}
+	uint64_t bloonHash = STATE_HASH_SEED;
 	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
 	{
 		Bloon*& bloon = m_bloons[bloonIndex];
 
 		if (bloon != nullptr && bloon->m_hasLeaked)
 		{
-			g_theGame->DeductLives(bloon->m_definition->m_RBE);
-
 			delete bloon;
 			bloon = nullptr;
 		}
+		else if (bloon != nullptr)
+		{
+			bloonHash = CombineEntityHash(bloonHash, bloonIndex, bloon->GetStateHash());
+		}
 	}
-
-	//handle all dead projectiles
-	for (int projIndex = 0; projIndex < m_projectiles.size(); projIndex++)
+	if (!m_bloonSwarms.empty())
 	{
-		Projectile*& projectile = m_projectiles[projIndex];
+		bloonHash = HashCombine(bloonHash, ComputeSwarmHash());
+	}
 
-		if (projectile != nullptr && projectile->m_outOfPierce)
+	//handle all dead projectiles; spawning can grow the pool, so copy what's needed out of it first
+	for (int projIndex = 0; projIndex < m_projectiles.GetNumSlots(); projIndex++)
+	{
+		if (m_projectiles.IsAlive(projIndex) && m_projectiles.IsOutOfPierce(projIndex))
 		{
-			ProjectileDefinition const* def = projectile->m_definition;
+			ProjectileDefinition const* def = m_projectiles.GetDefinition(projIndex);
+			Vec2 position = m_projectiles.m_positions[projIndex];
+			Vec2 direction = m_projectiles.m_velocities[projIndex].GetNormalized();
+			int ownerTowerSlot = m_projectiles.m_coldData[projIndex].m_ownerTowerSlot;
 			for (int projISpawnIndex = 0; projISpawnIndex < def->m_projectilesToSpawn.size(); projISpawnIndex++)
 			{
 				ProjectileDefinition const* spawnDef = ProjectileDefinition::GetProjectileDefinitionByName(def->m_projectilesToSpawn[projISpawnIndex]);
-				SpawnProjectile(spawnDef, projectile->m_position, projectile->m_velocity.GetNormalized());
+				SpawnProjectile(spawnDef, position, direction, 0, 0.0f, 0.0f, 0.0f, -1, ownerTowerSlot);
 			}
 		}
 	}
-	for (int projIndex = 0; projIndex < m_projectiles.size(); projIndex++)
+	uint64_t projHash = STATE_HASH_SEED;
+	for (int projIndex = 0; projIndex < m_projectiles.GetNumSlots(); projIndex++)
 	{
-		Projectile*& projectile = m_projectiles[projIndex];
+		if (!m_projectiles.IsAlive(projIndex)) continue;
 
-		if (projectile != nullptr && (projectile->m_outOfLifespan || projectile->m_outOfPierce))
+		if (m_projectiles.IsDead(projIndex))
+		{
+			m_projectiles.Free(*this, projIndex);
+		}
+		else
 		{
-			delete projectile;
-			projectile = nullptr;
+			projHash = CombineEntityHash(projHash, projIndex, m_projectiles.GetStateHash(projIndex));
 		}
 	}
+
+	m_tickStateHash = CombineMapHash(bloonHash, ComputeTowerHash(), projHash);
+	if (m_phaseTimings != nullptr) RecordPhaseTime(m_phaseTimings->m_cleanupSeconds, phaseStartSeconds);
 }
 
 
-void Map::Render() const
+int Map::AddBloon(Bloon* bloon)
 {
-	//render all map-owned entities
-
-	BloonDefinition const* redDef = BloonDefinition::GetBloonDefinitionByName("Red");
-	BloonDefinition const* leadDef = BloonDefinition::GetBloonDefinitionByName("Lead");
-	BloonDefinition const* rainbowDef = BloonDefinition::GetBloonDefinitionByName("Rainbow");
-
-	g_theRenderer->BindTexture(redDef->m_texture);
+	//find empty space within vector first
 	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
 	{
-		Bloon* const& bloon = m_bloons[bloonIndex];
-		
-		if (bloon != nullptr && bloon->m_definition != leadDef && bloon->m_definition != rainbowDef)
+		if (m_bloons[bloonIndex] == nullptr)
 		{
-			bloon->Render();
+			m_bloons[bloonIndex] = bloon;
+			bloon->m_slotIndex = bloonIndex;
+			WakeTowersForBloon(*bloon);
+			ScheduleLeakCheck(*bloon, GetBloonTrackLength());
+			return bloonIndex;
 		}
 	}
 
-	g_theRenderer->BindTexture(leadDef->m_texture);
-	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
-	{
-		Bloon* const& bloon = m_bloons[bloonIndex];
+	//otherwise, add a new one to the vector
+	m_bloons.emplace_back(bloon);
+	bloon->m_slotIndex = static_cast<int>(m_bloons.size()) - 1;
+	WakeTowersForBloon(*bloon);
+	ScheduleLeakCheck(*bloon, GetBloonTrackLength());
+	return bloon->m_slotIndex;
+}
 
-		if (bloon != nullptr && bloon->m_definition == leadDef)
-		{
-			bloon->Render();
-		}
-	}
 
-	g_theRenderer->BindTexture(rainbowDef->m_texture);
-	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
-	{
-		Bloon* const& bloon = m_bloons[bloonIndex];
+void Map::SpawnBloonAtStart(BloonDefinition const* bloonDef)
+{
+	AddBloon(new Bloon(bloonDef, this, &m_trackSpline[0]));
+}
 
-		if (bloon != nullptr && bloon->m_definition == rainbowDef)
-		{
-			bloon->Render();
-		}
-	}
 
-	for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
-	{
-		Tower* const& tower = m_towers[towerIndex];
+void Map::SpawnBloonChildren(Bloon const* bloon)
+{
+	BloonDefinition const* def = bloon->m_definition;
 
-		if (tower != nullptr && (g_theGame->m_showAllTowerRanges || tower == g_theGame->m_selectedTower))
+	float spawnOffset = 0.0f;
+	for (int childIndex = 0; childIndex < def->m_children.size(); childIndex++)
+	{
+		BloonDefinition const* childDef = def->m_children[childIndex];
+		if (childDef != nullptr)
 		{
-			tower->RenderRange();
+			Bloon* child = new Bloon(childDef, this, bloon->m_currentSplineCurve, bloon->m_trackDistance - spawnOffset);
+			AddBloon(child);
+			m_projectiles.AddHitBloon(bloon->m_popperIndex, child);
+			
+			spawnOffset -= CHILD_SPACING;
 		}
 	}
+}
 
-	for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
-	{
-		Tower* const& tower = m_towers[towerIndex];
 
-		if (tower != nullptr)
-		{
-			tower->Render();
-		}
-	}
-	for (int projIndex = 0; projIndex < m_projectiles.size(); projIndex++)
-	{
-		Projectile* const& projectile = m_projectiles[projIndex];
+//the whole wave is queued behind the start at once; member i reaches the track i spacings after member 0
+void Map::SpawnBloonSwarmAtStart(BloonDefinition const* bloonDef, int numBloons, float spacing)
+{
+	if (numBloons <= 0 || numBloons > MAX_SWARM_MEMBERS || spacing <= 0.0f) return;
 
-		if (projectile != nullptr)
-		{
-			projectile->Render();
-		}
-	}
+	BloonSwarm swarm;
+	swarm.m_definition = bloonDef;
+	swarm.m_spacing = spacing;
+	swarm.m_numMembers = numBloons;
+	m_bloonSwarms.emplace_back(swarm);
+
+	WakeTowersForArrival(swarm.m_headDistance, bloonDef->m_speed);
 }
 
 
-void Map::SpawnBloonAtStart(BloonDefinition const* bloonDef)
+bool Map::HasBloonsLeft() const
 {
-	//find empty space within vector first
+	if (!m_bloonSwarms.empty()) return true;
+
 	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
 	{
-		if (m_bloons[bloonIndex] == nullptr)
+		if (m_bloons[bloonIndex] != nullptr)
 		{
-			m_bloons[bloonIndex] = new Bloon(bloonDef, this, &m_trackSpline[0]);
-			return;
+			return true;
 		}
 	}
 
-	//otherwise, add a new one to the vector
-	m_bloons.emplace_back(new Bloon(bloonDef, this, &m_trackSpline[0]));
+	return false;
 }
 
 
-void Map::SpawnBloonChildren(Bloon const* bloon)
+//removes every bloon and swarm, returns the RBE of those already on the track
+int Map::ClearBloons()
 {
-	BloonDefinition const* def = bloon->m_definition;
-
-	float spawnOffset = 0.0f;
-	for (int childIndex = 0; childIndex < def->m_children.size(); childIndex++)
+	int totalRBE = 0;
+	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
 	{
-		BloonDefinition const* childDef = def->m_children[childIndex];
-		if (childDef != nullptr)
+		if (m_bloons[bloonIndex] != nullptr)
 		{
-			bool addedToExistingSlot = false;
-
-			//find empty space within vector first
-			for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
-			{
-				if (m_bloons[bloonIndex] == nullptr)
-				{
-					m_bloons[bloonIndex] = new Bloon(childDef, this, bloon->m_currentSplineCurve, bloon->m_trackDistance - spawnOffset);
-					addedToExistingSlot = true;
-					bloon->m_popper->m_bloonsToPassOver.emplace_back(m_bloons[bloonIndex]);
-					break;
-				}
-			}
-
-			//otherwise, add a new one to the vector
-			if (!addedToExistingSlot)
-			{
-				m_bloons.emplace_back(new Bloon(childDef, this, bloon->m_currentSplineCurve, bloon->m_trackDistance - spawnOffset));
-				bloon->m_popper->m_bloonsToPassOver.emplace_back(m_bloons[m_bloons.size() - 1]);
-			}
-			
-			spawnOffset -= CHILD_SPACING;
+			totalRBE += m_bloons[bloonIndex]->m_definition->m_RBE;
+			delete m_bloons[bloonIndex];
+			m_bloons[bloonIndex] = nullptr;
 		}
 	}
-}
-
 
-void Map::SpawnProjectile(ProjectileDefinition const* projectileDef, Vec2 const& position, Vec2 const& direction, int addedPierce, float addedLifespan, float addedSize, float addedFreezeTime,
-	CubicBezierCurve2D curvedProjArc)
-{
-	//find empty space within vector first
-	for (int projIndex = 0; projIndex < m_projectiles.size(); projIndex++)
+	//swarm members still queued before the start hadn't spawned yet, same as a wave's remaining count
+	for (int swarmIndex = 0; swarmIndex < m_bloonSwarms.size(); swarmIndex++)
 	{
-		if (m_projectiles[projIndex] == nullptr)
+		BloonSwarm const& swarm = m_bloonSwarms[swarmIndex];
+		for (int memberIndex = swarm.m_firstMemberIndex; memberIndex < swarm.m_numMembers && swarm.GetMemberDistance(memberIndex) >= 0.0f; memberIndex++)
 		{
-			m_projectiles[projIndex] = new Projectile(projectileDef, this, position, direction, addedPierce, addedLifespan, addedSize, addedFreezeTime, curvedProjArc);
-			return;
+			totalRBE += swarm.m_definition->m_RBE;
 		}
 	}
+	m_bloonSwarms.clear();
 
-	//otherwise, add a new one to the vector
-	m_projectiles.emplace_back(new Projectile(projectileDef, this, position, direction, addedPierce, addedLifespan, addedSize, addedFreezeTime, curvedProjArc));
+	return totalRBE;
+}
+
+
+void Map::SpawnProjectile(ProjectileDefinition const* projectileDef, Vec2 const& position, Vec2 const& direction, int addedPierce, float addedLifespan, float addedSize, float addedFreezeTime,
+	int curvedArcIndex, int ownerTowerSlot)
+{
+	m_projectiles.Spawn(*this, projectileDef, position, direction, addedPierce, addedLifespan, addedSize, addedFreezeTime, curvedArcIndex, ownerTowerSlot);
 }
 
 
 void Map::CollideProjectilesAgainstBloons()
 {
-	for (int projIndex = 0; projIndex < m_projectiles.size(); projIndex++)
+	for (int projIndex = 0; projIndex < m_projectiles.GetNumSlots(); projIndex++)
 	{
-		Projectile*& projectile = m_projectiles[projIndex];
-
-		if (projectile != nullptr && !projectile->m_outOfLifespan && !projectile->m_outOfPierce)
+		if (m_projectiles.IsAlive(projIndex) && !m_projectiles.IsDead(projIndex))
 		{
 			for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
 			{
@@ -294,9 +284,9 @@ void Map::CollideProjectilesAgainstBloons()
 
 				if (bloon != nullptr && !bloon->m_hasLeaked && !bloon->m_hasPopped)
 				{
-					CollideProjectileAgainstBloon(*projectile, *bloon);
+					CollideProjectileAgainstBloon(projIndex, *bloon);
 					//early out of loop if pierce runs out
-					if (projectile->m_remainingPierce <= 0)
+					if (m_projectiles.m_remainingPierces[projIndex] <= 0)
 					{
 						break;
 					}
@@ -307,22 +297,17 @@ void Map::CollideProjectilesAgainstBloons()
 }
 
 
-bool Map::CollideProjectileAgainstBloon(Projectile& projectile, Bloon& bloon)
+bool Map::CollideProjectileAgainstBloon(int projIndex, Bloon& bloon)
 {
-	for (int bloonIndex = 0; bloonIndex < projectile.m_bloonsToPassOver.size(); bloonIndex++)
+	if (m_projectiles.HasHitBloon(projIndex, &bloon))
 	{
-		Bloon*& bloonToCheck = projectile.m_bloonsToPassOver[bloonIndex];
-
-		if (&bloon == bloonToCheck)
-		{
-			return false;
-		}
+		return false;
 	}
 
-	if (DoDiscsOverlap(projectile.m_position, projectile.m_size, bloon.m_position, bloon.m_definition->m_size))
+	if (DoDiscsOverlap(m_projectiles.m_positions[projIndex], m_projectiles.m_sizes[projIndex], bloon.m_position, bloon.m_definition->m_size))
 	{
-		projectile.DeductPierce();
-		bloon.TakeDamage(projectile);
+		m_projectiles.DeductPierce(projIndex);
+		bloon.TakeDamage(m_projectiles, projIndex);
 		return true;
 	}
 
@@ -335,10 +320,24 @@ void Map::SellTower(int towerIndex)
 	Tower*& tower = m_towers[towerIndex];
 	int cost = tower->m_definition->m_cost;
 
+	if (!tower->m_hasTrackCoverage)
+	{
+		RefreshTowerTrackCoverage(*tower);
+	}
+	if (tower->m_swarmZoneStart < m_soldTowerSwarmZoneStart)
+	{
+		m_soldTowerSwarmZoneStart = tower->m_swarmZoneStart;
+	}
+
+	if (m_game->m_roundTelemetry != nullptr)
+	{
+		m_game->m_roundTelemetry->RetireTower(*this, towerIndex);
+	}
+
 	delete tower;
 	tower = nullptr;
 
-	g_theGame->m_numMoney += cost * 8 / 10;
+	m_game->m_numMoney += cost * 8 / 10;
 }
 
 
@@ -348,13 +347,13 @@ Vec2 Map::GetNearestPointOnTrack(Vec2 const& referencePoint) const
 
 	for (int curveIndex = 0; curveIndex < m_trackSpline.size(); curveIndex++)
 	{
-		CubicBezierCurve2D const& curve = m_trackSpline[curveIndex];
+		//the table's points are the same subdivision points the curve would evaluate to
+		Vec2 const* curvePoints = m_trackArcLengths[curveIndex].m_points;
 
-		Vec2 curveSegmentStart = curve.EvaluateAtParametric(0.0f);
+		Vec2 curveSegmentStart = curvePoints[0];
 		for (int subdivIndex = 0; subdivIndex < NUM_CURVE_SUBDIVISIONS; subdivIndex++)
 		{
-			float curveSegmentEndT = static_cast<float>(subdivIndex + 1) * (1.0f / NUM_CURVE_SUBDIVISIONS);
-			Vec2 curveSegmentEnd = curve.EvaluateAtParametric(curveSegmentEndT);
+			Vec2 curveSegmentEnd = curvePoints[subdivIndex + 1];
 
 			Vec2 nearestPointOnSegment = GetNearestPointOnLineSegment(referencePoint, curveSegmentStart, curveSegmentEnd);
 
@@ -369,3 +368,1096 @@ Vec2 Map::GetNearestPointOnTrack(Vec2 const& referencePoint) const
 
 	return nearestPoint;
 }
+
+
+bool Map::IsValidTowerPlacement(TowerDefinition const* towerDef, Vec2 const& position) const
+{
+	//check if over any other towers
+	for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
+	{
+		Tower const* tower = m_towers[towerIndex];
+
+		if (tower == nullptr) continue;
+
+		if (DoDiscsOverlap(position, towerDef->m_size, tower->m_position, tower->m_definition->m_size))
+		{
+			return false;
+		}
+	}
+
+	//check if over the track
+	Vec2 nearestPointOnTrack = GetNearestPointOnTrack(position);
+	if (DoDiscsOverlap(nearestPointOnTrack, TRACK_WIDTH, position, towerDef->m_size))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+//
+//leak queue functions
+//
+//an unfrozen bloon's arrival at the end is known from its speed, so it's only looked at again shortly before then
+void Map::ScheduleLeakCheck(Bloon& bloon, float trackLength)
+{
+	float speed = bloon.m_definition->m_speed;
+	if (speed <= 0.0f)
+	{
+		bloon.m_leakCheckSeconds = DBL_MAX;
+		return;
+	}
+
+	double secondsUntilLeak = static_cast<double>(bloon.m_freezeTimer > 0.0f ? bloon.m_freezeTimer : 0.0f) + static_cast<double>((trackLength - bloon.m_trackDistance) / speed);
+	bloon.m_leakCheckSeconds = m_simulationSeconds + secondsUntilLeak - LEAK_CHECK_MARGIN_SECONDS;
+
+	LeakCheck leakCheck;
+	leakCheck.m_dueSeconds = bloon.m_leakCheckSeconds;
+	leakCheck.m_bloonSlot = bloon.m_slotIndex;
+	leakCheck.m_bloon = &bloon;
+	m_leakChecks.emplace_back(leakCheck);
+	std::push_heap(m_leakChecks.begin(), m_leakChecks.end(), std::greater<LeakCheck>());
+}
+
+
+//for when the track or the clock changes under every prediction at once
+void Map::RescheduleAllLeakChecks()
+{
+	m_leakChecks.clear();
+
+	float trackLength = GetBloonTrackLength();
+	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
+	{
+		if (m_bloons[bloonIndex] != nullptr)
+		{
+			ScheduleLeakCheck(*m_bloons[bloonIndex], trackLength);
+		}
+	}
+}
+
+
+//the length bloons move along, which differs slightly from the tables' when they evaluate the curves directly
+float Map::GetBloonTrackLength() const
+{
+	if (m_game->m_simConfig.m_useArcLengthTables)
+	{
+		return GetTrackLength();
+	}
+
+	return m_trackSplineLength;
+}
+
+
+//
+//tower sleep functions
+//
+//a new bloon may reach a sleeping tower sooner than anything it was scheduled around
+void Map::WakeTowersForBloon(Bloon const& bloon)
+{
+	WakeTowersForArrival(bloon.m_trackDistance, bloon.m_definition->m_speed);
+}
+
+
+void Map::WakeTowersForArrival(float trackDistance, float speed)
+{
+	if (!m_game->m_simConfig.m_useTowerSleep) return;
+
+	for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
+	{
+		Tower* tower = m_towers[towerIndex];
+		if (tower == nullptr || !tower->m_isAsleep) continue;
+
+		float secondsUntilCoverage = GetSecondsUntilTrackCoverage(*tower, trackDistance, speed);
+		double wakeSeconds = m_simulationSeconds + secondsUntilCoverage;
+		if (secondsUntilCoverage == FLT_MAX || wakeSeconds >= tower->m_wakeSeconds) continue;
+
+		tower->m_wakeSeconds = wakeSeconds;
+		if (secondsUntilCoverage <= 0.0f)
+		{
+			tower->m_isAsleep = false;
+		}
+		else
+		{
+			m_towerWakeWheel.Schedule(towerIndex, wakeSeconds);
+		}
+	}
+}
+
+
+void Map::WakeAllTowers()
+{
+	for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
+	{
+		if (m_towers[towerIndex] != nullptr)
+		{
+			m_towers[towerIndex]->Wake();
+		}
+	}
+}
+
+
+//bloons only ever move forward, so this assumes the bloon never stops; freezing can only make it later
+float Map::GetSecondsUntilTrackCoverage(Tower const& tower, Bloon const& bloon) const
+{
+	return GetSecondsUntilTrackCoverage(tower, bloon.m_trackDistance, bloon.m_definition->m_speed);
+}
+
+
+float Map::GetSecondsUntilTrackCoverage(Tower const& tower, float trackDistance, float speed) const
+{
+	//the first stretch not already behind the bloon is the next one it reaches
+	for (int intervalIndex = 0; intervalIndex < tower.m_numTrackCoverageIntervals; intervalIndex++)
+	{
+		TrackCoverageInterval const& interval = tower.m_trackCoverage[intervalIndex];
+		if (trackDistance > interval.m_end) continue;
+		if (trackDistance >= interval.m_start) return 0.0f;
+		if (speed <= 0.0f) return FLT_MAX;
+
+		return (interval.m_start - trackDistance) / speed;
+	}
+
+	return FLT_MAX;
+}
+
+
+//
+//track length functions
+//
+void Map::RebuildTrackLengths()
+{
+	m_trackArcLengths.clear();
+	OnTrackCurvesChanged(0, static_cast<int>(m_trackSpline.size()) - 1);
+}
+
+
+//rebuilds the tables of the given curves and the start distances of every curve after them, for when the spline editor moves control points
+void Map::OnTrackCurvesChanged(int firstCurveIndex, int lastCurveIndex)
+{
+	int numCurves = static_cast<int>(m_trackSpline.size());
+	int oldNumCurves = static_cast<int>(m_trackArcLengths.size());
+	m_trackArcLengths.resize(numCurves);
+	m_trackCurveStartDistances.resize(numCurves + 1);
+
+	//curves appended since the last notification need tables too
+	if (oldNumCurves < numCurves)
+	{
+		if (oldNumCurves < firstCurveIndex) firstCurveIndex = oldNumCurves;
+		if (lastCurveIndex < numCurves - 1) lastCurveIndex = numCurves - 1;
+	}
+	if (firstCurveIndex < 0) firstCurveIndex = 0;
+	if (firstCurveIndex > numCurves) firstCurveIndex = numCurves;
+	if (lastCurveIndex > numCurves - 1) lastCurveIndex = numCurves - 1;
+
+	for (int curveIndex = firstCurveIndex; curveIndex <= lastCurveIndex; curveIndex++)
+	{
+		m_trackArcLengths[curveIndex].Build(m_trackSpline[curveIndex]);
+	}
+
+	m_trackCurveStartDistances[0] = 0.0f;
+	for (int curveIndex = firstCurveIndex; curveIndex < numCurves; curveIndex++)
+	{
+		m_trackCurveStartDistances[curveIndex + 1] = m_trackCurveStartDistances[curveIndex] + m_trackArcLengths[curveIndex].GetTotalLength();
+	}
+
+	//every tower's coverage and every bloon's leak time was measured along the old track
+	WakeAllTowers();
+	m_trackSplineLength = ComputeSplineTrackLength(m_trackSpline);
+	RescheduleAllLeakChecks();
+	m_trackGeneration = TakeTrackGeneration();
+}
+
+
+Vec2 Map::GetTrackPositionAtDistance(float distance) const
+{
+	//first curve whose end is at or past the given distance
+	int numCurves = static_cast<int>(m_trackArcLengths.size());
+	float const* curveEnd = std::lower_bound(m_trackCurveStartDistances.data() + 1, m_trackCurveStartDistances.data() + numCurves + 1, distance);
+	int curveIndex = static_cast<int>(curveEnd - m_trackCurveStartDistances.data()) - 1;
+	if (curveIndex >= numCurves)
+	{
+		curveIndex = numCurves - 1;
+	}
+
+	return m_trackArcLengths[curveIndex].EvaluateAtDistance(distance - m_trackCurveStartDistances[curveIndex]);
+}
+
+
+//
+//curved projectile arc functions
+//
+int Map::AcquireCurvedArc(Vec2 const& origin, Vec2 const& iBasis)
+{
+	//find an unreferenced arc to reuse first, otherwise add a new one
+	int arcIndex = -1;
+	for (int searchIndex = 0; searchIndex < m_curvedArcs.size(); searchIndex++)
+	{
+		if (m_curvedArcs[searchIndex].m_numReferences == 0)
+		{
+			arcIndex = searchIndex;
+			break;
+		}
+	}
+	if (arcIndex == -1)
+	{
+		arcIndex = static_cast<int>(m_curvedArcs.size());
+		m_curvedArcs.emplace_back();
+	}
+
+	BuildCurvedArc(arcIndex, origin, iBasis);
+	m_curvedArcs[arcIndex].m_numReferences = 1;
+
+	return arcIndex;
+}
+
+
+void Map::BuildCurvedArc(int arcIndex, Vec2 const& origin, Vec2 const& iBasis)
+{
+	CurvedProjectileArc& arc = m_curvedArcs[arcIndex];
+	arc.m_origin = origin;
+	arc.m_iBasis = iBasis;
+	arc.m_curve = CubicBezierCurve2D::CreateUsingHermite(origin, (iBasis * 0.9f + iBasis.GetRotatedMinus90Degrees()) * SCREEN_CAMERA_SIZE_Y, origin,
+		(-iBasis * 0.9f + iBasis.GetRotatedMinus90Degrees()) * SCREEN_CAMERA_SIZE_Y);
+	arc.m_arcLengths.Build(arc.m_curve);
+}
+
+
+void Map::AddCurvedArcReference(int arcIndex)
+{
+	if (arcIndex < 0) return;
+
+	m_curvedArcs[arcIndex].m_numReferences++;
+}
+
+
+void Map::ReleaseCurvedArc(int arcIndex)
+{
+	if (arcIndex < 0) return;
+
+	m_curvedArcs[arcIndex].m_numReferences--;
+}
+
+
+//
+//snapshot functions
+//
+void Map::WriteSnapshot(SnapshotWriter& writer) const
+{
+	//track, since the spline editor can change it at runtime
+	writer.Write(static_cast<int>(m_trackSpline.size()));
+	writer.WriteBytes(m_trackSpline.data(), m_trackSpline.size() * sizeof(CubicBezierCurve2D));
+
+	//bloons
+	writer.Write(static_cast<int>(m_bloons.size()));
+	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
+	{
+		Bloon const* bloon = m_bloons[bloonIndex];
+
+		writer.Write(bloon != nullptr);
+		if (bloon == nullptr) continue;
+
+		writer.Write(static_cast<int>(bloon->m_definition - BloonDefinition::s_bloonDefinitions.data()));
+		writer.Write(static_cast<int>(bloon->m_currentSplineCurve - m_trackSpline.data()));
+		writer.Write(bloon->m_position);
+		writer.Write(bloon->m_trackDistance);
+		writer.Write(bloon->m_currentHealth);
+		writer.Write(bloon->m_freezeTimer);
+		writer.Write(bloon->m_hasPopped);
+		writer.Write(bloon->m_hasLeaked);
+	}
+
+	//swarms
+	writer.Write(static_cast<int>(m_bloonSwarms.size()));
+	for (int swarmIndex = 0; swarmIndex < m_bloonSwarms.size(); swarmIndex++)
+	{
+		BloonSwarm const& swarm = m_bloonSwarms[swarmIndex];
+
+		writer.Write(static_cast<int>(swarm.m_definition - BloonDefinition::s_bloonDefinitions.data()));
+		writer.Write(swarm.m_headDistance);
+		writer.Write(swarm.m_spacing);
+		writer.Write(swarm.m_firstMemberIndex);
+		writer.Write(swarm.m_numMembers);
+	}
+	writer.Write(m_soldTowerSwarmZoneStart);
+
+	//towers
+	writer.Write(static_cast<int>(m_towers.size()));
+	for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
+	{
+		Tower const* tower = m_towers[towerIndex];
+
+		writer.Write(tower != nullptr);
+		if (tower == nullptr) continue;
+
+		writer.Write(static_cast<int>(tower->m_definition - TowerDefinition::s_towerDefinitions.data()));
+		writer.Write(tower->m_position);
+		writer.Write(tower->m_iBasis);
+		writer.Write(tower->m_cooldownTimer);
+		writer.Write(tower->m_targetingMode);
+		writer.Write(tower->m_curvedArcIndex);
+	}
+
+	//projectiles, with their pass-over sets stored as bloon slot indexes
+	writer.Write(m_projectiles.GetNumSlots());
+	for (int projIndex = 0; projIndex < m_projectiles.GetNumSlots(); projIndex++)
+	{
+		writer.Write(m_projectiles.IsAlive(projIndex));
+		if (!m_projectiles.IsAlive(projIndex)) continue;
+
+		ProjectileColdData const& coldData = m_projectiles.m_coldData[projIndex];
+		writer.Write(static_cast<int>(coldData.m_definition - ProjectileDefinition::s_projectileDefinitions.data()));
+		writer.Write(m_projectiles.m_positions[projIndex]);
+		writer.Write(m_projectiles.m_velocities[projIndex]);
+		writer.Write(m_projectiles.m_remainingLifespans[projIndex]);
+		writer.Write(m_projectiles.m_remainingPierces[projIndex]);
+		writer.Write(coldData.m_addedFreezeTime);
+		writer.Write(m_projectiles.m_sizes[projIndex]);
+		writer.Write(m_projectiles.IsOutOfLifespan(projIndex));
+		writer.Write(m_projectiles.IsOutOfPierce(projIndex));
+		writer.Write(coldData.m_curvedArcIndex);
+		writer.Write(coldData.m_curvedArcDistance);
+		writer.Write(coldData.m_directionDegrees);
+
+		std::vector<Bloon*> const& hitSet = m_projectiles.m_hitSets[projIndex];
+		writer.Write(static_cast<int>(hitSet.size()));
+		for (int passOverIndex = 0; passOverIndex < hitSet.size(); passOverIndex++)
+		{
+			writer.Write(hitSet[passOverIndex]->m_slotIndex);
+		}
+	}
+
+	//curved arcs go last so that entities deleted during a restore release into the old arcs
+	writer.Write(static_cast<int>(m_curvedArcs.size()));
+	for (int arcIndex = 0; arcIndex < m_curvedArcs.size(); arcIndex++)
+	{
+		CurvedProjectileArc const& arc = m_curvedArcs[arcIndex];
+
+		writer.Write(arc.m_numReferences);
+		writer.Write(arc.m_origin);
+		writer.Write(arc.m_iBasis);
+	}
+}
+
+
+bool Map::ReadSnapshot(SnapshotReader& reader)
+{
+	m_restoredArcIndexes.clear();
+
+	//track
+	int numCurves = reader.Read<int>();
+	if (!reader.CanHoldCount(numCurves, sizeof(CubicBezierCurve2D)) || numCurves == 0) return false;
+	m_trackSpline.resize(numCurves);
+	reader.ReadBytes(m_trackSpline.data(), numCurves * sizeof(CubicBezierCurve2D));
+	RebuildTrackLengths();
+
+	//bloons, reusing existing allocations wherever a slot is occupied in both
+	int numBloonSlots = reader.Read<int>();
+	if (!reader.CanHoldCount(numBloonSlots, sizeof(bool))) return false;
+	for (int bloonIndex = numBloonSlots; bloonIndex < m_bloons.size(); bloonIndex++)
+	{
+		delete m_bloons[bloonIndex];
+	}
+	m_bloons.resize(numBloonSlots, nullptr);
+	for (int bloonIndex = 0; bloonIndex < numBloonSlots; bloonIndex++)
+	{
+		Bloon*& bloon = m_bloons[bloonIndex];
+
+		if (!reader.Read<bool>())
+		{
+			delete bloon;
+			bloon = nullptr;
+			continue;
+		}
+
+		BloonDefinition const* def = BloonDefinition::GetBloonDefinitionByIndex(reader.Read<int>());
+		int curveIndex = reader.Read<int>();
+		if (def == nullptr || curveIndex < 0 || curveIndex >= numCurves) return false;
+
+		if (bloon == nullptr)
+		{
+			bloon = new Bloon(def, this);
+		}
+		bloon->m_definition = def;
+		bloon->m_currentSplineCurve = &m_trackSpline[curveIndex];
+		bloon->m_splineCurveIndex = curveIndex;
+		bloon->m_position = reader.Read<Vec2>();
+		bloon->m_trackDistance = reader.Read<float>();
+		bloon->m_currentHealth = reader.Read<int>();
+		bloon->m_freezeTimer = reader.Read<float>();
+		bloon->m_hasPopped = reader.Read<bool>();
+		bloon->m_hasLeaked = reader.Read<bool>();
+		bloon->m_popperIndex = -1;
+		bloon->m_slotIndex = bloonIndex;
+	}
+
+	//swarms
+	int numSwarms = reader.Read<int>();
+	if (!reader.CanHoldCount(numSwarms, 3 * sizeof(int) + 2 * sizeof(float))) return false;
+	m_bloonSwarms.resize(numSwarms);
+	for (int swarmIndex = 0; swarmIndex < numSwarms; swarmIndex++)
+	{
+		BloonSwarm& swarm = m_bloonSwarms[swarmIndex];
+
+		swarm.m_definition = BloonDefinition::GetBloonDefinitionByIndex(reader.Read<int>());
+		if (swarm.m_definition == nullptr) return false;
+		swarm.m_headDistance = reader.Read<float>();
+		swarm.m_spacing = reader.Read<float>();
+		swarm.m_firstMemberIndex = reader.Read<int>();
+		swarm.m_numMembers = reader.Read<int>();
+
+		//every member loop steps back by the spacing from the first remaining member until it runs out of members or track
+		bool isHeadValid = swarm.m_headDistance >= 0.0f && swarm.m_headDistance <= FLT_MAX;
+		bool isSpacingValid = swarm.m_spacing > 0.0f && swarm.m_spacing <= FLT_MAX;
+		bool areMembersValid = swarm.m_firstMemberIndex >= 0 && swarm.m_firstMemberIndex < swarm.m_numMembers && swarm.m_numMembers <= MAX_SWARM_MEMBERS;
+		if (!isHeadValid || !isSpacingValid || !areMembersValid) return false;
+	}
+	m_soldTowerSwarmZoneStart = reader.Read<float>();
+
+	//towers
+	int numTowerSlots = reader.Read<int>();
+	if (!reader.CanHoldCount(numTowerSlots, sizeof(bool))) return false;
+	for (int towerIndex = numTowerSlots; towerIndex < m_towers.size(); towerIndex++)
+	{
+		delete m_towers[towerIndex];
+	}
+	m_towers.resize(numTowerSlots, nullptr);
+	for (int towerIndex = 0; towerIndex < numTowerSlots; towerIndex++)
+	{
+		Tower*& tower = m_towers[towerIndex];
+
+		if (!reader.Read<bool>())
+		{
+			delete tower;
+			tower = nullptr;
+			continue;
+		}
+
+		TowerDefinition const* def = TowerDefinition::GetTowerDefinitionByIndex(reader.Read<int>());
+		if (def == nullptr) return false;
+
+		Vec2 position = reader.Read<Vec2>();
+		if (tower == nullptr)
+		{
+			tower = new Tower(def, this, position);
+		}
+		tower->m_slotIndex = towerIndex;
+		tower->m_definition = def;
+		tower->m_position = position;
+		tower->m_iBasis = reader.Read<Vec2>();
+		tower->m_cooldownTimer = reader.Read<float>();
+		tower->m_targetingMode = reader.Read<TargetingMode>();
+		tower->m_curvedArcIndex = -1;
+		m_restoredArcIndexes.emplace_back(towerIndex, reader.Read<int>());
+		tower->m_target = nullptr;
+		tower->m_isBeingHeld = false;
+		tower->Wake();
+	}
+	m_simulationSeconds = 0.0;
+	m_towerWakeWheel.Clear();
+	m_numLivesLeaked = 0;
+	RescheduleAllLeakChecks();
+
+	//projectiles
+	int numProjSlots = reader.Read<int>();
+	if (!reader.CanHoldCount(numProjSlots, sizeof(bool))) return false;
+	m_projectiles.ResetForRestore(numProjSlots);
+	for (int projIndex = 0; projIndex < numProjSlots; projIndex++)
+	{
+		if (!reader.Read<bool>()) continue;
+
+		ProjectileDefinition const* def = ProjectileDefinition::GetProjectileDefinitionByIndex(reader.Read<int>());
+		if (def == nullptr) return false;
+
+		ProjectileColdData& coldData = m_projectiles.m_coldData[projIndex];
+		m_projectiles.m_positions[projIndex] = reader.Read<Vec2>();
+		m_projectiles.m_velocities[projIndex] = reader.Read<Vec2>();
+		m_projectiles.m_remainingLifespans[projIndex] = reader.Read<float>();
+		m_projectiles.m_remainingPierces[projIndex] = reader.Read<int>();
+		coldData.m_addedFreezeTime = reader.Read<float>();
+		m_projectiles.m_sizes[projIndex] = reader.Read<float>();
+		uint8_t flags = 0;
+		if (reader.Read<bool>()) flags |= PROJECTILE_FLAG_OUT_OF_LIFESPAN;
+		if (reader.Read<bool>()) flags |= PROJECTILE_FLAG_OUT_OF_PIERCE;
+		int curvedArcIndex = reader.Read<int>();
+		m_restoredArcIndexes.emplace_back(numTowerSlots + projIndex, curvedArcIndex);
+		coldData.m_curvedArcDistance = reader.Read<float>();
+		coldData.m_directionDegrees = reader.Read<float>();
+		if (def->m_curvedArc && curvedArcIndex != -1) flags |= PROJECTILE_FLAG_CURVED;
+		m_projectiles.Restore(projIndex, def, flags);
+
+		int numPassOvers = reader.Read<int>();
+		if (!reader.CanHoldCount(numPassOvers, sizeof(int))) return false;
+		for (int passOverIndex = 0; passOverIndex < numPassOvers; passOverIndex++)
+		{
+			int bloonSlot = reader.Read<int>();
+			if (bloonSlot < 0 || bloonSlot >= numBloonSlots || m_bloons[bloonSlot] == nullptr) return false;
+			m_projectiles.AddHitBloon(projIndex, m_bloons[bloonSlot]);
+		}
+	}
+	m_projectiles.RebuildFreeSlots();
+
+	//curved arcs, rebuilding their arc-length tables from the saved facing
+	int numArcs = reader.Read<int>();
+	if (!reader.CanHoldCount(numArcs, sizeof(int) + 2 * sizeof(Vec2))) return false;
+	m_curvedArcs.resize(numArcs);
+	for (int arcIndex = 0; arcIndex < numArcs; arcIndex++)
+	{
+		int numReferences = reader.Read<int>();
+		Vec2 origin = reader.Read<Vec2>();
+		Vec2 iBasis = reader.Read<Vec2>();
+
+		CurvedProjectileArc& arc = m_curvedArcs[arcIndex];
+		if (numReferences > 0 && (arc.m_origin != origin || arc.m_iBasis != iBasis))
+		{
+			BuildCurvedArc(arcIndex, origin, iBasis);
+		}
+		arc.m_numReferences = numReferences;
+	}
+
+	//arc indexes are only handed to towers and projectiles once they're known to be in the table
+	for (int restoredIndex = 0; restoredIndex < m_restoredArcIndexes.size(); restoredIndex++)
+	{
+		int arcIndex = m_restoredArcIndexes[restoredIndex].second;
+		if (arcIndex < -1 || arcIndex >= numArcs) return false;
+	}
+	for (int restoredIndex = 0; restoredIndex < m_restoredArcIndexes.size(); restoredIndex++)
+	{
+		int ownerIndex = m_restoredArcIndexes[restoredIndex].first;
+		int arcIndex = m_restoredArcIndexes[restoredIndex].second;
+		if (ownerIndex < numTowerSlots)
+		{
+			m_towers[ownerIndex]->m_curvedArcIndex = arcIndex;
+		}
+		else
+		{
+			m_projectiles.m_coldData[ownerIndex - numTowerSlots].m_curvedArcIndex = arcIndex;
+		}
+	}
+
+	m_tickStateHash = ComputeStateHash();
+	return reader.IsValid();
+}
+
+
+//
+//determinism functions
+//
+//full recompute, gives the same value Update leaves in m_tickStateHash
+uint64_t Map::ComputeStateHash() const
+{
+	uint64_t bloonHash = STATE_HASH_SEED;
+	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
+	{
+		if (m_bloons[bloonIndex] != nullptr)
+		{
+			bloonHash = CombineEntityHash(bloonHash, bloonIndex, m_bloons[bloonIndex]->GetStateHash());
+		}
+	}
+	if (!m_bloonSwarms.empty())
+	{
+		bloonHash = HashCombine(bloonHash, ComputeSwarmHash());
+	}
+
+	uint64_t projHash = STATE_HASH_SEED;
+	for (int projIndex = 0; projIndex < m_projectiles.GetNumSlots(); projIndex++)
+	{
+		if (m_projectiles.IsAlive(projIndex))
+		{
+			projHash = CombineEntityHash(projHash, projIndex, m_projectiles.GetStateHash(projIndex));
+		}
+	}
+
+	return CombineMapHash(bloonHash, ComputeTowerHash(), projHash);
+}
+
+
+//
+//private member functions
+//
+//maps are opened and restored on worker threads too, so generations come from one shared counter
+uint64_t Map::TakeTrackGeneration()
+{
+	static std::atomic<uint64_t> s_lastTrackGeneration = 0;
+	return ++s_lastTrackGeneration;
+}
+
+
+//re-tessellates every curve, so it's only done when the track changes rather than for each bloon that needs the length
+float Map::ComputeSplineTrackLength(std::vector<CubicBezierCurve2D> const& curves)
+{
+	float totalSplineDistance = 0.0f;
+	for (int curveIndex = 0; curveIndex < curves.size(); curveIndex++)
+	{
+		totalSplineDistance += curves[curveIndex].GetApproximateLength(NUM_CURVE_SUBDIVISIONS);
+	}
+	return totalSplineDistance;
+}
+
+
+//adds the time since the phase started and returns now, which is when the next phase starts
+double Map::RecordPhaseTime(double& phaseSeconds, double phaseStartSeconds)
+{
+	double nowSeconds = GetCurrentTimeSeconds();
+	phaseSeconds += nowSeconds - phaseStartSeconds;
+	return nowSeconds;
+}
+
+
+//pops every check that's come due; bloons that haven't reached the end yet are checked again closer to when they will
+void Map::ProcessDueLeakChecks()
+{
+	m_dueLeakCheckBloons.clear();
+	while (!m_leakChecks.empty() && m_leakChecks.front().m_dueSeconds <= m_simulationSeconds)
+	{
+		LeakCheck leakCheck = m_leakChecks.front();
+		std::pop_heap(m_leakChecks.begin(), m_leakChecks.end(), std::greater<LeakCheck>());
+		m_leakChecks.pop_back();
+
+		Bloon* bloon = leakCheck.m_bloonSlot < m_bloons.size() ? m_bloons[leakCheck.m_bloonSlot] : nullptr;
+		if (bloon == nullptr || bloon != leakCheck.m_bloon || bloon->m_leakCheckSeconds != leakCheck.m_dueSeconds) continue;
+
+		m_dueLeakCheckBloons.emplace_back(bloon);
+	}
+	if (m_dueLeakCheckBloons.empty()) return;
+
+	//rescheduled checks can be due already, so they only go back in once this tick's are all out
+	float trackLength = GetBloonTrackLength();
+	for (int dueIndex = 0; dueIndex < m_dueLeakCheckBloons.size(); dueIndex++)
+	{
+		Bloon* bloon = m_dueLeakCheckBloons[dueIndex];
+		if (bloon->m_trackDistance >= trackLength)
+		{
+			bloon->Leak();
+			m_numLivesLeaked += bloon->m_definition->m_RBE;
+			if (m_game->m_roundTelemetry != nullptr)
+			{
+				m_game->m_roundTelemetry->CountLeaks(bloon->m_definition, 1);
+			}
+		}
+		else
+		{
+			ScheduleLeakCheck(*bloon, trackLength);
+		}
+	}
+}
+
+
+//swarms move in O(1) each; only members leaking or reaching a tower's stretch of track cost anything
+void Map::UpdateBloonSwarms(float deltaSeconds)
+{
+	if (m_bloonSwarms.empty()) return;
+
+	float trackLength = GetTrackLength();
+	float materializeDistance = GetSwarmMaterializeDistance();
+	if (materializeDistance < 0.0f)
+	{
+		materializeDistance = 0.0f;
+	}
+
+	for (int swarmIndex = 0; swarmIndex < m_bloonSwarms.size();)
+	{
+		BloonSwarm& swarm = m_bloonSwarms[swarmIndex];
+		swarm.m_headDistance += swarm.m_definition->m_speed * deltaSeconds;
+
+		//nothing touched the members at the front on their way, so the ones past the end leak together
+		int numLeaked = 0;
+		while (swarm.m_firstMemberIndex < swarm.m_numMembers && swarm.GetMemberDistance(swarm.m_firstMemberIndex) >= trackLength)
+		{
+			swarm.m_firstMemberIndex++;
+			numLeaked++;
+		}
+		m_numLivesLeaked += swarm.m_definition->m_RBE * numLeaked;
+		if (m_game->m_roundTelemetry != nullptr)
+		{
+			m_game->m_roundTelemetry->CountLeaks(swarm.m_definition, numLeaked);
+		}
+
+		while (swarm.m_firstMemberIndex < swarm.m_numMembers && swarm.GetMemberDistance(swarm.m_firstMemberIndex) >= materializeDistance)
+		{
+			AddBloon(new Bloon(swarm.m_definition, this, &m_trackSpline[0], swarm.GetMemberDistance(swarm.m_firstMemberIndex)));
+			swarm.m_firstMemberIndex++;
+		}
+
+		if (swarm.m_firstMemberIndex >= swarm.m_numMembers)
+		{
+			m_bloonSwarms.erase(m_bloonSwarms.begin() + swarmIndex);
+			continue;
+		}
+		swarmIndex++;
+	}
+}
+
+
+//the earliest point on the track where a bloon could be hit by anything
+float Map::GetSwarmMaterializeDistance()
+{
+	float materializeDistance = m_soldTowerSwarmZoneStart;
+	for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
+	{
+		Tower* tower = m_towers[towerIndex];
+		if (tower == nullptr) continue;
+
+		if (!tower->m_hasTrackCoverage)
+		{
+			RefreshTowerTrackCoverage(*tower);
+		}
+		if (tower->m_swarmZoneStart < materializeDistance)
+		{
+			materializeDistance = tower->m_swarmZoneStart;
+		}
+	}
+
+	return materializeDistance;
+}
+
+
+uint64_t Map::ComputeSwarmHash() const
+{
+	uint64_t swarmHash = STATE_HASH_SEED;
+	for (int swarmIndex = 0; swarmIndex < m_bloonSwarms.size(); swarmIndex++)
+	{
+		BloonSwarm const& swarm = m_bloonSwarms[swarmIndex];
+
+		uint64_t hash = STATE_HASH_SEED;
+		hash = HashWord(hash, static_cast<int>(swarm.m_definition - BloonDefinition::s_bloonDefinitions.data()));
+		hash = HashWord(hash, swarm.m_headDistance);
+		hash = HashWord(hash, swarm.m_spacing);
+		hash = HashWord(hash, swarm.m_firstMemberIndex);
+		hash = HashWord(hash, swarm.m_numMembers);
+		swarmHash = CombineEntityHash(swarmHash, swarmIndex, hash);
+	}
+
+	return swarmHash;
+}
+
+
+void Map::UpdateTowers(float deltaSeconds)
+{
+	//coverage is measured on the arc-length tables, so sleeping is only exact when bloons move along them too
+	SimulationConfig const& config = m_game->m_simConfig;
+	bool canSleep = config.m_useTowerSleep && config.m_useArcLengthTables;
+
+	if (canSleep)
+	{
+		m_isSleepArrivalListBuilt = false;
+		m_dueTowerIndexes.clear();
+		m_towerWakeWheel.AdvanceTo(m_simulationSeconds, m_dueTowerIndexes);
+		for (int dueIndex = 0; dueIndex < m_dueTowerIndexes.size(); dueIndex++)
+		{
+			//skip entries for sold towers and for wakes a spawn already brought forward
+			int towerIndex = m_dueTowerIndexes[dueIndex];
+			Tower* tower = towerIndex < m_towers.size() ? m_towers[towerIndex] : nullptr;
+			if (tower != nullptr && tower->m_isAsleep && tower->m_wakeSeconds <= m_simulationSeconds)
+			{
+				tower->m_isAsleep = false;
+			}
+		}
+	}
+
+	for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
+	{
+		Tower*& tower = m_towers[towerIndex];
+		if (tower == nullptr) continue;
+
+		if (tower->m_isAsleep)
+		{
+			if (canSleep) continue;
+			tower->m_isAsleep = false;
+		}
+
+		tower->Update(deltaSeconds);
+
+		if (canSleep && !tower->m_foundTarget)
+		{
+			TryToPutTowerToSleep(towerIndex);
+		}
+	}
+}
+
+
+//built once per tick, the first time a tower tries to sleep; bloons only move forward during the tower update, and
+//children spawned by collisions afterwards wake towers themselves
+void Map::BuildSleepArrivalList()
+{
+	m_sleepArrivalDistances.clear();
+	m_sleepArrivalMaxSpeed = 0.0f;
+	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
+	{
+		Bloon const* bloon = m_bloons[bloonIndex];
+		if (bloon == nullptr) continue;
+
+		m_sleepArrivalDistances.emplace_back(bloon->m_trackDistance);
+		m_sleepArrivalMaxSpeed = bloon->m_definition->m_speed > m_sleepArrivalMaxSpeed ? bloon->m_definition->m_speed : m_sleepArrivalMaxSpeed;
+	}
+
+	//a swarm's first remaining member arrives before the rest, and has become a bloon by the time it gets there
+	for (int swarmIndex = 0; swarmIndex < m_bloonSwarms.size(); swarmIndex++)
+	{
+		BloonSwarm const& swarm = m_bloonSwarms[swarmIndex];
+
+		m_sleepArrivalDistances.emplace_back(swarm.GetMemberDistance(swarm.m_firstMemberIndex));
+		m_sleepArrivalMaxSpeed = swarm.m_definition->m_speed > m_sleepArrivalMaxSpeed ? swarm.m_definition->m_speed : m_sleepArrivalMaxSpeed;
+	}
+
+	std::sort(m_sleepArrivalDistances.begin(), m_sleepArrivalDistances.end());
+	m_isSleepArrivalListBuilt = true;
+}
+
+
+//a tower with nothing in range ends its Update with no target and no cooldown, and stays that way until
+//a bloon reaches it, so it can skip Update entirely until the first bloon could be on one of its stretches of track
+void Map::TryToPutTowerToSleep(int towerIndex)
+{
+	Tower& tower = *m_towers[towerIndex];
+	if (!tower.m_hasTrackCoverage)
+	{
+		RefreshTowerTrackCoverage(tower);
+	}
+	if (!m_isSleepArrivalListBuilt)
+	{
+		BuildSleepArrivalList();
+	}
+
+	//anything already on a stretch keeps the tower awake; otherwise the nearest one behind each stretch, moving as fast
+	//as the fastest bloon out there, bounds how soon anything can arrive. Waking early just means sleeping again
+	float secondsUntilCoverage = FLT_MAX;
+	for (int intervalIndex = 0; intervalIndex < tower.m_numTrackCoverageIntervals; intervalIndex++)
+	{
+		TrackCoverageInterval const& interval = tower.m_trackCoverage[intervalIndex];
+		std::vector<float>::const_iterator firstAtOrPastStart = std::lower_bound(m_sleepArrivalDistances.begin(), m_sleepArrivalDistances.end(), interval.m_start);
+		if (firstAtOrPastStart != m_sleepArrivalDistances.end() && *firstAtOrPastStart <= interval.m_end) return;
+		if (firstAtOrPastStart == m_sleepArrivalDistances.begin() || m_sleepArrivalMaxSpeed <= 0.0f) continue;
+
+		float intervalSeconds = (interval.m_start - *(firstAtOrPastStart - 1)) / m_sleepArrivalMaxSpeed;
+		if (intervalSeconds < secondsUntilCoverage)
+		{
+			secondsUntilCoverage = intervalSeconds;
+		}
+	}
+
+	tower.m_isAsleep = true;
+	tower.m_wakeSeconds = FLT_MAX;
+	if (secondsUntilCoverage != FLT_MAX)
+	{
+		tower.m_wakeSeconds = m_simulationSeconds + secondsUntilCoverage;
+		m_towerWakeWheel.Schedule(towerIndex, tower.m_wakeSeconds);
+	}
+}
+
+
+//how far from its tower a projectile can end up, following the projectiles it spawns when it runs out of pierce
+static float GetProjectileReach(ProjectileDefinition const* def, float addedLifespan, float addedSize, int spawnDepth)
+{
+	if (def == nullptr || spawnDepth > 8) return 0.0f;
+
+	//road items keep drifting once their lifespan is up, so they could end up anywhere
+	if (def->m_isRoadItem && def->m_speed > 0.0f) return FLT_MAX;
+
+	float reach = def->m_speed * (def->m_lifespan + addedLifespan);
+	if (def->m_curvedArc && reach < SCREEN_CAMERA_SIZE_Y)
+	{
+		reach = SCREEN_CAMERA_SIZE_Y;	//arcs never stray more than about half this far from the thrower
+	}
+	reach += def->m_size + addedSize;
+
+	float furthestSpawnReach = 0.0f;
+	for (int spawnIndex = 0; spawnIndex < def->m_projectilesToSpawn.size(); spawnIndex++)
+	{
+		ProjectileDefinition const* spawnDef = ProjectileDefinition::GetProjectileDefinitionByName(def->m_projectilesToSpawn[spawnIndex]);
+		float spawnReach = GetProjectileReach(spawnDef, 0.0f, 0.0f, spawnDepth + 1);
+		if (spawnReach == FLT_MAX) return FLT_MAX;
+		if (spawnReach > furthestSpawnReach) furthestSpawnReach = spawnReach;
+	}
+
+	return reach + furthestSpawnReach;
+}
+
+
+//finds the stretches of track on which any bloon could overlap the tower's range
+void Map::RefreshTowerTrackCoverage(Tower& tower) const
+{
+	float largestBloonSize = 0.0f;
+	for (int defIndex = 0; defIndex < BloonDefinition::s_bloonDefinitions.size(); defIndex++)
+	{
+		if (BloonDefinition::s_bloonDefinitions[defIndex].m_size > largestBloonSize)
+		{
+			largestBloonSize = BloonDefinition::s_bloonDefinitions[defIndex].m_size;
+		}
+	}
+	float coverageRadius = tower.m_definition->m_range + largestBloonSize + TOWER_COVERAGE_MARGIN;
+	float coverageRadiusSquared = coverageRadius * coverageRadius;
+
+	//swarms have to become bloons before anything the tower fires could touch them, wherever it ends up flying
+	float projectileReach = GetProjectileReach(tower.m_definition->m_projectileDef, tower.m_definition->m_addedLifespan, tower.m_definition->m_addedSize, 0);
+	float swarmZoneRadius = coverageRadius + projectileReach;
+	float swarmZoneRadiusSquared = projectileReach == FLT_MAX ? FLT_MAX : swarmZoneRadius * swarmZoneRadius;
+
+	tower.m_numTrackCoverageIntervals = 0;
+	tower.m_swarmZoneStart = FLT_MAX;
+	for (int curveIndex = 0; curveIndex < m_trackArcLengths.size(); curveIndex++)
+	{
+		ArcLengthTable const& table = m_trackArcLengths[curveIndex];
+		float curveStartDistance = m_trackCurveStartDistances[curveIndex];
+
+		for (int subdivIndex = 0; subdivIndex < NUM_CURVE_SUBDIVISIONS; subdivIndex++)
+		{
+			Vec2 nearestPoint = GetNearestPointOnLineSegment(tower.m_position, table.m_points[subdivIndex], table.m_points[subdivIndex + 1]);
+			float distanceSquared = GetDistanceSquared2D(nearestPoint, tower.m_position);
+			float segmentStart = curveStartDistance + table.m_cumulativeLengths[subdivIndex];
+			if (distanceSquared <= swarmZoneRadiusSquared && segmentStart < tower.m_swarmZoneStart) tower.m_swarmZoneStart = segmentStart;
+			if (distanceSquared > coverageRadiusSquared) continue;
+
+			//segments come in track order, so each one either continues the last stretch or starts a new one
+			float segmentEnd = curveStartDistance + table.m_cumulativeLengths[subdivIndex + 1];
+			int& numIntervals = tower.m_numTrackCoverageIntervals;
+			if (numIntervals > 0 && (segmentStart <= tower.m_trackCoverage[numIntervals - 1].m_end + TOWER_COVERAGE_JOIN_DISTANCE || numIntervals == MAX_TRACK_COVERAGE_INTERVALS))
+			{
+				tower.m_trackCoverage[numIntervals - 1].m_end = segmentEnd;
+			}
+			else
+			{
+				tower.m_trackCoverage[numIntervals].m_start = segmentStart;
+				tower.m_trackCoverage[numIntervals].m_end = segmentEnd;
+				numIntervals++;
+			}
+		}
+	}
+
+	tower.m_hasTrackCoverage = true;
+}
+
+
+uint64_t Map::ComputeTowerHash() const
+{
+	uint64_t towerHash = STATE_HASH_SEED;
+	for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
+	{
+		if (m_towers[towerIndex] != nullptr)
+		{
+			towerHash = CombineEntityHash(towerHash, towerIndex, m_towers[towerIndex]->GetStateHash());
+		}
+	}
+
+	return towerHash;
+}
+
+
+uint64_t Map::CombineEntityHash(uint64_t hash, int slotIndex, uint64_t entityHash)
+{
+	hash = HashWord(hash, slotIndex);
+	return HashCombine(hash, entityHash);
+}
+
+
+uint64_t Map::CombineMapHash(uint64_t bloonHash, uint64_t towerHash, uint64_t projHash)
+{
+	uint64_t hash = HashCombine(STATE_HASH_SEED, bloonHash);
+	hash = HashCombine(hash, towerHash);
+	return HashCombine(hash, projHash);
+}
+
+
+//compares entity slot by slot in the order bloons, towers, projectiles and describes the first mismatch
+bool Map::FindFirstDivergence(Map const& other, std::string& out_description) const
+{
+	int numBloonSlots = static_cast<int>(m_bloons.size() > other.m_bloons.size() ? m_bloons.size() : other.m_bloons.size());
+	for (int bloonIndex = 0; bloonIndex < numBloonSlots; bloonIndex++)
+	{
+		Bloon const* bloonA = bloonIndex < m_bloons.size() ? m_bloons[bloonIndex] : nullptr;
+		Bloon const* bloonB = bloonIndex < other.m_bloons.size() ? other.m_bloons[bloonIndex] : nullptr;
+		if (bloonA == nullptr && bloonB == nullptr) continue;
+
+		if (bloonA == nullptr || bloonB == nullptr || bloonA->GetStateHash() != bloonB->GetStateHash())
+		{
+			out_description = Stringf("Bloon %i | A: %s | B: %s", bloonIndex, bloonA != nullptr ? bloonA->GetStateDescription().c_str() : "none",
+				bloonB != nullptr ? bloonB->GetStateDescription().c_str() : "none");
+			return true;
+		}
+	}
+
+	if (ComputeSwarmHash() != other.ComputeSwarmHash())
+	{
+		out_description = Stringf("Swarms | A: %i swarms | B: %i swarms", static_cast<int>(m_bloonSwarms.size()), static_cast<int>(other.m_bloonSwarms.size()));
+		int numSwarms = static_cast<int>(m_bloonSwarms.size() < other.m_bloonSwarms.size() ? m_bloonSwarms.size() : other.m_bloonSwarms.size());
+		for (int swarmIndex = 0; swarmIndex < numSwarms; swarmIndex++)
+		{
+			BloonSwarm const& swarmA = m_bloonSwarms[swarmIndex];
+			BloonSwarm const& swarmB = other.m_bloonSwarms[swarmIndex];
+			if (swarmA.m_headDistance != swarmB.m_headDistance || swarmA.m_firstMemberIndex != swarmB.m_firstMemberIndex)
+			{
+				out_description = Stringf("Swarm %i | A: head=%.9g first=%i of %i | B: head=%.9g first=%i of %i", swarmIndex, swarmA.m_headDistance, swarmA.m_firstMemberIndex,
+					swarmA.m_numMembers, swarmB.m_headDistance, swarmB.m_firstMemberIndex, swarmB.m_numMembers);
+				break;
+			}
+		}
+		return true;
+	}
+
+	int numTowerSlots = static_cast<int>(m_towers.size() > other.m_towers.size() ? m_towers.size() : other.m_towers.size());
+	for (int towerIndex = 0; towerIndex < numTowerSlots; towerIndex++)
+	{
+		Tower const* towerA = towerIndex < m_towers.size() ? m_towers[towerIndex] : nullptr;
+		Tower const* towerB = towerIndex < other.m_towers.size() ? other.m_towers[towerIndex] : nullptr;
+		if (towerA == nullptr && towerB == nullptr) continue;
+
+		if (towerA == nullptr || towerB == nullptr || towerA->GetStateHash() != towerB->GetStateHash())
+		{
+			out_description = Stringf("Tower %i | A: %s | B: %s", towerIndex, towerA != nullptr ? towerA->GetStateDescription().c_str() : "none",
+				towerB != nullptr ? towerB->GetStateDescription().c_str() : "none");
+			return true;
+		}
+	}
+
+	ProjectilePool const& projsA = m_projectiles;
+	ProjectilePool const& projsB = other.m_projectiles;
+	int numProjSlots = projsA.GetNumSlots() > projsB.GetNumSlots() ? projsA.GetNumSlots() : projsB.GetNumSlots();
+	for (int projIndex = 0; projIndex < numProjSlots; projIndex++)
+	{
+		bool isAliveA = projIndex < projsA.GetNumSlots() && projsA.IsAlive(projIndex);
+		bool isAliveB = projIndex < projsB.GetNumSlots() && projsB.IsAlive(projIndex);
+		if (!isAliveA && !isAliveB) continue;
+
+		if (!isAliveA || !isAliveB || projsA.GetStateHash(projIndex) != projsB.GetStateHash(projIndex))
+		{
+			out_description = Stringf("Projectile %i | A: %s | B: %s", projIndex, isAliveA ? projsA.GetStateDescription(projIndex).c_str() : "none",
+				isAliveB ? projsB.GetStateDescription(projIndex).c_str() : "none");
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void Map::AppendStateDump(std::string& dump) const
+{
+	dump += Stringf("Map %s, state hash %016llx\n", m_definition->m_name.c_str(), static_cast<unsigned long long>(ComputeStateHash()));
+
+	for (int bloonIndex = 0; bloonIndex < m_bloons.size(); bloonIndex++)
+	{
+		if (m_bloons[bloonIndex] != nullptr)
+		{
+			dump += Stringf("Bloon %i: %s\n", bloonIndex, m_bloons[bloonIndex]->GetStateDescription().c_str());
+		}
+	}
+	for (int swarmIndex = 0; swarmIndex < m_bloonSwarms.size(); swarmIndex++)
+	{
+		BloonSwarm const& swarm = m_bloonSwarms[swarmIndex];
+		dump += Stringf("Swarm %i: %s head=%.9g spacing=%.9g members %i to %i\n", swarmIndex, swarm.m_definition->m_name.c_str(), swarm.m_headDistance, swarm.m_spacing,
+			swarm.m_firstMemberIndex, swarm.m_numMembers - 1);
+	}
+	for (int towerIndex = 0; towerIndex < m_towers.size(); towerIndex++)
+	{
+		if (m_towers[towerIndex] != nullptr)
+		{
+			dump += Stringf("Tower %i: %s\n", towerIndex, m_towers[towerIndex]->GetStateDescription().c_str());
+		}
+	}
+	for (int projIndex = 0; projIndex < m_projectiles.GetNumSlots(); projIndex++)
+	{
+		if (m_projectiles.IsAlive(projIndex))
+		{
+			dump += Stringf("Projectile %i: %s\n", projIndex, m_projectiles.GetStateDescription(projIndex).c_str());
+		}
+	}
+}
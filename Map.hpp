@@ -1,5 +1,8 @@
 #pragma once
 #include "Game/MapDefinition.hpp"
+#include "Game/ArcLengthTable.hpp"
+#include "Game/TimingWheel.hpp"
+#include "Game/ProjectilePool.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Math/CubicBezierCurve2D.hpp"
 
@@ -7,40 +10,179 @@
 class Bloon;
 class BloonDefinition;
 class Tower;
-class Projectile;
+class TowerDefinition;
 class ProjectileDefinition;
+class SnapshotWriter;
+class SnapshotReader;
+class Game;
+
+
+constexpr double TOWER_WAKE_SLOT_SECONDS = 1.0 / 30.0;
+constexpr int	 NUM_TOWER_WAKE_SLOTS = 256;
+constexpr float	 TOWER_COVERAGE_MARGIN = 4.0f;	//slack so rounding in bloon movement can never wake a tower late
+constexpr int	 MAX_SWARM_MEMBERS = 1 << 20;	//bounds what a restored snapshot can ask the per-member loops to walk
+constexpr float	 TOWER_COVERAGE_JOIN_DISTANCE = 0.01f;	//covered segments this close count as one stretch, absorbing rounding between curves
+constexpr double LEAK_CHECK_MARGIN_SECONDS = 0.25;	//leak checks start this early so rounding in bloon movement can never make a leak late
+
+
+//seconds spent in each part of Map::Update, only measured while something has pointed the map at one of these
+struct MapPhaseTimings
+{
+	double m_bloonSeconds = 0.0;		//movement, due leak checks and swarms
+	double m_towerSeconds = 0.0;
+	double m_projectileSeconds = 0.0;
+	double m_collisionSeconds = 0.0;
+	double m_cleanupSeconds = 0.0;		//popped and leaked bloons, dead projectiles and the tick hash
+};
+
+
+//identical bloons spawned at a fixed spacing; they move in lockstep until hit, so they're kept as one record and only
+//turned into individual bloons once they reach a stretch of track that a tower or its projectiles could touch
+struct BloonSwarm
+{
+	BloonDefinition const* m_definition = nullptr;
+	float m_headDistance = 0.0f;	//track distance of member 0; later members trail it and may still be queued before the start
+	float m_spacing = 0.0f;
+	int	  m_firstMemberIndex = 0;	//members before this have leaked or become bloons
+	int	  m_numMembers = 0;
+
+	float GetMemberDistance(int memberIndex) const { return m_headDistance - m_spacing * static_cast<float>(memberIndex); }
+};
 
 
 class Map
 {
 //public member functions
 public:
-	Map(MapDefinition const* definition)
-		: m_definition(definition), m_trackSpline(definition->m_trackSpline) 
+	Map(MapDefinition const* definition, Game* game)
+		: m_definition(definition), m_game(game), m_trackSpline(definition->m_track.m_curves), m_trackArcLengths(definition->m_track.m_arcLengths),
+		m_trackCurveStartDistances(definition->m_track.m_curveStartDistances), m_trackGeneration(TakeTrackGeneration()),
+		m_trackSplineLength(ComputeSplineTrackLength(definition->m_track.m_curves))
 	{}
 	~Map();
 
 	//game flow functions
 	void Update(float deltaSeconds);
-	void Render() const;
 
 	//gameplay functions
+	int  AddBloon(Bloon* bloon);
 	void SpawnBloonAtStart(BloonDefinition const* bloonDef);
 	void SpawnBloonChildren(Bloon const* bloon);
+	void SpawnBloonSwarmAtStart(BloonDefinition const* bloonDef, int numBloons, float spacing);
+	bool HasBloonsLeft() const;
+	int  ClearBloons();
+	void ClearSoldTowerSwarmZones() { m_soldTowerSwarmZoneStart = FLT_MAX; }
 	void SpawnProjectile(ProjectileDefinition const* projectileDef, Vec2 const& position, Vec2 const& direction, int addedPierce = 0, float addedLifespan = 0.0f, float addedSize = 0.0f,
-		float addedFreezeTime = 0.0f, CubicBezierCurve2D curvedProjArc = CubicBezierCurve2D());
+		float addedFreezeTime = 0.0f, int curvedArcIndex = -1, int ownerTowerSlot = -1);
 	void CollideProjectilesAgainstBloons();
-	bool CollideProjectileAgainstBloon(Projectile& projectile, Bloon& bloon);
+	bool CollideProjectileAgainstBloon(int projIndex, Bloon& bloon);
 	void SellTower(int towerIndex);
 	Vec2 GetNearestPointOnTrack(Vec2 const& referencePoint) const;
+	bool IsValidTowerPlacement(TowerDefinition const* towerDef, Vec2 const& position) const;
+
+	//leak queue functions
+	void  ScheduleLeakCheck(Bloon& bloon, float trackLength);
+	void  RescheduleAllLeakChecks();
+	float GetBloonTrackLength() const;
+
+	//tower sleep functions
+	void  WakeTowersForBloon(Bloon const& bloon);
+	void  WakeAllTowers();
+	float GetSecondsUntilTrackCoverage(Tower const& tower, Bloon const& bloon) const;
+
+	//track length functions
+	void  RebuildTrackLengths();
+	void  OnTrackCurvesChanged(int firstCurveIndex, int lastCurveIndex);
+	float GetTrackLength() const { return m_trackCurveStartDistances.back(); }
+	Vec2  GetTrackPositionAtDistance(float distance) const;
+
+	//curved projectile arc functions
+	int  AcquireCurvedArc(Vec2 const& origin, Vec2 const& iBasis);
+	void AddCurvedArcReference(int arcIndex);
+	void ReleaseCurvedArc(int arcIndex);
+	void BuildCurvedArc(int arcIndex, Vec2 const& origin, Vec2 const& iBasis);
+	CurvedProjectileArc const& GetCurvedArc(int arcIndex) const { return m_curvedArcs[arcIndex]; }
+
+	//snapshot functions
+	void WriteSnapshot(SnapshotWriter& writer) const;
+	bool ReadSnapshot(SnapshotReader& reader);
+
+	//determinism functions
+	uint64_t ComputeStateHash() const;
+	bool FindFirstDivergence(Map const& other, std::string& out_description) const;
+	void AppendStateDump(std::string& dump) const;
 
 //public member variables
 public:
 	MapDefinition const* m_definition = nullptr;
+	Game* m_game = nullptr;
 
 	std::vector<CubicBezierCurve2D> m_trackSpline;
+	std::vector<ArcLengthTable>		m_trackArcLengths;			//one per curve in m_trackSpline
+	std::vector<float>				m_trackCurveStartDistances;	//one per curve plus the total track length at the end
+	uint64_t m_trackGeneration = 0;	//unique across all maps, taken anew whenever the track tables change
+	float	 m_trackSplineLength = 0.0f;	//tessellated length for when arc-length tables are off, kept with the tables
 
 	std::vector<Bloon*>		 m_bloons;
+	std::vector<BloonSwarm>	 m_bloonSwarms;
 	std::vector<Tower*>		 m_towers;
-	std::vector<Projectile*> m_projectiles;
+	ProjectilePool			 m_projectiles;
+
+	std::vector<CurvedProjectileArc> m_curvedArcs;
+
+	uint64_t m_tickStateHash = 0;	//hash of everything above as of the end of the last Update
+
+	MapPhaseTimings* m_phaseTimings = nullptr;
+
+//private member functions
+private:
+	static double RecordPhaseTime(double& phaseSeconds, double phaseStartSeconds);
+	static uint64_t TakeTrackGeneration();
+	static float ComputeSplineTrackLength(std::vector<CubicBezierCurve2D> const& curves);
+
+	void  ProcessDueLeakChecks();
+	void  UpdateBloonSwarms(float deltaSeconds);
+	float GetSwarmMaterializeDistance();
+	void  WakeTowersForArrival(float trackDistance, float speed);
+	float GetSecondsUntilTrackCoverage(Tower const& tower, float trackDistance, float speed) const;
+	uint64_t ComputeSwarmHash() const;
+
+	void UpdateTowers(float deltaSeconds);
+	void BuildSleepArrivalList();
+	void TryToPutTowerToSleep(int towerIndex);
+	void RefreshTowerTrackCoverage(Tower& tower) const;
+
+	uint64_t ComputeTowerHash() const;
+	static uint64_t CombineEntityHash(uint64_t hash, int slotIndex, uint64_t entityHash);
+	static uint64_t CombineMapHash(uint64_t bloonHash, uint64_t towerHash, uint64_t projHash);
+
+//private member variables
+private:
+	//towers with nothing able to reach their range skip updating until the wheel or a spawn wakes them
+	double		m_simulationSeconds = 0.0;
+	TimingWheel m_towerWakeWheel = TimingWheel(TOWER_WAKE_SLOT_SECONDS, NUM_TOWER_WAKE_SLOTS);
+	std::vector<int> m_dueTowerIndexes;
+
+	//where every bloon and each swarm's front is, sorted, so a tower can look up what's on or behind its stretches without scanning them all
+	std::vector<float> m_sleepArrivalDistances;
+	float m_sleepArrivalMaxSpeed = 0.0f;
+	bool  m_isSleepArrivalListBuilt = false;
+
+	float m_soldTowerSwarmZoneStart = FLT_MAX;	//road items of sold towers stay on the track until the round ends
+
+	//min-heap of when each bloon could next have reached the end; an entry is stale once its bloon is gone or rescheduled
+	struct LeakCheck
+	{
+		double m_dueSeconds = 0.0;
+		int	   m_bloonSlot = -1;
+		Bloon const* m_bloon = nullptr;
+
+		bool operator>(LeakCheck const& other) const { return m_dueSeconds > other.m_dueSeconds; }
+	};
+
+	std::vector<LeakCheck> m_leakChecks;
+	std::vector<Bloon*>	   m_dueLeakCheckBloons;
+	int m_numLivesLeaked = 0;	//taken from the game at the point in the tick leaked bloons are removed
+
+	std::vector<std::pair<int, int>> m_restoredArcIndexes;	//(tower slot, or tower slot count + projectile slot; arc index) read before the arc table
 };
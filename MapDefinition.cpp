@@ -2,7 +2,6 @@
 #include "Game/GameCommon.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/Texture.hpp"
-#include "Engine/Math/CubicBezierCurve2D.hpp"
 
 
 std::vector<MapDefinition> MapDefinition::s_mapDefinitions;
@@ -16,7 +15,17 @@ MapDefinition::MapDefinition(XmlElement const& element)
 	m_name = ParseXmlAttribute(element, "name", m_name);
 
 	std::string textureFilePath = ParseXmlAttribute(element, "texture", "invalid path");
-	m_texture = g_theRenderer->CreateOrGetTextureFromFile(textureFilePath.c_str());
+	if (g_theRenderer != nullptr)
+	{
+		m_texture = g_theRenderer->CreateOrGetTextureFromFile(textureFilePath.c_str());
+	}
+
+	//a binary track, if given and still valid, replaces the <Spline> element entirely
+	std::string trackFilePath = ParseXmlAttribute(element, "trackFile", "");
+	if (!trackFilePath.empty() && m_track.ReadFromFile(trackFilePath))
+	{
+		return;
+	}
 
 	XmlElement const* splineElement = element.FirstChildElement();
 	std::string elementName;
@@ -38,12 +47,14 @@ MapDefinition::MapDefinition(XmlElement const& element)
 				Vec2 c = ParseXmlAttribute(*curveElement, "c", Vec2());
 				Vec2 d = ParseXmlAttribute(*curveElement, "d", Vec2());
 
-				m_trackSpline.emplace_back(CubicBezierCurve2D(a, b, c, d));
+				m_track.m_curves.emplace_back(CubicBezierCurve2D(a, b, c, d));
 			}
 
 			curveElement = curveElement->NextSiblingElement();
 		}
 	}
+
+	m_track.BuildArcLengths();
 }
 
 
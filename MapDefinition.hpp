@@ -1,9 +1,9 @@
 #pragma once
+#include "Game/TrackData.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 
 
-struct CubicBezierCurve2D;
-class  Texture;
+class Texture;
 
 
 class MapDefinition
@@ -22,7 +22,7 @@ public:
 
 	Texture* m_texture = nullptr;
 
-	std::vector<CubicBezierCurve2D> m_trackSpline;
+	TrackData m_track;
 
 	static std::vector<MapDefinition> s_mapDefinitions;
 };
@@ -0,0 +1,125 @@
+#include "Game/MappedFile.hpp"
+#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
+#include <windows.h>
+
+
+//
+//destructor
+//
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+
+//
+//public member functions
+//
+bool MappedFile::Open(std::string const& filePath)
+{
+	Close();
+
+	HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	m_fileHandle = fileHandle;
+
+	//empty files can't be mapped
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mappingHandle == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = static_cast<uint8_t const*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+
+bool MappedFile::OpenForWriting(std::string const& filePath, size_t minSize)
+{
+	Close();
+
+	HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	m_fileHandle = fileHandle;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize))
+	{
+		Close();
+		return false;
+	}
+
+	//mapping past the end extends the file with zeroes
+	if (static_cast<size_t>(fileSize.QuadPart) < minSize)
+	{
+		fileSize.QuadPart = static_cast<LONGLONG>(minSize);
+	}
+	if (fileSize.QuadPart <= 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE, fileSize.HighPart, fileSize.LowPart, nullptr);
+	if (m_mappingHandle == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = static_cast<uint8_t const*>(MapViewOfFile(m_mappingHandle, FILE_MAP_WRITE, 0, 0, 0));
+	if (m_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	m_isWritable = true;
+	return true;
+}
+
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+	}
+	if (m_mappingHandle != nullptr)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = nullptr;
+	}
+	if (m_fileHandle != nullptr)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = nullptr;
+	}
+
+	m_size = 0;
+	m_isWritable = false;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+//view of a whole file through the OS page cache, so large binary data can be used in place without a read-and-copy pass.
+//Writable views are shared with every other process mapping the same file
+class MappedFile
+{
+//public member functions
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(MappedFile const& copyFrom) = delete;
+	MappedFile& operator=(MappedFile const& copyFrom) = delete;
+
+	bool Open(std::string const& filePath);
+	bool OpenForWriting(std::string const& filePath, size_t minSize);	//creates the file or grows it to minSize, new bytes are zero
+	void Close();
+
+	bool		   IsOpen() const { return m_data != nullptr; }
+	uint8_t const* GetData() const { return m_data; }
+	uint8_t*	   GetWritableData() const { return m_isWritable ? const_cast<uint8_t*>(m_data) : nullptr; }
+	size_t		   GetSize() const { return m_size; }
+
+//private member variables
+private:
+	void*		   m_fileHandle = nullptr;
+	void*		   m_mappingHandle = nullptr;
+	uint8_t const* m_data = nullptr;
+	size_t		   m_size = 0;
+	bool		   m_isWritable = false;
+};
@@ -0,0 +1,231 @@
+#include "Game/ObservationGrid.hpp"
+#include "Game/Map.hpp"
+#include "Game/Bloon.hpp"
+#include "Game/BloonDefinition.hpp"
+#include "Game/Tower.hpp"
+#include "Game/TowerDefinition.hpp"
+#include "Game/GameCommon.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+
+//
+//local helper functions
+//
+//adds 1 to every float in [first, end), four at a time
+static void AddOneToSpan(float* row, int firstX, int endX)
+{
+	__m128 const ones = _mm_set1_ps(1.0f);
+	int x = firstX;
+	for (; x + 4 <= endX; x += 4)
+	{
+		_mm_storeu_ps(row + x, _mm_add_ps(_mm_loadu_ps(row + x), ones));
+	}
+	for (; x < endX; x++)
+	{
+		row[x] += 1.0f;
+	}
+}
+
+
+//
+//constructor
+//
+ObservationGrid::ObservationGrid(int width, int height)
+	: m_width(width)
+	, m_height(height)
+{
+	GUARANTEE_OR_DIE(width > 0 && height > 0, "Observation grids need a positive resolution!");
+
+	m_cellWidth = PLAYFIELD_SIZE_X / static_cast<float>(width);
+	m_cellHeight = SCREEN_CAMERA_SIZE_Y / static_cast<float>(height);
+	m_trackMask.resize(static_cast<size_t>(width) * height);
+}
+
+
+//
+//public member functions
+//
+void ObservationGrid::Rasterize(Map const& map, float* out_grid)
+{
+	int planeSize = m_width * m_height;
+	float* rbePlane = out_grid + static_cast<int>(GridChannel::BLOON_RBE) * planeSize;
+	float* frozenPlane = out_grid + static_cast<int>(GridChannel::FROZEN_BLOONS) * planeSize;
+	float* coveragePlane = out_grid + static_cast<int>(GridChannel::TOWER_COVERAGE) * planeSize;
+	float* trackPlane = out_grid + static_cast<int>(GridChannel::TRACK_MASK) * planeSize;
+
+	//the three entity planes are next to each other, so one clear covers them
+	memset(out_grid, 0, 3 * planeSize * sizeof(float));
+
+	//generations are unique across maps, so a restore that swaps in another map object is caught as well as an edit
+	if (map.m_trackGeneration != m_trackMaskGeneration)
+	{
+		RebuildTrackMask(map);
+		m_trackMaskGeneration = map.m_trackGeneration;
+	}
+	memcpy(trackPlane, m_trackMask.data(), planeSize * sizeof(float));
+
+	AddBloons(map, rbePlane, frozenPlane);
+	AddTowerCoverage(map, coveragePlane);
+}
+
+
+//
+//private member functions
+//
+//distance from four cell centers at a time to each track segment, only over the cells near that segment
+void ObservationGrid::RebuildTrackMask(Map const& map)
+{
+	std::fill(m_trackMask.begin(), m_trackMask.end(), 0.0f);
+
+	__m128 const ones = _mm_set1_ps(1.0f);
+	__m128 const zeros = _mm_setzero_ps();
+	__m128 const trackWidthSquared = _mm_set1_ps(TRACK_WIDTH * TRACK_WIDTH);
+	__m128 const cellOffsets = _mm_set_ps(3.5f * m_cellWidth, 2.5f * m_cellWidth, 1.5f * m_cellWidth, 0.5f * m_cellWidth);
+
+	for (int curveIndex = 0; curveIndex < map.m_trackArcLengths.size(); curveIndex++)
+	{
+		Vec2 const* points = map.m_trackArcLengths[curveIndex].m_points;
+		for (int segmentIndex = 0; segmentIndex < NUM_CURVE_SUBDIVISIONS; segmentIndex++)
+		{
+			Vec2 start = points[segmentIndex];
+			Vec2 segment = points[segmentIndex + 1] - start;
+			float segmentLengthSquared = segment.x * segment.x + segment.y * segment.y;
+			float inverseLengthSquared = segmentLengthSquared > 0.0f ? 1.0f / segmentLengthSquared : 0.0f;
+
+			float minX = (start.x < start.x + segment.x ? start.x : start.x + segment.x) - TRACK_WIDTH;
+			float maxX = (start.x > start.x + segment.x ? start.x : start.x + segment.x) + TRACK_WIDTH;
+			float minY = (start.y < start.y + segment.y ? start.y : start.y + segment.y) - TRACK_WIDTH;
+			float maxY = (start.y > start.y + segment.y ? start.y : start.y + segment.y) + TRACK_WIDTH;
+			int firstX = static_cast<int>(floorf(minX / m_cellWidth));
+			int endX = static_cast<int>(ceilf(maxX / m_cellWidth));
+			int firstY = static_cast<int>(floorf(minY / m_cellHeight));
+			int endY = static_cast<int>(ceilf(maxY / m_cellHeight));
+			firstX = firstX < 0 ? 0 : firstX;
+			firstY = firstY < 0 ? 0 : firstY;
+			endX = endX > m_width ? m_width : endX;
+			endY = endY > m_height ? m_height : endY;
+
+			__m128 startX = _mm_set1_ps(start.x);
+			__m128 segmentX = _mm_set1_ps(segment.x);
+			__m128 segmentY = _mm_set1_ps(segment.y);
+			__m128 inverseLength = _mm_set1_ps(inverseLengthSquared);
+			for (int y = firstY; y < endY; y++)
+			{
+				float* row = &m_trackMask[static_cast<size_t>(y) * m_width];
+				__m128 toCellY = _mm_set1_ps((static_cast<float>(y) + 0.5f) * m_cellHeight - start.y);
+
+				int x = firstX;
+				for (; x + 4 <= endX; x += 4)
+				{
+					__m128 toCellX = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(x) * m_cellWidth), cellOffsets), startX);
+					__m128 t = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(toCellX, segmentX), _mm_mul_ps(toCellY, segmentY)), inverseLength);
+					t = _mm_min_ps(_mm_max_ps(t, zeros), ones);
+					__m128 offsetX = _mm_sub_ps(toCellX, _mm_mul_ps(t, segmentX));
+					__m128 offsetY = _mm_sub_ps(toCellY, _mm_mul_ps(t, segmentY));
+					__m128 distanceSquared = _mm_add_ps(_mm_mul_ps(offsetX, offsetX), _mm_mul_ps(offsetY, offsetY));
+					__m128 isOnTrack = _mm_and_ps(_mm_cmple_ps(distanceSquared, trackWidthSquared), ones);
+					_mm_storeu_ps(row + x, _mm_max_ps(_mm_loadu_ps(row + x), isOnTrack));
+				}
+				for (; x < endX; x++)
+				{
+					Vec2 toCell = Vec2((static_cast<float>(x) + 0.5f) * m_cellWidth - start.x, (static_cast<float>(y) + 0.5f) * m_cellHeight - start.y);
+					float t = (toCell.x * segment.x + toCell.y * segment.y) * inverseLengthSquared;
+					t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+					Vec2 offset = toCell - segment * t;
+					if (offset.x * offset.x + offset.y * offset.y <= TRACK_WIDTH * TRACK_WIDTH)
+					{
+						row[x] = 1.0f;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+void ObservationGrid::AddBloons(Map const& map, float* rbePlane, float* frozenPlane) const
+{
+	for (int bloonIndex = 0; bloonIndex < map.m_bloons.size(); bloonIndex++)
+	{
+		Bloon const* bloon = map.m_bloons[bloonIndex];
+		if (bloon == nullptr || bloon->m_hasPopped || bloon->m_hasLeaked) continue;
+
+		int cellIndex = GetCellIndex(bloon->m_position.x, bloon->m_position.y);
+		if (cellIndex < 0) continue;
+
+		rbePlane[cellIndex] += static_cast<float>(bloon->m_definition->m_RBE);
+		if (bloon->m_freezeTimer > 0.0f)
+		{
+			frozenPlane[cellIndex] += 1.0f;
+		}
+	}
+
+	//swarm members are never frozen, and the ones still queued before the start aren't on the map yet
+	for (int swarmIndex = 0; swarmIndex < map.m_bloonSwarms.size(); swarmIndex++)
+	{
+		BloonSwarm const& swarm = map.m_bloonSwarms[swarmIndex];
+		float rbe = static_cast<float>(swarm.m_definition->m_RBE);
+		for (int memberIndex = swarm.m_firstMemberIndex; memberIndex < swarm.m_numMembers; memberIndex++)
+		{
+			float distance = swarm.GetMemberDistance(memberIndex);
+			if (distance < 0.0f) break;
+
+			Vec2 position = map.GetTrackPositionAtDistance(distance);
+			int cellIndex = GetCellIndex(position.x, position.y);
+			if (cellIndex >= 0)
+			{
+				rbePlane[cellIndex] += rbe;
+			}
+		}
+	}
+}
+
+
+//each tower's range is a disc, so every row it touches gets one contiguous span
+void ObservationGrid::AddTowerCoverage(Map const& map, float* coveragePlane) const
+{
+	for (int towerIndex = 0; towerIndex < map.m_towers.size(); towerIndex++)
+	{
+		Tower const* tower = map.m_towers[towerIndex];
+		if (tower == nullptr) continue;
+
+		Vec2 center = tower->m_position;
+		float range = tower->m_definition->m_range;
+		int firstY = static_cast<int>(ceilf((center.y - range) / m_cellHeight - 0.5f));
+		int endY = static_cast<int>(floorf((center.y + range) / m_cellHeight - 0.5f)) + 1;
+		firstY = firstY < 0 ? 0 : firstY;
+		endY = endY > m_height ? m_height : endY;
+
+		for (int y = firstY; y < endY; y++)
+		{
+			float offsetY = (static_cast<float>(y) + 0.5f) * m_cellHeight - center.y;
+			float halfSpanSquared = range * range - offsetY * offsetY;
+			if (halfSpanSquared < 0.0f) continue;
+
+			float halfSpan = sqrtf(halfSpanSquared);
+			int firstX = static_cast<int>(ceilf((center.x - halfSpan) / m_cellWidth - 0.5f));
+			int endX = static_cast<int>(floorf((center.x + halfSpan) / m_cellWidth - 0.5f)) + 1;
+			firstX = firstX < 0 ? 0 : firstX;
+			endX = endX > m_width ? m_width : endX;
+			if (firstX < endX)
+			{
+				AddOneToSpan(coveragePlane + static_cast<size_t>(y) * m_width, firstX, endX);
+			}
+		}
+	}
+}
+
+
+int ObservationGrid::GetCellIndex(float x, float y) const
+{
+	if (x < 0.0f || y < 0.0f) return -1;
+
+	int cellX = static_cast<int>(x / m_cellWidth);
+	int cellY = static_cast<int>(y / m_cellHeight);
+	if (cellX >= m_width || cellY >= m_height) return -1;
+
+	return cellY * m_width + cellX;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+
+class Map;
+
+
+//one w x h plane each, stored channel after channel, rows bottom to top, covering the playfield
+enum class GridChannel
+{
+	BLOON_RBE,			//RBE of the bloons whose centers fall in each cell, swarm members included
+	FROZEN_BLOONS,		//number of frozen bloons in each cell
+	TOWER_COVERAGE,		//number of towers whose range covers each cell's center
+	TRACK_MASK,			//1 where a cell's center is within the track's width of the track
+
+	NUM_GRID_CHANNELS
+};
+
+
+//rasterizes a map's state into fixed-size grids for agents and heatmaps. The track mask only changes when the track is
+//edited, so it's kept and rebuilt only when the map's track generation changes. Keeps per-map state, so use one per game
+//(or per worker) rather than sharing one between threads.
+class ObservationGrid
+{
+//public member functions
+public:
+	ObservationGrid(int width, int height);
+
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	int GetNumFloats() const { return static_cast<int>(GridChannel::NUM_GRID_CHANNELS) * m_width * m_height; }
+
+	void Rasterize(Map const& map, float* out_grid);	//fills GetNumFloats() floats
+
+//private member functions
+private:
+	void RebuildTrackMask(Map const& map);
+	void AddBloons(Map const& map, float* rbePlane, float* frozenPlane) const;
+	void AddTowerCoverage(Map const& map, float* coveragePlane) const;
+	int  GetCellIndex(float x, float y) const;	//-1 off the grid
+
+//private member variables
+private:
+	int	  m_width = 0;
+	int	  m_height = 0;
+	float m_cellWidth = 0.0f;
+	float m_cellHeight = 0.0f;
+
+	std::vector<float> m_trackMask;
+	uint64_t m_trackMaskGeneration = 0;	//generations start at 1, so a new grid always builds its mask
+};
@@ -0,0 +1,41 @@
+#include "Game/ProjectileBenchmark.hpp"
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+#include "Game/ProjectileDefinition.hpp"
+#include "Engine/Core/Time.hpp"
+
+
+ProjectileBenchmarkResult RunProjectileBenchmark(int mapIndex, ProjectileDefinition const* definition, int numProjectiles, int numTicks)
+{
+	ProjectileBenchmarkResult result;
+
+	std::vector<Game*> games = Game::CreateHeadlessGames(1);
+	Game* game = games[0];
+	game->OpenMap(mapIndex);
+	Map* map = game->m_currentMap;
+
+	//spread them over the playfield along a golden-angle spiral so they don't all share a few cache lines' worth of positions
+	float const deltaSeconds = 1.0f / 60.0f;
+	float addedLifespan = static_cast<float>(numTicks) * deltaSeconds + 1.0f;
+	Vec2 center = Vec2(PLAYFIELD_SIZE_X * 0.5f, SCREEN_CAMERA_SIZE_Y * 0.5f);
+	for (int projIndex = 0; projIndex < numProjectiles; projIndex++)
+	{
+		Vec2 direction = Vec2::MakeFromPolarDegrees(static_cast<float>(projIndex) * 137.508f);
+		float radius = SCREEN_CAMERA_SIZE_Y * 0.5f * static_cast<float>(projIndex % 1000) / 1000.0f;
+		map->SpawnProjectile(definition, center + direction * radius, direction, 0, addedLifespan);
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int tickIndex = 0; tickIndex < numTicks; tickIndex++)
+	{
+		map->Update(deltaSeconds);
+		result.m_numTicksRun++;
+	}
+	result.m_secondsElapsed = GetCurrentTimeSeconds() - startTime;
+
+	result.m_numProjectiles = map->m_projectiles.GetNumAlive();
+	result.m_numBytesAllocated = map->m_projectiles.GetNumBytesAllocated();
+
+	Game::DestroyHeadlessGames(games);
+	return result;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+
+
+class ProjectileDefinition;
+
+
+struct ProjectileBenchmarkResult
+{
+	int	   m_numProjectiles = 0;	//alive at the end of the run
+	int	   m_numTicksRun = 0;
+	double m_secondsElapsed = 0.0;
+	size_t m_numBytesAllocated = 0;	//everything the projectile pool holds, side tables included
+};
+
+
+//fills a headless game's map with straight projectiles that outlive the run and times its updates.
+//With no bloons on the map that is the projectile update, death checks and hashing alone.
+ProjectileBenchmarkResult RunProjectileBenchmark(int mapIndex, ProjectileDefinition const* definition, int numProjectiles, int numTicks);
@@ -14,10 +14,13 @@ ProjectileDefinition::ProjectileDefinition(XmlElement const& element)
 	m_name = ParseXmlAttribute(element, "name", m_name);
 
 	std::string textureFilePath = ParseXmlAttribute(element, "texture", "invalid path");
-	m_texture = g_theRenderer->CreateOrGetTextureFromFile(textureFilePath.c_str());
+	if (g_theRenderer != nullptr)
+	{
+		m_texture = g_theRenderer->CreateOrGetTextureFromFile(textureFilePath.c_str());
+	}
 
 	std::string spawnSoundFilePath = ParseXmlAttribute(element, "spawnSound", "invalid path");
-	if (spawnSoundFilePath != "invalid path")
+	if (spawnSoundFilePath != "invalid path" && g_theAudio != nullptr)
 	{
 		m_spawnSound = g_theAudio->CreateOrGetSound(spawnSoundFilePath);
 	}
@@ -0,0 +1,264 @@
+#include "Game/ProjectilePool.hpp"
+#include "Game/ProjectileDefinition.hpp"
+#include "Game/Bloon.hpp"
+#include "Game/Map.hpp"
+#include "Game/Game.hpp"
+#include "Game/StateHash.hpp"
+#include "Engine/Audio/AudioSystem.hpp"
+#include <algorithm>
+#include <functional>
+
+
+static_assert(PROJECTILE_HOT_BYTES <= PROJECTILE_HOT_BYTES_TARGET, "Per-tick projectile data grew past its budget");
+
+
+//
+//slot lifetime functions
+//
+int ProjectilePool::Spawn(Map& map, ProjectileDefinition const* definition, Vec2 const& position, Vec2 const& direction, int addedPierce, float addedLifespan, float addedSize,
+	float addedFreezeTime, int curvedArcIndex, int ownerTowerSlot)
+{
+	int slotIndex = AcquireSlot();
+
+	map.AddCurvedArcReference(curvedArcIndex);
+
+	m_positions[slotIndex] = position;
+	m_velocities[slotIndex] = direction * definition->m_speed;
+	m_remainingLifespans[slotIndex] = definition->m_lifespan + addedLifespan;
+	m_sizes[slotIndex] = definition->m_size + addedSize;
+	m_remainingPierces[slotIndex] = definition->m_pierce + addedPierce;
+	Restore(slotIndex, definition, PROJECTILE_FLAG_ALIVE);
+
+	ProjectileColdData& coldData = m_coldData[slotIndex];
+	coldData.m_addedFreezeTime = addedFreezeTime;
+	coldData.m_curvedArcIndex = curvedArcIndex;
+	coldData.m_curvedArcDistance = 0.0f;
+	coldData.m_directionDegrees = 0.0f;
+	coldData.m_ownerTowerSlot = ownerTowerSlot;
+	if (definition->m_curvedArc && curvedArcIndex != -1)
+	{
+		m_flags[slotIndex] |= PROJECTILE_FLAG_CURVED;
+	}
+
+	if (definition->m_spawnSound != 0)
+	{
+		map.m_game->PlaySound(definition->m_spawnSound);
+	}
+
+	return slotIndex;
+}
+
+
+void ProjectilePool::Free(Map& map, int slotIndex)
+{
+	map.ReleaseCurvedArc(m_coldData[slotIndex].m_curvedArcIndex);
+
+	m_flags[slotIndex] = 0;
+	m_coldData[slotIndex] = ProjectileColdData();
+	m_hitSets[slotIndex].clear();
+	m_numAlive--;
+
+	m_freeSlots.push_back(slotIndex);
+	std::push_heap(m_freeSlots.begin(), m_freeSlots.end(), std::greater<int>());
+}
+
+
+void ProjectilePool::ResetForRestore(int numSlots)
+{
+	m_positions.resize(numSlots);
+	m_velocities.resize(numSlots);
+	m_remainingLifespans.resize(numSlots);
+	m_sizes.resize(numSlots);
+	m_remainingPierces.resize(numSlots);
+	m_flags.assign(numSlots, 0);
+	m_coldData.assign(numSlots, ProjectileColdData());
+	m_hitSets.resize(numSlots);
+	for (int slotIndex = 0; slotIndex < numSlots; slotIndex++)
+	{
+		m_hitSets[slotIndex].clear();
+	}
+
+	m_freeSlots.clear();
+	m_numAlive = 0;
+}
+
+
+//sets the flags the definition implies on top of the given ones; the hot and cold values are the caller's to fill
+void ProjectilePool::Restore(int slotIndex, ProjectileDefinition const* definition, uint8_t flags)
+{
+	if ((m_flags[slotIndex] & PROJECTILE_FLAG_ALIVE) == 0)
+	{
+		m_numAlive++;
+	}
+
+	flags |= PROJECTILE_FLAG_ALIVE;
+	if (definition->m_isRoadItem)
+	{
+		flags |= PROJECTILE_FLAG_ROAD_ITEM;
+	}
+	m_flags[slotIndex] = flags;
+	m_coldData[slotIndex].m_definition = definition;
+}
+
+
+void ProjectilePool::RebuildFreeSlots()
+{
+	m_freeSlots.clear();
+	for (int slotIndex = 0; slotIndex < GetNumSlots(); slotIndex++)
+	{
+		if (!IsAlive(slotIndex))
+		{
+			m_freeSlots.push_back(slotIndex);
+		}
+	}
+	std::make_heap(m_freeSlots.begin(), m_freeSlots.end(), std::greater<int>());
+}
+
+
+//
+//game flow functions
+//
+void ProjectilePool::Update(Map const& map, float deltaSeconds)
+{
+	int numSlots = GetNumSlots();
+	for (int slotIndex = 0; slotIndex < numSlots; slotIndex++)
+	{
+		uint8_t flags = m_flags[slotIndex];
+		if ((flags & PROJECTILE_FLAG_ALIVE) == 0) continue;
+
+		//If curved arc, move in an arc back to the thrower
+		if ((flags & PROJECTILE_FLAG_CURVED) != 0)
+		{
+			UpdateCurved(map, slotIndex, deltaSeconds);
+			continue;
+		}
+
+		//move based on velocity
+		m_positions[slotIndex] += m_velocities[slotIndex] * deltaSeconds;
+
+		//reduce lifespan and die if lifespan runs out
+		m_remainingLifespans[slotIndex] -= deltaSeconds;
+		if (m_remainingLifespans[slotIndex] <= 0.0f && (flags & PROJECTILE_FLAG_ROAD_ITEM) == 0)
+		{
+			DieFromLifespan(slotIndex);
+		}
+	}
+}
+
+
+//
+//gameplay functions
+//
+void ProjectilePool::DeductPierce(int slotIndex)
+{
+	m_remainingPierces[slotIndex]--;
+	if (m_remainingPierces[slotIndex] <= 0)
+	{
+		m_flags[slotIndex] |= PROJECTILE_FLAG_OUT_OF_PIERCE;
+	}
+}
+
+
+bool ProjectilePool::HasHitBloon(int slotIndex, Bloon const* bloon) const
+{
+	std::vector<Bloon*> const& hitSet = m_hitSets[slotIndex];
+	for (int hitIndex = 0; hitIndex < hitSet.size(); hitIndex++)
+	{
+		if (hitSet[hitIndex] == bloon)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+//
+//accessors
+//
+size_t ProjectilePool::GetNumBytesAllocated() const
+{
+	size_t numBytes = m_positions.capacity() * sizeof(Vec2) + m_velocities.capacity() * sizeof(Vec2) + m_remainingLifespans.capacity() * sizeof(float) +
+		m_sizes.capacity() * sizeof(float) + m_remainingPierces.capacity() * sizeof(int) + m_flags.capacity() * sizeof(uint8_t) +
+		m_coldData.capacity() * sizeof(ProjectileColdData) + m_hitSets.capacity() * sizeof(std::vector<Bloon*>) + m_freeSlots.capacity() * sizeof(int);
+
+	for (int slotIndex = 0; slotIndex < m_hitSets.size(); slotIndex++)
+	{
+		numBytes += m_hitSets[slotIndex].capacity() * sizeof(Bloon*);
+	}
+
+	return numBytes;
+}
+
+
+//
+//determinism functions
+//
+uint64_t ProjectilePool::GetStateHash(int slotIndex) const
+{
+	uint64_t hash = STATE_HASH_SEED;
+	hash = HashWord(hash, static_cast<int>(GetDefinition(slotIndex) - ProjectileDefinition::s_projectileDefinitions.data()));
+	hash = HashWord(hash, m_positions[slotIndex]);
+	hash = HashWord(hash, m_remainingPierces[slotIndex]);
+	hash = HashWord(hash, m_remainingLifespans[slotIndex]);
+	hash = HashWord(hash, m_coldData[slotIndex].m_curvedArcDistance);
+	return hash;
+}
+
+
+std::string ProjectilePool::GetStateDescription(int slotIndex) const
+{
+	return Stringf("%s pos=(%.9g, %.9g) pierce=%i lifespan=%.9g arcDist=%.9g", GetDefinition(slotIndex)->m_name.c_str(), m_positions[slotIndex].x, m_positions[slotIndex].y,
+		m_remainingPierces[slotIndex], m_remainingLifespans[slotIndex], m_coldData[slotIndex].m_curvedArcDistance);
+}
+
+
+//
+//private member functions
+//
+void ProjectilePool::UpdateCurved(Map const& map, int slotIndex, float deltaSeconds)
+{
+	ProjectileColdData& coldData = m_coldData[slotIndex];
+	float speed = coldData.m_definition->m_speed;
+
+	CurvedProjectileArc const& arc = map.GetCurvedArc(coldData.m_curvedArcIndex);
+	bool useArcLengthTable = map.m_game->m_simConfig.m_useArcLengthTables;
+	float totalSplineDistance = useArcLengthTable ? arc.m_arcLengths.GetTotalLength() : arc.m_curve.GetApproximateLength(NUM_CURVE_SUBDIVISIONS);
+
+	coldData.m_curvedArcDistance += speed * deltaSeconds;
+
+	if (coldData.m_curvedArcDistance > totalSplineDistance)
+	{
+		DieFromLifespan(slotIndex);
+	}
+	else
+	{
+		m_positions[slotIndex] = useArcLengthTable ? arc.m_arcLengths.EvaluateAtDistance(coldData.m_curvedArcDistance) :
+			arc.m_curve.EvaluateAtApproximateDistance(coldData.m_curvedArcDistance, NUM_CURVE_SUBDIVISIONS);
+		coldData.m_directionDegrees += speed * deltaSeconds * 2.5f;
+	}
+}
+
+
+//the slot comes back with no flags set; Restore marks it alive
+int ProjectilePool::AcquireSlot()
+{
+	if (!m_freeSlots.empty())
+	{
+		std::pop_heap(m_freeSlots.begin(), m_freeSlots.end(), std::greater<int>());
+		int slotIndex = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		return slotIndex;
+	}
+
+	m_positions.emplace_back();
+	m_velocities.emplace_back();
+	m_remainingLifespans.emplace_back();
+	m_sizes.emplace_back();
+	m_remainingPierces.emplace_back();
+	m_flags.emplace_back(static_cast<uint8_t>(0));
+	m_coldData.emplace_back();
+	m_hitSets.emplace_back();
+	return GetNumSlots() - 1;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <cstdint>
+#include <vector>
+
+
+class ProjectileDefinition;
+class Bloon;
+class Map;
+
+
+//per-slot state bits
+constexpr uint8_t PROJECTILE_FLAG_ALIVE			  = 1 << 0;
+constexpr uint8_t PROJECTILE_FLAG_OUT_OF_LIFESPAN = 1 << 1;
+constexpr uint8_t PROJECTILE_FLAG_OUT_OF_PIERCE	  = 1 << 2;
+constexpr uint8_t PROJECTILE_FLAG_CURVED		  = 1 << 3;	//flies along a curved arc instead of by velocity
+constexpr uint8_t PROJECTILE_FLAG_ROAD_ITEM		  = 1 << 4;	//doesn't run out of lifespan
+
+//bytes every projectile costs in the arrays the per-tick loops stream through
+constexpr size_t PROJECTILE_HOT_BYTES = 2 * sizeof(Vec2) + 2 * sizeof(float) + sizeof(int) + sizeof(uint8_t);
+constexpr size_t PROJECTILE_HOT_BYTES_TARGET = 32;
+
+
+//data only read on a hit, on death, or by curved projectiles
+struct ProjectileColdData
+{
+	ProjectileDefinition const* m_definition = nullptr;
+	float m_addedFreezeTime = 0.0f;
+	int	  m_curvedArcIndex = -1;
+	float m_curvedArcDistance = 0.0f;
+	float m_directionDegrees = 0.0f;
+	int	  m_ownerTowerSlot = -1;	//for telemetry only; not saved or hashed, so restored projectiles credit no tower
+};
+
+
+//every projectile on a map, stored by slot in parallel arrays. What the update and collision loops touch
+//for every projectile each tick is packed into small contiguous arrays; definitions, arcs, freeze bonuses
+//and hit sets live in side tables indexed by the same slot. Freed slots are reused lowest first, the same
+//order the other entity vectors use, and hit set buffers are kept across reuse, so a steady stream of
+//projectiles stops allocating once the pool has grown to its peak.
+class ProjectilePool
+{
+//public member functions
+public:
+	//slot lifetime functions
+	int  Spawn(Map& map, ProjectileDefinition const* definition, Vec2 const& position, Vec2 const& direction, int addedPierce = 0, float addedLifespan = 0.0f,
+		float addedSize = 0.0f, float addedFreezeTime = 0.0f, int curvedArcIndex = -1, int ownerTowerSlot = -1);
+	void Free(Map& map, int slotIndex);
+	void ResetForRestore(int numSlots);	//every slot comes back empty; caller fills slots with Restore then calls RebuildFreeSlots
+	void Restore(int slotIndex, ProjectileDefinition const* definition, uint8_t flags);
+	void RebuildFreeSlots();
+
+	//game flow functions
+	void Update(Map const& map, float deltaSeconds);
+
+	//gameplay functions
+	void DeductPierce(int slotIndex);
+	void DieFromLifespan(int slotIndex) { m_flags[slotIndex] |= PROJECTILE_FLAG_OUT_OF_LIFESPAN; }
+	bool HasHitBloon(int slotIndex, Bloon const* bloon) const;
+	void AddHitBloon(int slotIndex, Bloon* bloon) { m_hitSets[slotIndex].emplace_back(bloon); }
+
+	//accessors
+	int  GetNumSlots() const { return static_cast<int>(m_flags.size()); }
+	int  GetNumAlive() const { return m_numAlive; }
+	bool IsAlive(int slotIndex) const { return (m_flags[slotIndex] & PROJECTILE_FLAG_ALIVE) != 0; }
+	bool IsDead(int slotIndex) const { return (m_flags[slotIndex] & (PROJECTILE_FLAG_OUT_OF_LIFESPAN | PROJECTILE_FLAG_OUT_OF_PIERCE)) != 0; }
+	bool IsOutOfPierce(int slotIndex) const { return (m_flags[slotIndex] & PROJECTILE_FLAG_OUT_OF_PIERCE) != 0; }
+	bool IsOutOfLifespan(int slotIndex) const { return (m_flags[slotIndex] & PROJECTILE_FLAG_OUT_OF_LIFESPAN) != 0; }
+	ProjectileDefinition const* GetDefinition(int slotIndex) const { return m_coldData[slotIndex].m_definition; }
+	size_t GetNumBytesAllocated() const;
+
+	//determinism functions
+	uint64_t	GetStateHash(int slotIndex) const;
+	std::string GetStateDescription(int slotIndex) const;
+
+//public member variables
+public:
+	//hot, PROJECTILE_HOT_BYTES per slot
+	std::vector<Vec2>	 m_positions;
+	std::vector<Vec2>	 m_velocities;
+	std::vector<float>	 m_remainingLifespans;
+	std::vector<float>	 m_sizes;
+	std::vector<int>	 m_remainingPierces;
+	std::vector<uint8_t> m_flags;
+
+	//cold side tables
+	std::vector<ProjectileColdData>	 m_coldData;
+	std::vector<std::vector<Bloon*>> m_hitSets;	//bloons each projectile passes over instead of hitting again
+
+//private member functions
+private:
+	void UpdateCurved(Map const& map, int slotIndex, float deltaSeconds);
+	int  AcquireSlot();
+
+//private member variables
+private:
+	std::vector<int> m_freeSlots;	//min-heap, so the lowest free slot is reused first
+	int m_numAlive = 0;
+};
@@ -0,0 +1,285 @@
+#include "Game/RenderSnapshot.hpp"
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+#include "Game/Bloon.hpp"
+#include "Game/BloonDefinition.hpp"
+#include "Game/Tower.hpp"
+#include "Game/TowerDefinition.hpp"
+#include "Game/ProjectilePool.hpp"
+#include "Game/ProjectileDefinition.hpp"
+#include "Game/AllocationCounter.hpp"
+#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Math/OBB2.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Renderer/BitmapFont.hpp"
+#include <cstdio>
+
+
+//
+//public member functions
+//
+void RenderSnapshot::Capture(Game const& game, RenderSnapshotOptions const& options)
+{
+	ScopedMemoryTag memoryTag(MemoryTag::RENDERING);
+
+	m_roundNumber = game.m_roundNumber;
+	m_numLives = game.m_numLives;
+	m_numMoney = game.m_numMoney;
+	m_isRoundActive = game.m_isRoundActive;
+	m_resetTimer = game.m_resetTimer;
+
+	for (int batchIndex = 0; batchIndex < m_numBatchesUsed; batchIndex++)
+	{
+		m_batches[batchIndex].m_verts.clear();
+	}
+	m_numBatchesUsed = 0;
+	m_layerStartBatchIndex = 0;
+
+	Map const* map = game.m_currentMap;
+	if (map == nullptr)
+	{
+		return;
+	}
+
+	AddVertsForBloons(game, *map, options.m_useBloonLOD);
+
+	//tower ranges
+	BeginLayer();
+	std::vector<Vertex_PCU>& rangeVerts = AcquireBatch(nullptr);
+	for (int towerIndex = 0; towerIndex < map->m_towers.size(); towerIndex++)
+	{
+		Tower const* tower = map->m_towers[towerIndex];
+
+		if (tower != nullptr && (options.m_showAllTowerRanges || towerIndex == options.m_selectedTowerSlot))
+		{
+			tower->AddVertsForRange(rangeVerts, Rgba8(255, 255, 255, 127));
+		}
+	}
+
+	//towers
+	BeginLayer();
+	for (int towerIndex = 0; towerIndex < map->m_towers.size(); towerIndex++)
+	{
+		Tower const* tower = map->m_towers[towerIndex];
+		if (tower == nullptr)
+		{
+			continue;
+		}
+
+		float size = tower->m_definition->m_size;
+		OBB2 renderBounds = OBB2(tower->m_position, tower->m_iBasis.GetRotated90Degrees(), Vec2(size, size));
+		AddVertsForOBB2D(AcquireBatch(tower->m_definition->m_texture), renderBounds);
+	}
+
+	//projectiles
+	BeginLayer();
+	ProjectilePool const& projectiles = map->m_projectiles;
+	for (int projIndex = 0; projIndex < projectiles.GetNumSlots(); projIndex++)
+	{
+		if (!projectiles.IsAlive(projIndex))
+		{
+			continue;
+		}
+
+		ProjectileColdData const& coldData = projectiles.m_coldData[projIndex];
+		float size = projectiles.m_sizes[projIndex];
+		Vec2 direction = projectiles.m_velocities[projIndex];
+		if (direction.GetLength() == 0.0f)
+		{
+			direction = Vec2(0.0f, -1.0f);
+		}
+		OBB2 renderBounds = OBB2(projectiles.m_positions[projIndex], direction.GetNormalized().GetRotated90Degrees().GetRotatedDegrees(coldData.m_directionDegrees), Vec2(size, size));
+		AddVertsForOBB2D(AcquireBatch(coldData.m_definition->m_texture), renderBounds);
+	}
+}
+
+
+void RenderSnapshot::Render() const
+{
+	for (int batchIndex = 0; batchIndex < m_numBatchesUsed; batchIndex++)
+	{
+		TexturedBatch const& batch = m_batches[batchIndex];
+		if (batch.m_verts.empty())
+		{
+			continue;
+		}
+
+		g_theRenderer->BindTexture(batch.m_texture);
+		g_theRenderer->DrawVertexArray(batch.m_verts);
+	}
+}
+
+
+//
+//private member functions
+//
+//swarm members are only positioned here, since the simulation never needs to know where they are
+void RenderSnapshot::GatherBloonSprites(Map const& map)
+{
+	m_bloonSprites.clear();
+
+	for (int bloonIndex = 0; bloonIndex < map.m_bloons.size(); bloonIndex++)
+	{
+		Bloon const* bloon = map.m_bloons[bloonIndex];
+		if (bloon == nullptr)
+		{
+			continue;
+		}
+
+		BloonSprite sprite;
+		sprite.m_definition = bloon->m_definition;
+		sprite.m_position = bloon->m_position;
+		sprite.m_trackDistance = bloon->m_trackDistance;
+		sprite.m_isFrozen = bloon->m_freezeTimer > 0.0f;
+		m_bloonSprites.emplace_back(sprite);
+	}
+
+	for (int swarmIndex = 0; swarmIndex < map.m_bloonSwarms.size(); swarmIndex++)
+	{
+		BloonSwarm const& swarm = map.m_bloonSwarms[swarmIndex];
+		for (int memberIndex = swarm.m_firstMemberIndex; memberIndex < swarm.m_numMembers; memberIndex++)
+		{
+			float trackDistance = swarm.GetMemberDistance(memberIndex);
+			if (trackDistance < 0.0f)
+			{
+				break;
+			}
+
+			BloonSprite sprite;
+			sprite.m_definition = swarm.m_definition;
+			sprite.m_position = map.GetTrackPositionAtDistance(trackDistance);
+			sprite.m_trackDistance = trackDistance;
+			m_bloonSprites.emplace_back(sprite);
+		}
+	}
+}
+
+
+void RenderSnapshot::AddVertsForBloons(Game const& game, Map const& map, bool useLOD)
+{
+	//bloons are drawn with the red texture except for lead and rainbow bloons, which are drawn on top
+	BloonDefinition const* redDef = BloonDefinition::GetBloonDefinitionByName("Red");
+	BloonDefinition const* leadDef = BloonDefinition::GetBloonDefinitionByName("Lead");
+	BloonDefinition const* rainbowDef = BloonDefinition::GetBloonDefinitionByName("Rainbow");
+
+	BeginLayer();
+	std::vector<Vertex_PCU>& bloonVerts = AcquireBatch(redDef->m_texture);
+	std::vector<Vertex_PCU>& leadVerts = AcquireBatch(leadDef->m_texture);
+	std::vector<Vertex_PCU>& rainbowVerts = AcquireBatch(rainbowDef->m_texture);
+
+	GatherBloonSprites(map);
+
+	//bin bloons into screen cells so dense cells can be drawn as one sprite
+	int const numCellsX = static_cast<int>(PLAYFIELD_SIZE_X / BLOON_LOD_CELL_SIZE) + 1;
+	int const numCellsY = static_cast<int>(SCREEN_CAMERA_SIZE_Y / BLOON_LOD_CELL_SIZE) + 1;
+	if (useLOD)
+	{
+		m_bloonCellCounts.assign(numCellsX * numCellsY, 0);
+		m_bloonCellLeaders.assign(numCellsX * numCellsY, -1);
+
+		for (int spriteIndex = 0; spriteIndex < m_bloonSprites.size(); spriteIndex++)
+		{
+			BloonSprite const& sprite = m_bloonSprites[spriteIndex];
+
+			int cellX = GetClamped(static_cast<int>(sprite.m_position.x / BLOON_LOD_CELL_SIZE), 0, numCellsX - 1);
+			int cellY = GetClamped(static_cast<int>(sprite.m_position.y / BLOON_LOD_CELL_SIZE), 0, numCellsY - 1);
+			int cellIndex = cellY * numCellsX + cellX;
+
+			m_bloonCellCounts[cellIndex]++;
+			int& leaderIndex = m_bloonCellLeaders[cellIndex];
+			if (leaderIndex == -1 || m_bloonSprites[leaderIndex].m_trackDistance < sprite.m_trackDistance)
+			{
+				leaderIndex = spriteIndex;
+			}
+		}
+	}
+
+	for (int spriteIndex = 0; spriteIndex < m_bloonSprites.size(); spriteIndex++)
+	{
+		BloonSprite const& sprite = m_bloonSprites[spriteIndex];
+
+		if (useLOD)
+		{
+			int cellX = GetClamped(static_cast<int>(sprite.m_position.x / BLOON_LOD_CELL_SIZE), 0, numCellsX - 1);
+			int cellY = GetClamped(static_cast<int>(sprite.m_position.y / BLOON_LOD_CELL_SIZE), 0, numCellsY - 1);
+			if (m_bloonCellCounts[cellY * numCellsX + cellX] > BLOON_LOD_DENSITY_THRESHOLD)
+			{
+				continue;
+			}
+		}
+
+		std::vector<Vertex_PCU>& verts = sprite.m_definition == leadDef ? leadVerts : (sprite.m_definition == rainbowDef ? rainbowVerts : bloonVerts);
+
+		float size = sprite.m_definition->m_size;
+		AABB2 renderBounds = AABB2(sprite.m_position.x - size, sprite.m_position.y - size, sprite.m_position.x + size, sprite.m_position.y + size);
+		AddVertsForAABB2(verts, renderBounds, sprite.m_definition->m_color);
+
+		if (sprite.m_isFrozen)
+		{
+			AddVertsForAABB2(verts, renderBounds, Rgba8(255, 255, 255, 150));
+		}
+	}
+
+	if (!useLOD)
+	{
+		return;
+	}
+
+	//one sprite per dense cell in the leading bloon's look, with the count on top
+	BeginLayer();
+	std::vector<Vertex_PCU>& countVerts = AcquireBatch(&game.m_menuFont->GetTexture());
+	for (int cellIndex = 0; cellIndex < m_bloonCellCounts.size(); cellIndex++)
+	{
+		int numBloons = m_bloonCellCounts[cellIndex];
+		if (numBloons <= BLOON_LOD_DENSITY_THRESHOLD)
+		{
+			continue;
+		}
+
+		BloonDefinition const* leaderDef = m_bloonSprites[m_bloonCellLeaders[cellIndex]].m_definition;
+		std::vector<Vertex_PCU>& verts = leaderDef == leadDef ? leadVerts : (leaderDef == rainbowDef ? rainbowVerts : bloonVerts);
+
+		Vec2 cellMins = Vec2(static_cast<float>(cellIndex % numCellsX), static_cast<float>(cellIndex / numCellsX)) * BLOON_LOD_CELL_SIZE;
+		AABB2 cellBounds = AABB2(cellMins, cellMins + Vec2(BLOON_LOD_CELL_SIZE, BLOON_LOD_CELL_SIZE));
+		Rgba8 const& bloonColor = leaderDef->m_color;
+		AddVertsForAABB2(verts, cellBounds, bloonColor);
+
+		bool isDarkBloon = static_cast<int>(bloonColor.r) + static_cast<int>(bloonColor.g) + static_cast<int>(bloonColor.b) < 384;
+		Rgba8 countColor = isDarkBloon ? Rgba8(255, 255, 255) : Rgba8(0, 0, 0);
+
+		char countText[16];
+		snprintf(countText, sizeof(countText), "%i", numBloons);
+		m_bloonCountText = countText;
+		game.m_menuFont->AddVertsForTextInBox2D(countVerts, cellBounds, BLOON_LOD_CELL_SIZE * 0.4f, m_bloonCountText, countColor, 0.6f);
+	}
+}
+
+
+//batches from earlier layers are never reused, so everything in a layer draws over everything in the layers before it
+void RenderSnapshot::BeginLayer()
+{
+	m_layerStartBatchIndex = m_numBatchesUsed;
+}
+
+
+std::vector<Vertex_PCU>& RenderSnapshot::AcquireBatch(Texture const* texture)
+{
+	for (int batchIndex = m_layerStartBatchIndex; batchIndex < m_numBatchesUsed; batchIndex++)
+	{
+		if (m_batches[batchIndex].m_texture == texture)
+		{
+			return m_batches[batchIndex].m_verts;
+		}
+	}
+
+	if (m_numBatchesUsed == m_batches.size())
+	{
+		m_batches.emplace_back();
+	}
+
+	TexturedBatch& batch = m_batches[m_numBatchesUsed];
+	batch.m_texture = texture;
+	m_numBatchesUsed++;
+	return batch.m_verts;
+}
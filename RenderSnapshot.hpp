@@ -0,0 +1,80 @@
+#pragma once
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <deque>
+#include <string>
+#include <vector>
+
+
+class Game;
+class Map;
+class BloonDefinition;
+class Texture;
+
+
+//bloon level of detail; cells holding more bloons than the threshold are drawn as one aggregate sprite with a count
+constexpr float BLOON_LOD_CELL_SIZE = 24.0f;
+constexpr int	BLOON_LOD_DENSITY_THRESHOLD = 6;
+
+
+//the main thread's view settings a capture depends on, copied when a step is queued so the simulation never reads UI state
+struct RenderSnapshotOptions
+{
+	int	 m_selectedTowerSlot = -1;	//a slot rather than a pointer, since the tower could be sold before the capture runs
+	bool m_showAllTowerRanges = false;
+	bool m_useBloonLOD = false;
+};
+
+
+//everything Game::Render needs from the simulation, built by the simulation at the end of a step so rendering never
+//touches live entities; Game keeps two of these and renders one while the simulation fills the other
+class RenderSnapshot
+{
+//public member functions
+public:
+	void Capture(Game const& game, RenderSnapshotOptions const& options);
+	void Render() const;
+
+//public member variables
+public:
+	int   m_roundNumber = 1;
+	int   m_numLives = 0;
+	int   m_numMoney = 0;
+	bool  m_isRoundActive = false;
+	float m_resetTimer = 0.0f;
+
+//private member functions
+private:
+	void GatherBloonSprites(Map const& map);
+	void AddVertsForBloons(Game const& game, Map const& map, bool useLOD);
+	void BeginLayer();
+	std::vector<Vertex_PCU>& AcquireBatch(Texture const* texture);
+
+//private member variables
+private:
+	struct TexturedBatch
+	{
+		Texture const*			m_texture = nullptr;
+		std::vector<Vertex_PCU> m_verts;
+	};
+
+	std::deque<TexturedBatch> m_batches;	//a deque so acquired batches stay put; slots past m_numBatchesUsed keep their capacity for the next capture
+	int m_numBatchesUsed = 0;
+	int m_layerStartBatchIndex = 0;
+
+	//individual bloons and the on-track members of swarms, gathered so both draw the same way
+	struct BloonSprite
+	{
+		BloonDefinition const* m_definition = nullptr;
+		Vec2  m_position = Vec2();
+		float m_trackDistance = 0.0f;
+		bool  m_isFrozen = false;
+	};
+
+	std::vector<BloonSprite> m_bloonSprites;
+
+	//bloon level of detail scratch, one entry per screen cell
+	std::vector<int> m_bloonCellCounts;
+	std::vector<int> m_bloonCellLeaders;	//sprite index of the furthest bloon along the track in each cell
+	std::string		 m_bloonCountText;
+};
@@ -0,0 +1,110 @@
+#include "Game/Replay.hpp"
+#include "Game/Game.hpp"
+#include "Game/Snapshot.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+
+
+//
+//public member functions
+//
+bool Replay::WriteToFile(std::string const& filePath) const
+{
+	std::vector<uint8_t> buffer;
+	buffer.reserve(m_initialSnapshot.size() + m_ticks.size() * sizeof(ReplayTick) + m_commands.size() * sizeof(GameCommand) + 64);
+
+	SnapshotWriter writer = SnapshotWriter(buffer);
+	writer.Write(REPLAY_MAGIC);
+	writer.Write(REPLAY_VERSION);
+
+	writer.Write(static_cast<uint32_t>(m_initialSnapshot.size()));
+	writer.WriteBytes(m_initialSnapshot.data(), m_initialSnapshot.size());
+
+	writer.Write(static_cast<uint32_t>(m_ticks.size()));
+	writer.WriteBytes(m_ticks.data(), m_ticks.size() * sizeof(ReplayTick));
+
+	writer.Write(static_cast<uint32_t>(m_commands.size()));
+	writer.WriteBytes(m_commands.data(), m_commands.size() * sizeof(GameCommand));
+	writer.Finish();
+
+	return FileWriteFromBuffer(buffer, filePath);
+}
+
+
+bool Replay::ReadFromFile(std::string const& filePath)
+{
+	std::vector<uint8_t> buffer;
+	FileReadToBuffer(buffer, filePath);
+	if (buffer.empty())
+	{
+		return false;
+	}
+
+	SnapshotReader reader = SnapshotReader(buffer.data(), buffer.size());
+	if (reader.Read<uint32_t>() != REPLAY_MAGIC || reader.Read<uint32_t>() != REPLAY_VERSION)
+	{
+		return false;
+	}
+
+	m_initialSnapshot.resize(reader.Read<uint32_t>());
+	reader.ReadBytes(m_initialSnapshot.data(), m_initialSnapshot.size());
+
+	m_ticks.resize(reader.Read<uint32_t>());
+	reader.ReadBytes(m_ticks.data(), m_ticks.size() * sizeof(ReplayTick));
+
+	m_commands.resize(reader.Read<uint32_t>());
+	reader.ReadBytes(m_commands.data(), m_commands.size() * sizeof(GameCommand));
+
+	return reader.IsValid() && reader.IsAtEnd();
+}
+
+
+//commands stamped with a tick happened after the previous step and before this one
+void Replay::ApplyCommandsForTick(Game& game, uint32_t tickIndex, int& commandIndex) const
+{
+	while (commandIndex < m_commands.size() && m_commands[commandIndex].m_tick == tickIndex)
+	{
+		game.ExecuteCommand(m_commands[commandIndex]);
+		commandIndex++;
+	}
+}
+
+
+ReplayVerification Replay::RunHeadless() const
+{
+	ReplayVerification result;
+
+	std::vector<Game*> games = Game::CreateHeadlessGames(1);
+	Game* game = games[0];
+	if (!game->ReadSnapshot(m_initialSnapshot))
+	{
+		result.m_succeeded = false;
+		Game::DestroyHeadlessGames(games);
+		return result;
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+
+	int commandIndex = 0;
+	for (uint32_t tickIndex = 0; tickIndex < m_ticks.size(); tickIndex++)
+	{
+		ApplyCommandsForTick(*game, tickIndex, commandIndex);
+		game->UpdateSimulation(m_ticks[tickIndex].m_deltaSeconds);
+		result.m_numTicksRun++;
+
+		uint64_t stateHash = game->GetTickStateHash();
+		if (stateHash != m_ticks[tickIndex].m_stateHash)
+		{
+			result.m_succeeded = false;
+			result.m_firstMismatchTick = tickIndex;
+			result.m_expectedHash = m_ticks[tickIndex].m_stateHash;
+			result.m_actualHash = stateHash;
+			break;
+		}
+	}
+
+	result.m_secondsElapsed = GetCurrentTimeSeconds() - startTime;
+
+	Game::DestroyHeadlessGames(games);
+	return result;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+
+
+class Game;
+
+
+constexpr uint32_t REPLAY_MAGIC = 0x50525442;	//"BTRP"
+constexpr uint32_t REPLAY_VERSION = 3;
+
+
+enum class GameCommandType : uint8_t
+{
+	PLACE_TOWER,			//index = tower definition, position = placement
+	SELL_TOWER,				//index = tower slot
+	BUY_UPGRADE_1,			//index = tower slot
+	BUY_UPGRADE_2,			//index = tower slot
+	TOGGLE_TARGETING_MODE,	//index = tower slot
+	START_ROUND,
+	SPAWN_BLOON,			//index = bloon definition
+	CLEAR_BLOONS,
+	ADD_MONEY,				//index = amount
+	ENTER_FREEPLAY,			//index = seed, position.x = round to skip ahead to
+	SPAWN_BLOONS,			//index = bloon definition, position = (count, track spacing)
+
+	NUM_COMMAND_TYPES
+};
+
+
+//every player action that changes simulation state goes through one of these
+struct GameCommand
+{
+	uint32_t		m_tick = 0;
+	GameCommandType m_type = GameCommandType::START_ROUND;
+	int				m_index = -1;
+	Vec2			m_position = Vec2();
+};
+
+
+struct ReplayTick
+{
+	float	 m_deltaSeconds = 0.0f;
+	uint64_t m_stateHash = 0;
+};
+
+
+struct ReplayVerification
+{
+	bool	 m_succeeded = true;
+	uint32_t m_numTicksRun = 0;
+	uint32_t m_firstMismatchTick = 0;
+	uint64_t m_expectedHash = 0;
+	uint64_t m_actualHash = 0;
+	double	 m_secondsElapsed = 0.0;
+};
+
+
+class Replay
+{
+//public member functions
+public:
+	bool WriteToFile(std::string const& filePath) const;
+	bool ReadFromFile(std::string const& filePath);
+
+	void ApplyCommandsForTick(Game& game, uint32_t tickIndex, int& commandIndex) const;
+	ReplayVerification RunHeadless() const;
+
+//public member variables
+public:
+	std::vector<uint8_t>	 m_initialSnapshot;
+	std::vector<ReplayTick>  m_ticks;
+	std::vector<GameCommand> m_commands;
+};
@@ -1,8 +1,12 @@
 #include "Game/RoundDefinition.hpp"
 #include "Game/BloonDefinition.hpp"
+#include "Game/StateHash.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <algorithm>
 
 
 std::vector<RoundDefinition> RoundDefinition::s_roundDefinitions;
+std::vector<BloonDefinition const*> RoundDefinition::s_freeplayBloonDefs;
 
 
 //
@@ -60,6 +64,14 @@ void RoundDefinition::InitializeRoundDefinitions()
 		s_roundDefinitions.emplace_back(newRoundDef);
 		roundDefElement = roundDefElement->NextSiblingElement();
 	}
+
+	//freeplay unlocks stronger bloons as rounds go on, so it wants them ordered by how much they take to pop
+	s_freeplayBloonDefs.clear();
+	for (int bloonDefIndex = 0; bloonDefIndex < BloonDefinition::s_bloonDefinitions.size(); bloonDefIndex++)
+	{
+		s_freeplayBloonDefs.emplace_back(&BloonDefinition::s_bloonDefinitions[bloonDefIndex]);
+	}
+	std::stable_sort(s_freeplayBloonDefs.begin(), s_freeplayBloonDefs.end(), [](BloonDefinition const* a, BloonDefinition const* b) { return a->m_RBE < b->m_RBE; });
 }
 
 
@@ -69,3 +81,63 @@ RoundDefinition const* RoundDefinition::GetRoundDefinitionByIndex(unsigned int i
 
 	return &s_roundDefinitions[index];
 }
+
+
+//
+//freeplay constructor
+//
+FreeplayRound::FreeplayRound(uint32_t seed, int roundNumber)
+	: m_seed(seed)
+	, m_roundNumber(roundNumber)
+{
+	//counts and spacing only depend on how far past the authored rounds we are; the seed picks the mix
+	int freeplayLevel = roundNumber - static_cast<int>(RoundDefinition::s_roundDefinitions.size());
+	if (freeplayLevel < 1)
+	{
+		freeplayLevel = 1;
+	}
+	float level = static_cast<float>(freeplayLevel);
+
+	int numBloons = 40 + static_cast<int>(20.0f * powf(level, 1.7f));
+	m_numWaves = 4 + freeplayLevel / 2;
+	m_numBloonsPerWave = (numBloons + m_numWaves - 1) / m_numWaves;
+	m_timeBetweenSpawns = GetClamped(0.5f / (1.0f + 0.1f * level), 0.01f, 0.5f);
+
+	int numBloonDefs = static_cast<int>(RoundDefinition::s_freeplayBloonDefs.size());
+	m_numEligibleBloonDefs = GetClamped(2 + freeplayLevel / 4, 1, numBloonDefs);
+}
+
+
+//
+//freeplay functions
+//
+bool FreeplayRound::IsFreeplayRound(int roundNumber)
+{
+	return roundNumber > static_cast<int>(RoundDefinition::s_roundDefinitions.size());
+}
+
+
+Wave FreeplayRound::GetWave(int waveIndex) const
+{
+	Wave wave;
+	if (waveIndex < 0 || waveIndex >= m_numWaves || m_numEligibleBloonDefs <= 0) return wave;
+
+	uint64_t hash = STATE_HASH_SEED;
+	hash = HashWord(hash, m_seed);
+	hash = HashWord(hash, m_roundNumber);
+	hash = HashWord(hash, waveIndex);
+
+	//lean toward the strongest bloons unlocked so far, with the odd weaker wave mixed in
+	int numChoices = m_numEligibleBloonDefs < 3 ? m_numEligibleBloonDefs : 3;
+	int bloonDefIndex = m_numEligibleBloonDefs - 1 - static_cast<int>(hash % static_cast<uint64_t>(numChoices));
+	if ((hash >> 32) % 5 == 0)
+	{
+		bloonDefIndex = static_cast<int>((hash >> 40) % static_cast<uint64_t>(m_numEligibleBloonDefs));
+	}
+
+	wave.m_bloonDef = RoundDefinition::s_freeplayBloonDefs[bloonDefIndex];
+	wave.m_numBloons = m_numBloonsPerWave;
+	wave.m_timeBetweenSpawns = m_timeBetweenSpawns;
+	wave.m_timeToStart = waveIndex < NUM_FREEPLAY_LANES ? FREEPLAY_WAVE_GAP_SECONDS * static_cast<float>(waveIndex) : FREEPLAY_WAVE_GAP_SECONDS;
+	return wave;
+}
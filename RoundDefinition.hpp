@@ -5,6 +5,10 @@
 class BloonDefinition;
 
 
+constexpr int	NUM_FREEPLAY_LANES = 4;				//waves of a freeplay round that spawn at once
+constexpr float FREEPLAY_WAVE_GAP_SECONDS = 0.75f;	//pause before a lane starts its next wave
+
+
 struct Wave
 {
 	BloonDefinition const* m_bloonDef = nullptr;
@@ -30,4 +34,30 @@ public:
 	std::vector<Wave> m_waves;
 
 	static std::vector<RoundDefinition> s_roundDefinitions;
+	static std::vector<BloonDefinition const*> s_freeplayBloonDefs;	//weakest to strongest by RBE
+};
+
+
+//an endless round past the authored ones; every wave is derived from the seed on demand, so a round of any size costs the same memory
+class FreeplayRound
+{
+//public member functions
+public:
+	FreeplayRound() = default;
+	FreeplayRound(uint32_t seed, int roundNumber);
+
+	static bool IsFreeplayRound(int roundNumber);
+
+	int  GetNumWaves() const { return m_numWaves; }
+	int  GetNumBloons() const { return m_numWaves * m_numBloonsPerWave; }
+	Wave GetWave(int waveIndex) const;
+
+//private member variables
+private:
+	uint32_t m_seed = 0;
+	int		 m_roundNumber = 0;
+	int		 m_numWaves = 0;
+	int		 m_numBloonsPerWave = 0;
+	int		 m_numEligibleBloonDefs = 0;
+	float	 m_timeBetweenSpawns = 0.0f;
 };
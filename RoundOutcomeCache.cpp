@@ -0,0 +1,184 @@
+#include "Game/RoundOutcomeCache.hpp"
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+#include "Game/StateHash.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <cstring>
+#include <thread>
+
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free, "Cache entries are shared between processes, so they need lock-free atomics!");
+
+
+//everything the definitions are loaded from; cached outcomes are only valid for the data they were simulated with
+static char const* const s_definitionFilePaths[] =
+{
+	"Data/Definitions/BloonDefinitions.xml",
+	"Data/Definitions/ProjectileDefinitions.xml",
+	"Data/Definitions/TowerDefinitions.xml",
+	"Data/Definitions/MapDefinitions.xml",
+	"Data/Definitions/RoundDefinitions.xml",
+};
+
+
+//
+//public member functions
+//
+bool RoundOutcomeCache::Open(std::string const& filePath, uint32_t numEntries, uint64_t numDataBytes)
+{
+	Close();
+
+	//a power of two so probing can mask instead of mod
+	uint32_t entryCount = 1;
+	while (entryCount < numEntries)
+	{
+		entryCount <<= 1;
+	}
+
+	if (!m_file.OpenForWriting(filePath, sizeof(Header) + static_cast<size_t>(entryCount) * sizeof(Entry) + static_cast<size_t>(numDataBytes)))
+	{
+		return false;
+	}
+
+	//a new file is all zeroes, and only the process that swaps the magic away from zero writes its header; anyone else
+	//opening it meanwhile waits for the real magic. An existing file keeps its own sizes, and is only trusted if it was
+	//made by this version
+	Header* header = reinterpret_cast<Header*>(m_file.GetWritableData());
+	uint32_t magic = 0;
+	if (header->m_magic.compare_exchange_strong(magic, ROUND_CACHE_MAGIC_CREATING, std::memory_order_acq_rel))
+	{
+		header->m_numEntries = entryCount;
+		header->m_numDataBytes = numDataBytes;
+		header->m_version = ROUND_CACHE_VERSION;
+		header->m_magic.store(ROUND_CACHE_MAGIC, std::memory_order_release);
+		magic = ROUND_CACHE_MAGIC;
+	}
+	double waitStartTime = GetCurrentTimeSeconds();
+	while (magic == ROUND_CACHE_MAGIC_CREATING && GetCurrentTimeSeconds() - waitStartTime < ROUND_CACHE_MAX_CREATE_WAIT_SECONDS)
+	{
+		std::this_thread::yield();
+		magic = header->m_magic.load(std::memory_order_acquire);
+	}
+
+	uint32_t fileEntryCount = header->m_numEntries;
+	bool isPowerOfTwo = fileEntryCount != 0 && (fileEntryCount & (fileEntryCount - 1)) == 0;
+	if (magic != ROUND_CACHE_MAGIC || header->m_version != ROUND_CACHE_VERSION || !isPowerOfTwo ||
+		m_file.GetSize() < sizeof(Header) + static_cast<size_t>(fileEntryCount) * sizeof(Entry) + static_cast<size_t>(header->m_numDataBytes))
+	{
+		m_file.Close();
+		return false;
+	}
+
+	m_header = header;
+	m_entries = reinterpret_cast<Entry*>(m_file.GetWritableData() + sizeof(Header));
+	m_data = reinterpret_cast<uint8_t*>(m_entries + fileEntryCount);
+	m_entryMask = fileEntryCount - 1;
+	m_definitionsFingerprint = ComputeDefinitionsFingerprint();
+	return true;
+}
+
+
+void RoundOutcomeCache::Close()
+{
+	m_file.Close();
+	m_header = nullptr;
+	m_entries = nullptr;
+	m_data = nullptr;
+	m_entryMask = 0;
+}
+
+
+bool RoundOutcomeCache::Find(uint64_t roundStartKey, std::vector<uint8_t>& out_endSnapshot) const
+{
+	if (m_entries == nullptr || roundStartKey == 0) return false;
+
+	for (int probeIndex = 0; probeIndex < MAX_ROUND_CACHE_PROBES; probeIndex++)
+	{
+		Entry const& entry = m_entries[(roundStartKey + static_cast<uint64_t>(probeIndex)) & m_entryMask];
+		uint64_t entryKey = entry.m_roundStartKey.load(std::memory_order_acquire);
+		if (entryKey == 0) break;
+
+		if (entryKey == roundStartKey)
+		{
+			//claimed but still being written counts as a miss; whoever claimed it is simulating the same round
+			//one claimed when the data region was full never gets an outcome either
+			if (entry.m_isWritten.load(std::memory_order_acquire) != ENTRY_WRITTEN) break;
+
+			//the file is shared, so don't trust its offsets any more than the snapshot's own contents
+			if (entry.m_snapshotOffset > m_header->m_numDataBytes || entry.m_snapshotSize > m_header->m_numDataBytes - entry.m_snapshotOffset) break;
+
+			out_endSnapshot.assign(m_data + entry.m_snapshotOffset, m_data + entry.m_snapshotOffset + entry.m_snapshotSize);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+//gives up quietly when the data region or the neighbourhood is full; the cache is only ever an optimization
+void RoundOutcomeCache::Store(uint64_t roundStartKey, std::vector<uint8_t> const& endSnapshot)
+{
+	if (m_entries == nullptr || roundStartKey == 0 || endSnapshot.empty()) return;
+
+	//bytes are only reserved by whoever won the entry, so losing the race never wastes data space
+	for (int probeIndex = 0; probeIndex < MAX_ROUND_CACHE_PROBES; probeIndex++)
+	{
+		Entry& entry = m_entries[(roundStartKey + static_cast<uint64_t>(probeIndex)) & m_entryMask];
+		uint64_t expectedKey = 0;
+		if (entry.m_roundStartKey.compare_exchange_strong(expectedKey, roundStartKey, std::memory_order_acq_rel))
+		{
+			uint64_t snapshotSize = endSnapshot.size();
+			uint64_t snapshotOffset = m_header->m_numDataBytesUsed.fetch_add(snapshotSize, std::memory_order_relaxed);
+			if (snapshotOffset > m_header->m_numDataBytes || snapshotSize > m_header->m_numDataBytes - snapshotOffset)
+			{
+				entry.m_isWritten.store(ENTRY_NO_DATA, std::memory_order_release);
+				return;
+			}
+
+			memcpy(m_data + snapshotOffset, endSnapshot.data(), endSnapshot.size());
+			entry.m_snapshotOffset = snapshotOffset;
+			entry.m_snapshotSize = static_cast<uint32_t>(snapshotSize);
+			entry.m_isWritten.store(ENTRY_WRITTEN, std::memory_order_release);
+			return;
+		}
+		if (expectedKey == roundStartKey) return;
+	}
+}
+
+
+uint64_t RoundOutcomeCache::ComputeRoundStartKey(Game const& game, std::vector<uint8_t> const& startSnapshot, float deltaSeconds) const
+{
+	if (game.m_currentMap == nullptr || game.m_isRoundActive || game.m_resetTimer > 0.0f || startSnapshot.empty()) return 0;
+
+	uint64_t key = STATE_HASH_SEED;
+	key = HashWord(key, ROUND_CACHE_VERSION);
+	key = HashCombine(key, m_definitionsFingerprint);
+	key = HashWord(key, game.m_simConfig.m_useArcLengthTables);
+	key = HashWord(key, game.m_simConfig.m_useTowerSleep);
+	key = HashWord(key, game.m_simConfig.m_useBloonSwarms);
+	key = HashWord(key, deltaSeconds);
+	key = HashBytes(key, startSnapshot.data(), startSnapshot.size());
+
+	//zero marks an empty slot
+	return key != 0 ? key : 1;
+}
+
+
+//
+//private member functions
+//
+uint64_t RoundOutcomeCache::ComputeDefinitionsFingerprint()
+{
+	uint64_t fingerprint = STATE_HASH_SEED;
+	std::vector<uint8_t> fileBytes;
+	for (int fileIndex = 0; fileIndex < sizeof(s_definitionFilePaths) / sizeof(s_definitionFilePaths[0]); fileIndex++)
+	{
+		fileBytes.clear();
+		int numBytesRead = FileReadToBuffer(fileBytes, s_definitionFilePaths[fileIndex]);
+		fingerprint = HashWord(fingerprint, numBytesRead);
+		fingerprint = HashBytes(fingerprint, fileBytes.data(), fileBytes.size());
+	}
+	return fingerprint;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "Game/MappedFile.hpp"
+#include <atomic>
+#include <vector>
+
+
+class Game;
+
+
+constexpr uint32_t ROUND_CACHE_MAGIC = 0x43524F42;	//"BORC"
+constexpr uint32_t ROUND_CACHE_MAGIC_CREATING = 0x3F524F42;	//"BOR?", while the process that claimed a new file fills in its header
+constexpr double   ROUND_CACHE_MAX_CREATE_WAIT_SECONDS = 1.0;
+constexpr uint32_t ROUND_CACHE_VERSION = 2;
+constexpr uint32_t DEFAULT_ROUND_CACHE_ENTRIES = 1 << 16;
+constexpr uint64_t DEFAULT_ROUND_CACHE_DATA_BYTES = 128ull << 20;
+constexpr int	   MAX_ROUND_CACHE_PROBES = 32;
+
+
+//memory-mapped open addressing table from the state a round starts in to the full snapshot of the state it ends in.
+//The key hashes the round-start snapshot's bytes along with the simulation config, the definition files and the tick
+//length, so anything that could change the round changes the key; the outcome is restored whole, towers, projectiles in
+//flight and all, so a hit leaves the game exactly where simulating would have. Several processes can share one file: a
+//new file's header is published by whichever process swaps the magic in from zero. An entry is claimed by swapping its key
+//in from zero, then its snapshot's bytes are bump-allocated from a shared data region, and it's only read back once marked
+//written. A full data region just stops storing.
+class RoundOutcomeCache
+{
+//public member functions
+public:
+	bool Open(std::string const& filePath, uint32_t numEntries = DEFAULT_ROUND_CACHE_ENTRIES, uint64_t numDataBytes = DEFAULT_ROUND_CACHE_DATA_BYTES);
+	void Close();
+	bool IsOpen() const { return m_entries != nullptr; }
+
+	bool Find(uint64_t roundStartKey, std::vector<uint8_t>& out_endSnapshot) const;
+	void Store(uint64_t roundStartKey, std::vector<uint8_t> const& endSnapshot);
+
+	//0 when the game isn't cleanly between rounds; startSnapshot is the game's own WriteSnapshot output
+	uint64_t ComputeRoundStartKey(Game const& game, std::vector<uint8_t> const& startSnapshot, float deltaSeconds) const;
+
+//private member types
+private:
+	struct Header
+	{
+		std::atomic<uint32_t> m_magic;
+		uint32_t m_version = 0;
+		uint32_t m_numEntries = 0;
+		uint32_t m_padding = 0;
+		uint64_t m_numDataBytes = 0;
+		std::atomic<uint64_t> m_numDataBytesUsed;
+	};
+
+	struct Entry
+	{
+		std::atomic<uint64_t> m_roundStartKey;
+		std::atomic<uint32_t> m_isWritten;		//ENTRY_WRITTEN once readable, ENTRY_NO_DATA if the data region was full
+		uint32_t			  m_snapshotSize;
+		uint64_t			  m_snapshotOffset;		//from the start of the data region
+	};
+
+	static constexpr uint32_t ENTRY_WRITTEN = 1;
+	static constexpr uint32_t ENTRY_NO_DATA = 2;
+
+//private member functions
+private:
+	static uint64_t ComputeDefinitionsFingerprint();
+
+//private member variables
+private:
+	MappedFile m_file;
+	Header*	   m_header = nullptr;
+	Entry*	   m_entries = nullptr;
+	uint8_t*   m_data = nullptr;
+	uint32_t   m_entryMask = 0;
+	uint64_t   m_definitionsFingerprint = 0;
+};
@@ -0,0 +1,247 @@
+#include "Game/RoundTelemetry.hpp"
+#include "Game/Map.hpp"
+#include "Game/Tower.hpp"
+#include "Game/TowerDefinition.hpp"
+#include "Game/BloonDefinition.hpp"
+#include "Game/WorkerPool.hpp"
+#include "Engine/Core/FileUtils.hpp"
+
+
+static int GetBloonDefinitionIndex(BloonDefinition const* bloonDef)
+{
+	return static_cast<int>(bloonDef - BloonDefinition::s_bloonDefinitions.data());
+}
+
+
+static uint32_t TakeCount(std::atomic<uint32_t>& counter)
+{
+	return counter.exchange(0, std::memory_order_relaxed);
+}
+
+
+//
+//constructor and destructor
+//
+RoundTelemetry::RoundTelemetry(std::string const& runName, TelemetryFormat format)
+	: m_runName(runName)
+	, m_format(format)
+	, m_bloonCounters(BloonDefinition::s_bloonDefinitions.size())
+{
+	m_writer = new WorkerPool(1);
+}
+
+
+RoundTelemetry::~RoundTelemetry()
+{
+	delete m_writer;
+}
+
+
+//
+//public counting functions
+//
+void RoundTelemetry::CountProjectileFired(int towerSlot)
+{
+	if (towerSlot < 0 || towerSlot >= m_towerCounters.size()) return;
+
+	m_towerCounters[towerSlot].m_numProjectilesFired.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void RoundTelemetry::CountHit(int towerSlot, BloonDefinition const* bloonDef, int damage)
+{
+	uint32_t damageDealt = damage > 0 ? static_cast<uint32_t>(damage) : 0;
+	m_bloonCounters[GetBloonDefinitionIndex(bloonDef)].m_damageTaken.fetch_add(damageDealt, std::memory_order_relaxed);
+
+	if (towerSlot < 0 || towerSlot >= m_towerCounters.size()) return;
+
+	TowerTelemetryCounters& counters = m_towerCounters[towerSlot];
+	counters.m_damageDealt.fetch_add(damageDealt, std::memory_order_relaxed);
+	counters.m_pierceUsed.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void RoundTelemetry::CountPop(int towerSlot, BloonDefinition const* bloonDef)
+{
+	m_bloonCounters[GetBloonDefinitionIndex(bloonDef)].m_numPopped.fetch_add(1, std::memory_order_relaxed);
+
+	if (towerSlot < 0 || towerSlot >= m_towerCounters.size()) return;
+
+	m_towerCounters[towerSlot].m_numPops.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void RoundTelemetry::CountLeaks(BloonDefinition const* bloonDef, int numLeaked)
+{
+	if (numLeaked <= 0) return;
+
+	BloonTelemetryCounters& counters = m_bloonCounters[GetBloonDefinitionIndex(bloonDef)];
+	counters.m_numLeaked.fetch_add(static_cast<uint32_t>(numLeaked), std::memory_order_relaxed);
+	counters.m_leakedRBE.fetch_add(static_cast<uint32_t>(numLeaked * bloonDef->m_RBE), std::memory_order_relaxed);
+}
+
+
+//
+//public bookkeeping functions
+//
+void RoundTelemetry::EnsureTowerSlots(int numTowerSlots)
+{
+	while (m_towerCounters.size() < numTowerSlots)
+	{
+		m_towerCounters.emplace_back();
+	}
+}
+
+
+void RoundTelemetry::RetireTower(Map const& map, int towerSlot)
+{
+	if (towerSlot < 0 || towerSlot >= m_towerCounters.size()) return;
+
+	Tower const* tower = map.m_towers[towerSlot];
+	TowerRoundStats stats = TakeTowerStats(m_towerCounters[towerSlot]);
+	stats.m_definition = tower->m_definition;
+	stats.m_towerSlot = towerSlot;
+	stats.m_position = tower->m_position;
+	stats.m_wasSold = true;
+	m_soldTowers.emplace_back(stats);
+}
+
+
+//copying out is a few loads per tower; formatting and file writes happen on the writer thread
+void RoundTelemetry::EndRound(Map const& map, int roundNumber)
+{
+	EnsureTowerSlots(static_cast<int>(map.m_towers.size()));
+
+	RoundTelemetryRecord record;
+	record.m_roundNumber = roundNumber;
+	record.m_towers.swap(m_soldTowers);
+
+	for (int towerSlot = 0; towerSlot < m_towerCounters.size(); towerSlot++)
+	{
+		TowerRoundStats stats = TakeTowerStats(m_towerCounters[towerSlot]);
+		Tower const* tower = towerSlot < map.m_towers.size() ? map.m_towers[towerSlot] : nullptr;
+		if (tower == nullptr) continue;
+
+		stats.m_definition = tower->m_definition;
+		stats.m_towerSlot = towerSlot;
+		stats.m_position = tower->m_position;
+		record.m_towers.emplace_back(stats);
+	}
+
+	for (int bloonDefIndex = 0; bloonDefIndex < m_bloonCounters.size(); bloonDefIndex++)
+	{
+		BloonTelemetryCounters& counters = m_bloonCounters[bloonDefIndex];
+		BloonRoundStats stats;
+		stats.m_definition = &BloonDefinition::s_bloonDefinitions[bloonDefIndex];
+		stats.m_numPopped = TakeCount(counters.m_numPopped);
+		stats.m_damageTaken = TakeCount(counters.m_damageTaken);
+		stats.m_numLeaked = TakeCount(counters.m_numLeaked);
+		stats.m_leakedRBE = TakeCount(counters.m_leakedRBE);
+		if (stats.m_numPopped > 0 || stats.m_damageTaken > 0 || stats.m_numLeaked > 0)
+		{
+			record.m_bloons.emplace_back(stats);
+		}
+	}
+
+	m_numRoundsRecorded++;
+	m_writer->AddJob([this, record](int) { WriteRecord(record); });
+}
+
+
+bool RoundTelemetry::GetFormatFromString(std::string const& formatName, TelemetryFormat& out_format)
+{
+	if (formatName == "csv")
+	{
+		out_format = TelemetryFormat::CSV;
+	}
+	else if (formatName == "json")
+	{
+		out_format = TelemetryFormat::JSON;
+	}
+	else if (formatName == "both")
+	{
+		out_format = TelemetryFormat::CSV_AND_JSON;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+
+//
+//private member functions
+//
+void RoundTelemetry::WriteRecord(RoundTelemetryRecord const& record) const
+{
+	std::string basePath = Stringf("Data/Telemetry/%s_Round%03i", m_runName.c_str(), record.m_roundNumber);
+
+	if (m_format == TelemetryFormat::CSV || m_format == TelemetryFormat::CSV_AND_JSON)
+	{
+		std::string text = GetRecordAsCSV(record);
+		FileWriteFromBuffer(std::vector<uint8_t>(text.begin(), text.end()), basePath + ".csv");
+	}
+	if (m_format == TelemetryFormat::JSON || m_format == TelemetryFormat::CSV_AND_JSON)
+	{
+		std::string text = GetRecordAsJSON(record);
+		FileWriteFromBuffer(std::vector<uint8_t>(text.begin(), text.end()), basePath + ".json");
+	}
+}
+
+
+//one row per tower and per bloon definition, with the columns that don't apply left empty
+std::string RoundTelemetry::GetRecordAsCSV(RoundTelemetryRecord const& record)
+{
+	std::string text = "round,kind,name,slot,x,y,sold,pops,damage,pierce,projectiles,leaks,leakedRBE\n";
+
+	for (int towerIndex = 0; towerIndex < record.m_towers.size(); towerIndex++)
+	{
+		TowerRoundStats const& stats = record.m_towers[towerIndex];
+		text += Stringf("%i,tower,%s,%i,%.1f,%.1f,%i,%u,%u,%u,%u,,\n", record.m_roundNumber, stats.m_definition->m_name.c_str(), stats.m_towerSlot, stats.m_position.x,
+			stats.m_position.y, stats.m_wasSold ? 1 : 0, stats.m_numPops, stats.m_damageDealt, stats.m_pierceUsed, stats.m_numProjectilesFired);
+	}
+	for (int bloonIndex = 0; bloonIndex < record.m_bloons.size(); bloonIndex++)
+	{
+		BloonRoundStats const& stats = record.m_bloons[bloonIndex];
+		text += Stringf("%i,bloon,%s,,,,,%u,%u,,,%u,%u\n", record.m_roundNumber, stats.m_definition->m_name.c_str(), stats.m_numPopped, stats.m_damageTaken, stats.m_numLeaked,
+			stats.m_leakedRBE);
+	}
+
+	return text;
+}
+
+
+std::string RoundTelemetry::GetRecordAsJSON(RoundTelemetryRecord const& record)
+{
+	std::string text = Stringf("{\n\t\"round\": %i,\n\t\"towers\": [", record.m_roundNumber);
+
+	for (int towerIndex = 0; towerIndex < record.m_towers.size(); towerIndex++)
+	{
+		TowerRoundStats const& stats = record.m_towers[towerIndex];
+		text += Stringf("%s\n\t\t{ \"name\": \"%s\", \"slot\": %i, \"x\": %.1f, \"y\": %.1f, \"sold\": %s, \"pops\": %u, \"damage\": %u, \"pierce\": %u, \"projectiles\": %u }",
+			towerIndex > 0 ? "," : "", stats.m_definition->m_name.c_str(), stats.m_towerSlot, stats.m_position.x, stats.m_position.y, stats.m_wasSold ? "true" : "false",
+			stats.m_numPops, stats.m_damageDealt, stats.m_pierceUsed, stats.m_numProjectilesFired);
+	}
+	text += "\n\t],\n\t\"bloons\": [";
+	for (int bloonIndex = 0; bloonIndex < record.m_bloons.size(); bloonIndex++)
+	{
+		BloonRoundStats const& stats = record.m_bloons[bloonIndex];
+		text += Stringf("%s\n\t\t{ \"name\": \"%s\", \"popped\": %u, \"damage\": %u, \"leaks\": %u, \"leakedRBE\": %u }", bloonIndex > 0 ? "," : "",
+			stats.m_definition->m_name.c_str(), stats.m_numPopped, stats.m_damageTaken, stats.m_numLeaked, stats.m_leakedRBE);
+	}
+	text += "\n\t]\n}\n";
+
+	return text;
+}
+
+
+TowerRoundStats RoundTelemetry::TakeTowerStats(TowerTelemetryCounters& counters)
+{
+	TowerRoundStats stats;
+	stats.m_numPops = TakeCount(counters.m_numPops);
+	stats.m_damageDealt = TakeCount(counters.m_damageDealt);
+	stats.m_pierceUsed = TakeCount(counters.m_pierceUsed);
+	stats.m_numProjectilesFired = TakeCount(counters.m_numProjectilesFired);
+	return stats;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+
+class Map;
+class BloonDefinition;
+class TowerDefinition;
+class WorkerPool;
+
+
+enum class TelemetryFormat : uint8_t
+{
+	CSV,
+	JSON,
+	CSV_AND_JSON,
+};
+
+
+//live counters, bumped from inside the simulation with relaxed atomic adds so towers and bloons
+//can be updated from several threads without a lock
+struct TowerTelemetryCounters
+{
+	std::atomic<uint32_t> m_numPops{ 0 };
+	std::atomic<uint32_t> m_damageDealt{ 0 };
+	std::atomic<uint32_t> m_pierceUsed{ 0 };
+	std::atomic<uint32_t> m_numProjectilesFired{ 0 };
+};
+
+
+struct BloonTelemetryCounters
+{
+	std::atomic<uint32_t> m_numPopped{ 0 };
+	std::atomic<uint32_t> m_damageTaken{ 0 };
+	std::atomic<uint32_t> m_numLeaked{ 0 };
+	std::atomic<uint32_t> m_leakedRBE{ 0 };
+};
+
+
+//plain copies of the counters, taken when a round ends
+struct TowerRoundStats
+{
+	TowerDefinition const* m_definition = nullptr;
+	int		 m_towerSlot = -1;
+	Vec2	 m_position = Vec2();
+	bool	 m_wasSold = false;
+	uint32_t m_numPops = 0;
+	uint32_t m_damageDealt = 0;
+	uint32_t m_pierceUsed = 0;
+	uint32_t m_numProjectilesFired = 0;
+};
+
+
+struct BloonRoundStats
+{
+	BloonDefinition const* m_definition = nullptr;
+	uint32_t m_numPopped = 0;
+	uint32_t m_damageTaken = 0;
+	uint32_t m_numLeaked = 0;
+	uint32_t m_leakedRBE = 0;
+};
+
+
+struct RoundTelemetryRecord
+{
+	int m_roundNumber = 0;
+	std::vector<TowerRoundStats> m_towers;
+	std::vector<BloonRoundStats> m_bloons;	//only definitions that were popped, hit or leaked
+};
+
+
+//what each tower did to which bloons over a round. Projectiles remember the tower slot that fired them, and
+//projectiles they spawn inherit it. Counting never allocates or locks; when a round ends the counters are
+//copied out and reset on the simulation thread and the copy is written to Data/Telemetry on a thread of its own.
+class RoundTelemetry
+{
+//public member functions
+public:
+	RoundTelemetry(std::string const& runName, TelemetryFormat format);
+	~RoundTelemetry();	//finishes writing any rounds still queued
+
+	//counting functions, safe from any thread during an update
+	void CountProjectileFired(int towerSlot);
+	void CountHit(int towerSlot, BloonDefinition const* bloonDef, int damage);	//each hit uses up one pierce
+	void CountPop(int towerSlot, BloonDefinition const* bloonDef);
+	void CountLeaks(BloonDefinition const* bloonDef, int numLeaked);
+
+	//bookkeeping functions, simulation thread only and never while an update is counting
+	void EnsureTowerSlots(int numTowerSlots);
+	void RetireTower(Map const& map, int towerSlot);	//before a sell, so a later tower in the slot starts from zero
+	void EndRound(Map const& map, int roundNumber);
+
+	static bool GetFormatFromString(std::string const& formatName, TelemetryFormat& out_format);
+
+//private member functions
+private:
+	void WriteRecord(RoundTelemetryRecord const& record) const;
+	static std::string GetRecordAsCSV(RoundTelemetryRecord const& record);
+	static std::string GetRecordAsJSON(RoundTelemetryRecord const& record);
+	static TowerRoundStats TakeTowerStats(TowerTelemetryCounters& counters);
+
+//public member variables
+public:
+	std::string		m_runName;
+	TelemetryFormat m_format = TelemetryFormat::CSV;
+	int				m_numRoundsRecorded = 0;
+
+//private member variables
+private:
+	std::deque<TowerTelemetryCounters>	m_towerCounters;	//by tower slot; a deque so growing never moves the atomics
+	std::vector<BloonTelemetryCounters> m_bloonCounters;	//by bloon definition
+	std::vector<TowerRoundStats>		m_soldTowers;		//towers sold so far this round
+	WorkerPool* m_writer = nullptr;
+};
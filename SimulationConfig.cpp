@@ -0,0 +1,56 @@
+#include "Game/SimulationConfig.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//
+//public member functions
+//
+bool SimulationConfig::SetOption(std::string const& optionName, bool value)
+{
+	if (optionName == "ArcLengthTables")
+	{
+		m_useArcLengthTables = value;
+		return true;
+	}
+	if (optionName == "TowerSleep")
+	{
+		m_useTowerSleep = value;
+		return true;
+	}
+	if (optionName == "BloonSwarms")
+	{
+		m_useBloonSwarms = value;
+		return true;
+	}
+
+	return false;
+}
+
+
+bool SimulationConfig::GetOption(std::string const& optionName, bool& out_value) const
+{
+	if (optionName == "ArcLengthTables")
+	{
+		out_value = m_useArcLengthTables;
+		return true;
+	}
+	if (optionName == "TowerSleep")
+	{
+		out_value = m_useTowerSleep;
+		return true;
+	}
+	if (optionName == "BloonSwarms")
+	{
+		out_value = m_useBloonSwarms;
+		return true;
+	}
+
+	return false;
+}
+
+
+std::string SimulationConfig::GetDescription() const
+{
+	return Stringf("ArcLengthTables=%s TowerSleep=%s BloonSwarms=%s", m_useArcLengthTables ? "true" : "false", m_useTowerSleep ? "true" : "false",
+		m_useBloonSwarms ? "true" : "false");
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+
+
+//toggles for alternate simulation code paths, so an optimized path can be checked against its reference
+struct SimulationConfig
+{
+//public member functions
+public:
+	bool SetOption(std::string const& optionName, bool value);
+	bool GetOption(std::string const& optionName, bool& out_value) const;
+	std::string GetDescription() const;
+
+//public member variables
+public:
+	bool m_useArcLengthTables = true;	//false evaluates boomerang curves directly each tick
+	bool m_useTowerSleep = true;		//false updates every tower every tick even with no bloon anywhere near
+	bool m_useBloonSwarms = true;		//false spawns every bloon of a wave on its own instead of moving them as one record
+};
@@ -0,0 +1,71 @@
+#include "Game/Snapshot.hpp"
+#include <cstring>
+
+
+//
+//snapshot writer
+//
+SnapshotWriter::SnapshotWriter(std::vector<uint8_t>& buffer)
+	: m_buffer(buffer)
+{
+	//keep whatever capacity the buffer already has so repeated snapshots don't reallocate
+	m_buffer.resize(m_buffer.capacity());
+}
+
+
+void SnapshotWriter::WriteBytes(void const* data, size_t numBytes)
+{
+	size_t requiredSize = m_numBytesWritten + numBytes;
+	if (requiredSize > m_buffer.size())
+	{
+		size_t newSize = m_buffer.size() * 2;
+		if (newSize < requiredSize) newSize = requiredSize;
+		if (newSize < 4096) newSize = 4096;
+		m_buffer.resize(newSize);
+	}
+
+	memcpy(m_buffer.data() + m_numBytesWritten, data, numBytes);
+	m_numBytesWritten = requiredSize;
+}
+
+
+void SnapshotWriter::Finish()
+{
+	//shrinking a vector never frees its storage, so the next snapshot can reuse it
+	m_buffer.resize(m_numBytesWritten);
+}
+
+
+//
+//snapshot reader
+//
+SnapshotReader::SnapshotReader(uint8_t const* data, size_t numBytes)
+	: m_data(data)
+	, m_numBytes(numBytes)
+{
+}
+
+
+void SnapshotReader::ReadBytes(void* out_data, size_t numBytes)
+{
+	if (!m_isValid || m_numBytesRead + numBytes > m_numBytes)
+	{
+		m_isValid = false;
+		memset(out_data, 0, numBytes);
+		return;
+	}
+
+	memcpy(out_data, m_data + m_numBytesRead, numBytes);
+	m_numBytesRead += numBytes;
+}
+
+
+//checked before resizing anything, so a corrupt count fails the read instead of asking for gigabytes
+bool SnapshotReader::CanHoldCount(int count, size_t minBytesPerElement)
+{
+	if (!m_isValid || count < 0 || static_cast<size_t>(count) > (m_numBytes - m_numBytesRead) / minBytesPerElement)
+	{
+		m_isValid = false;
+	}
+	return m_isValid;
+}
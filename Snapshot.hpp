@@ -0,0 +1,60 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include <type_traits>
+
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x53445442;	//"BTDS"
+constexpr uint32_t SNAPSHOT_VERSION = 3;
+
+
+class SnapshotWriter
+{
+//public member functions
+public:
+	explicit SnapshotWriter(std::vector<uint8_t>& buffer);
+
+	template <typename T>
+	void Write(T const& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Snapshots can only contain trivially copyable values!");
+		WriteBytes(&value, sizeof(T));
+	}
+	void WriteBytes(void const* data, size_t numBytes);
+	void Finish();
+
+	size_t GetNumBytesWritten() const { return m_numBytesWritten; }
+
+//private member variables
+private:
+	std::vector<uint8_t>& m_buffer;
+	size_t m_numBytesWritten = 0;
+};
+
+
+class SnapshotReader
+{
+//public member functions
+public:
+	SnapshotReader(uint8_t const* data, size_t numBytes);
+
+	template <typename T>
+	T Read()
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Snapshots can only contain trivially copyable values!");
+		T value = T();
+		ReadBytes(&value, sizeof(T));
+		return value;
+	}
+	void ReadBytes(void* out_data, size_t numBytes);
+
+	bool IsValid() const { return m_isValid; }
+	bool IsAtEnd() const { return m_numBytesRead == m_numBytes; }
+	bool CanHoldCount(int count, size_t minBytesPerElement);	//invalidates the reader for a count the bytes left couldn't hold
+
+//private member variables
+private:
+	uint8_t const* m_data = nullptr;
+	size_t m_numBytes = 0;
+	size_t m_numBytesRead = 0;
+	bool   m_isValid = true;
+};
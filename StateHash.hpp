@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+
+//word-at-a-time mix used to fingerprint simulation state every tick for replay and determinism checks
+constexpr uint64_t STATE_HASH_SEED = 14695981039346656037ull;
+
+
+inline uint64_t HashCombine(uint64_t hash, uint64_t value)
+{
+	hash ^= value;
+	hash *= 0x9E3779B97F4A7C15ull;
+	hash ^= hash >> 29;
+	return hash;
+}
+
+
+//hashes any value up to eight bytes as a single word, so floats are compared bit for bit
+template <typename T>
+inline uint64_t HashWord(uint64_t hash, T const& value)
+{
+	static_assert(std::is_trivially_copyable<T>::value && sizeof(T) <= sizeof(uint64_t), "Only trivially copyable values up to 8 bytes can be hashed as a word!");
+	uint64_t word = 0;
+	memcpy(&word, &value, sizeof(T));
+	return HashCombine(hash, word);
+}
+
+
+//hashes a buffer a word at a time, with the tail padded out with zeroes
+inline uint64_t HashBytes(uint64_t hash, void const* data, size_t numBytes)
+{
+	uint8_t const* bytes = static_cast<uint8_t const*>(data);
+	size_t byteIndex = 0;
+	for (; byteIndex + sizeof(uint64_t) <= numBytes; byteIndex += sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, bytes + byteIndex, sizeof(uint64_t));
+		hash = HashCombine(hash, word);
+	}
+	if (byteIndex < numBytes)
+	{
+		uint64_t word = 0;
+		memcpy(&word, bytes + byteIndex, numBytes - byteIndex);
+		hash = HashCombine(hash, word);
+	}
+	return HashWord(hash, static_cast<uint64_t>(numBytes));
+}
@@ -0,0 +1,114 @@
+#include "Game/StressTest.hpp"
+#include "Game/Game.hpp"
+#include "Game/Tower.hpp"
+#include "Game/TowerDefinition.hpp"
+#include "Engine/Core/Time.hpp"
+
+
+StressEntityCounts CountStressEntities(Map const& map)
+{
+	StressEntityCounts counts;
+
+	for (int bloonIndex = 0; bloonIndex < map.m_bloons.size(); bloonIndex++)
+	{
+		if (map.m_bloons[bloonIndex] != nullptr) counts.m_numBloons++;
+	}
+	for (int swarmIndex = 0; swarmIndex < map.m_bloonSwarms.size(); swarmIndex++)
+	{
+		counts.m_numSwarmBloons += map.m_bloonSwarms[swarmIndex].m_numMembers - map.m_bloonSwarms[swarmIndex].m_firstMemberIndex;
+	}
+	for (int towerIndex = 0; towerIndex < map.m_towers.size(); towerIndex++)
+	{
+		if (map.m_towers[towerIndex] != nullptr) counts.m_numTowers++;
+	}
+	counts.m_numProjectiles = map.m_projectiles.GetNumAlive();
+
+	return counts;
+}
+
+
+//grants exactly what the command costs and takes it back if the command is refused, so failures leave no money behind
+static bool IssuePaidCommand(Game& game, GameCommand const& command, int cost)
+{
+	GameCommand moneyCommand;
+	moneyCommand.m_type = GameCommandType::ADD_MONEY;
+	moneyCommand.m_index = cost;
+	game.IssueCommand(moneyCommand);
+
+	if (game.IssueCommand(command)) return true;
+
+	moneyCommand.m_index = -cost;
+	game.IssueCommand(moneyCommand);
+	return false;
+}
+
+
+//fills the playfield row by row wherever the tower fits, paying for each tower and its upgrades with money added just for it
+int PlaceStressTowerGrid(Game& game, TowerDefinition const* definition, float spacing, int upgradePath, int numUpgrades, int maxTowers)
+{
+	Map* map = game.m_currentMap;
+	if (map == nullptr || definition == nullptr || spacing <= 0.0f) return 0;
+
+	int numPlaced = 0;
+	for (float y = spacing * 0.5f; y < SCREEN_CAMERA_SIZE_Y && numPlaced < maxTowers; y += spacing)
+	{
+		for (float x = spacing * 0.5f; x < PLAYFIELD_SIZE_X && numPlaced < maxTowers; x += spacing)
+		{
+			Vec2 position = Vec2(x, y);
+			if (!map->IsValidTowerPlacement(definition, position)) continue;
+
+			GameCommand placeCommand;
+			placeCommand.m_type = GameCommandType::PLACE_TOWER;
+			placeCommand.m_index = static_cast<int>(definition - TowerDefinition::s_towerDefinitions.data());
+			placeCommand.m_position = position;
+			if (!IssuePaidCommand(game, placeCommand, definition->m_cost)) continue;
+			numPlaced++;
+
+			int towerIndex = static_cast<int>(map->m_towers.size()) - 1;
+			for (int upgradeIndex = 0; upgradeIndex < numUpgrades; upgradeIndex++)
+			{
+				TowerDefinition const* towerDef = map->m_towers[towerIndex]->m_definition;
+				std::string const& upgradeDefName = upgradePath == 2 ? towerDef->m_upgrade2 : towerDef->m_upgrade1;
+				if (upgradeDefName.empty()) break;
+
+				GameCommand upgradeCommand;
+				upgradeCommand.m_type = upgradePath == 2 ? GameCommandType::BUY_UPGRADE_2 : GameCommandType::BUY_UPGRADE_1;
+				upgradeCommand.m_index = towerIndex;
+				if (!IssuePaidCommand(game, upgradeCommand, upgradePath == 2 ? towerDef->m_upgrade2Cost : towerDef->m_upgrade1Cost)) break;
+			}
+		}
+	}
+
+	return numPlaced;
+}
+
+
+//steps the live game as fast as it will go; the caller keeps the simulation thread idle and rendering off meanwhile
+StressRunResult RunStressTicks(Game& game, int numTicks, float deltaSeconds)
+{
+	StressRunResult result;
+	Map* map = game.m_currentMap;
+	if (map == nullptr) return result;
+
+	result.m_startCounts = CountStressEntities(*map);
+	result.m_peakCounts = result.m_startCounts;
+
+	map->m_phaseTimings = &result.m_mapTimings;
+	for (int tickIndex = 0; tickIndex < numTicks && game.m_currentMap == map; tickIndex++)
+	{
+		double tickStartTime = GetCurrentTimeSeconds();
+		game.UpdateSimulation(deltaSeconds);
+		result.m_secondsElapsed += GetCurrentTimeSeconds() - tickStartTime;
+		result.m_numTicksRun++;
+
+		StressEntityCounts counts = CountStressEntities(*map);
+		if (counts.m_numBloons > result.m_peakCounts.m_numBloons) result.m_peakCounts.m_numBloons = counts.m_numBloons;
+		if (counts.m_numSwarmBloons > result.m_peakCounts.m_numSwarmBloons) result.m_peakCounts.m_numSwarmBloons = counts.m_numSwarmBloons;
+		if (counts.m_numTowers > result.m_peakCounts.m_numTowers) result.m_peakCounts.m_numTowers = counts.m_numTowers;
+		if (counts.m_numProjectiles > result.m_peakCounts.m_numProjectiles) result.m_peakCounts.m_numProjectiles = counts.m_numProjectiles;
+		result.m_endCounts = counts;
+	}
+	map->m_phaseTimings = nullptr;
+
+	return result;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Game/Map.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+
+class Game;
+class TowerDefinition;
+
+
+struct StressEntityCounts
+{
+	int m_numBloons = 0;
+	int m_numSwarmBloons = 0;	//swarm members still waiting to become bloons
+	int m_numTowers = 0;
+	int m_numProjectiles = 0;
+};
+
+
+struct StressRunResult
+{
+	int	   m_numTicksRun = 0;
+	double m_secondsElapsed = 0.0;		//simulation only; counting entities between ticks isn't included
+	MapPhaseTimings	   m_mapTimings;	//the rest of the elapsed time is round and wave handling in Game
+	StressEntityCounts m_startCounts;
+	StressEntityCounts m_peakCounts;
+	StressEntityCounts m_endCounts;
+};
+
+
+//console stress tools; everything that changes state goes through game commands, so a recording reproduces it
+StressEntityCounts CountStressEntities(Map const& map);
+int PlaceStressTowerGrid(Game& game, TowerDefinition const* definition, float spacing, int upgradePath, int numUpgrades, int maxTowers);
+StressRunResult RunStressTicks(Game& game, int numTicks, float deltaSeconds);
@@ -0,0 +1,90 @@
+#include "Game/TimingWheel.hpp"
+#include <cmath>
+
+
+//
+//constructor
+//
+TimingWheel::TimingWheel(double slotSeconds, int numSlots)
+	: m_slotSeconds(slotSeconds)
+	, m_slots(numSlots)
+{
+}
+
+
+//
+//public member functions
+//
+void TimingWheel::Schedule(int id, double seconds)
+{
+	//anything already due goes in the current slot, which the next advance always visits
+	int64_t tick = GetSlotTick(seconds);
+	if (tick < m_currentTick)
+	{
+		tick = m_currentTick;
+	}
+
+	int numSlots = static_cast<int>(m_slots.size());
+	m_slots[tick % numSlots].push_back(Entry{ id, seconds });
+}
+
+
+//hands back every id due at or before the given time; an id scheduled more than once comes back once per schedule
+void TimingWheel::AdvanceTo(double seconds, std::vector<int>& out_dueIds)
+{
+	int64_t targetTick = GetSlotTick(seconds);
+	if (targetTick < m_currentTick)
+	{
+		targetTick = m_currentTick;
+	}
+
+	//a jump longer than the wheel only needs to visit each slot once
+	int numSlots = static_cast<int>(m_slots.size());
+	int64_t firstTick = m_currentTick;
+	if (targetTick - firstTick >= numSlots)
+	{
+		firstTick = targetTick - numSlots + 1;
+	}
+	m_currentTick = targetTick;
+
+	for (int64_t tick = firstTick; tick <= targetTick; tick++)
+	{
+		std::vector<Entry>& slot = m_slots[tick % numSlots];
+
+		//keep entries for later laps in place, compacting the slot as we go
+		int numKept = 0;
+		for (int entryIndex = 0; entryIndex < slot.size(); entryIndex++)
+		{
+			Entry const& entry = slot[entryIndex];
+			if (entry.m_seconds <= seconds)
+			{
+				out_dueIds.push_back(entry.m_id);
+			}
+			else
+			{
+				slot[numKept] = entry;
+				numKept++;
+			}
+		}
+		slot.resize(numKept);
+	}
+}
+
+
+void TimingWheel::Clear()
+{
+	for (int slotIndex = 0; slotIndex < m_slots.size(); slotIndex++)
+	{
+		m_slots[slotIndex].clear();
+	}
+	m_currentTick = 0;
+}
+
+
+//
+//private member functions
+//
+int64_t TimingWheel::GetSlotTick(double seconds) const
+{
+	return static_cast<int64_t>(std::floor(seconds / m_slotSeconds));
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+
+//hashed timing wheel: ids scheduled for a time land in the slot that time falls in, and advancing
+//the clock only visits the slots it passes. Times past the wheel's span wrap around and are kept
+//until a later lap reaches them, so scheduling and advancing are O(1) per id regardless of distance.
+class TimingWheel
+{
+//public member functions
+public:
+	TimingWheel(double slotSeconds, int numSlots);
+
+	void Schedule(int id, double seconds);
+	void AdvanceTo(double seconds, std::vector<int>& out_dueIds);
+	void Clear();
+
+//private member functions
+private:
+	int64_t GetSlotTick(double seconds) const;
+
+//private member variables
+private:
+	struct Entry
+	{
+		int	   m_id = -1;
+		double m_seconds = 0.0;
+	};
+
+	double m_slotSeconds = 0.0;
+	std::vector<std::vector<Entry>> m_slots;
+	int64_t m_currentTick = 0;	//slot the clock is in; it is visited again by every advance until the clock leaves it
+};
@@ -3,8 +3,11 @@
 #include "Game/Bloon.hpp"
 #include "Game/Map.hpp"
 #include "Game/Game.hpp"
+#include "Game/RoundTelemetry.hpp"
 #include "Game/BloonDefinition.hpp"
-#include "Game/Projectile.hpp"
+#include "Game/ProjectileDefinition.hpp"
+#include "Game/StateHash.hpp"
+#include "Game/FrameArena.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Math/MathUtils.hpp"
@@ -12,6 +15,18 @@
 #include "Engine/Math/OBB2.hpp"
 
 
+//
+//destructor
+//
+Tower::~Tower()
+{
+	if (m_map != nullptr)
+	{
+		m_map->ReleaseCurvedArc(m_curvedArcIndex);
+	}
+}
+
+
 //
 //game flow functions
 //
@@ -19,8 +34,7 @@ void Tower::Update(float deltaSeconds)
 {
 	if (m_isBeingHeld) return;
 
-	m_curvedProjArc = CubicBezierCurve2D::CreateUsingHermite(m_position, (m_iBasis * 0.9f + m_iBasis.GetRotatedMinus90Degrees()) * SCREEN_CAMERA_SIZE_Y, m_position, 
-		(-m_iBasis * 0.9f + m_iBasis.GetRotatedMinus90Degrees()) * SCREEN_CAMERA_SIZE_Y);
+	RefreshCurvedArc();
 
 	FindTarget();
 
@@ -38,13 +52,14 @@ void Tower::Update(float deltaSeconds)
 		}
 	}
 
+	m_foundTarget = m_target != nullptr;
 	m_target = nullptr;
 }
 
 
 void Tower::Render() const
 {
-	std::vector<Vertex_PCU> verts;
+	std::vector<Vertex_PCU>& verts = g_frameArena.AcquireVerts();
 
 	float const& size = m_definition->m_size;
 	OBB2 renderBounds = OBB2(m_position, m_iBasis.GetRotated90Degrees(), Vec2(size, size));
@@ -53,25 +68,20 @@ void Tower::Render() const
 
 	g_theRenderer->BindTexture(m_definition->m_texture);
 	g_theRenderer->DrawVertexArray(verts);
-
-	/*DebugAddScreenText("A", m_curvedProjArc.A, SIZE_MODIFIER, Vec2(0.5f, 0.5f), 0.0f);
-	DebugAddScreenText("B", m_curvedProjArc.B, SIZE_MODIFIER, Vec2(0.5f, 0.5f), 0.0f);
-	DebugAddScreenText("C", m_curvedProjArc.C, SIZE_MODIFIER, Vec2(0.5f, 0.5f), 0.0f);
-	DebugAddScreenText("D", m_curvedProjArc.D, SIZE_MODIFIER, Vec2(0.5f, 0.5f), 0.0f);*/
 }
 
 
 void Tower::RenderRange(bool redRange) const
 {
-	std::vector<Vertex_PCU> verts;
+	std::vector<Vertex_PCU>& verts = g_frameArena.AcquireVerts();
 
 	if (redRange)
 	{
-		AddVertsForDisc2D(verts, m_position, m_definition->m_range, Rgba8(255, 50, 50, 127));
+		AddVertsForRange(verts, Rgba8(255, 50, 50, 127));
 	}
 	else
 	{
-		AddVertsForDisc2D(verts, m_position, m_definition->m_range, Rgba8(255, 255, 255, 127));
+		AddVertsForRange(verts, Rgba8(255, 255, 255, 127));
 	}
 	
 	g_theRenderer->BindTexture(nullptr);
@@ -79,9 +89,59 @@ void Tower::RenderRange(bool redRange) const
 }
 
 
+//copies the definition's cached disc instead of rebuilding it, so many ranges can share one draw call
+void Tower::AddVertsForRange(std::vector<Vertex_PCU>& verts, Rgba8 const& color) const
+{
+	std::vector<Vertex_PCU> const& discVerts = m_definition->m_rangeDiscVerts;
+
+	size_t firstVertIndex = verts.size();
+	verts.insert(verts.end(), discVerts.begin(), discVerts.end());
+	for (size_t vertIndex = firstVertIndex; vertIndex < verts.size(); vertIndex++)
+	{
+		verts[vertIndex].m_position.x += m_position.x;
+		verts[vertIndex].m_position.y += m_position.y;
+		verts[vertIndex].m_color = color;
+	}
+}
+
+
 //
 //gameplay functions
 //
+void Tower::RefreshCurvedArc()
+{
+	//only towers that throw curved projectiles need an arc
+	if (m_definition->m_projectileDef == nullptr || !m_definition->m_projectileDef->m_curvedArc)
+	{
+		m_map->ReleaseCurvedArc(m_curvedArcIndex);
+		m_curvedArcIndex = -1;
+		return;
+	}
+
+	//the arc only changes when the tower turns, so rebuild it only then
+	if (m_curvedArcIndex != -1)
+	{
+		CurvedProjectileArc const& arc = m_map->GetCurvedArc(m_curvedArcIndex);
+		if (arc.m_iBasis == m_iBasis && arc.m_origin == m_position)
+		{
+			return;
+		}
+	}
+
+	//projectiles already in flight keep their reference to the old arc
+	m_map->ReleaseCurvedArc(m_curvedArcIndex);
+	m_curvedArcIndex = m_map->AcquireCurvedArc(m_position, m_iBasis);
+}
+
+
+//for when the tower's range or the track under it changes, so its coverage is measured again
+void Tower::Wake()
+{
+	m_isAsleep = false;
+	m_hasTrackCoverage = false;
+}
+
+
 void Tower::FindTarget()
 {
 	for (int bloonIndex = 0; bloonIndex < m_map->m_bloons.size(); bloonIndex++)
@@ -155,7 +215,12 @@ void Tower::ShootProjectile()
 		float degrees = projIndex * angleBetweenProjectiles;
 		Vec2 direction = m_iBasis.GetRotatedDegrees(degrees);
 		m_map->SpawnProjectile(projDef, m_position, direction, m_definition->m_addedPierce, m_definition->m_addedLifespan, m_definition->m_addedSize, m_definition->m_addedFreezeTime, 
-			m_curvedProjArc);
+			m_curvedArcIndex, m_slotIndex);
+	}
+
+	if (m_map->m_game->m_roundTelemetry != nullptr)
+	{
+		m_map->m_game->m_roundTelemetry->CountProjectileFired(m_slotIndex);
 	}
 }
 
@@ -188,3 +253,25 @@ std::string Tower::GetTargetingModeAsString() const
 
 	return "ERROR";
 }
+
+
+//
+//public determinism functions
+//
+uint64_t Tower::GetStateHash() const
+{
+	uint64_t hash = STATE_HASH_SEED;
+	hash = HashWord(hash, static_cast<int>(m_definition - TowerDefinition::s_towerDefinitions.data()));
+	hash = HashWord(hash, m_position);
+	hash = HashWord(hash, m_iBasis);
+	hash = HashWord(hash, m_cooldownTimer);
+	hash = HashWord(hash, m_targetingMode);
+	return hash;
+}
+
+
+std::string Tower::GetStateDescription() const
+{
+	return Stringf("%s pos=(%.9g, %.9g) iBasis=(%.9g, %.9g) cooldown=%.9g targeting=%s", m_definition->m_name.c_str(), m_position.x, m_position.y, m_iBasis.x, m_iBasis.y,
+		m_cooldownTimer, GetTargetingModeAsString().c_str());
+}
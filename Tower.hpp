@@ -1,7 +1,8 @@
 #pragma once
 #include "Engine/Math/Vec2.hpp"
-#include "Engine/Math/CubicBezierCurve2D.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
 #include <string>
+#include <vector>
 
 
 class TowerDefinition;
@@ -9,6 +10,16 @@ class Bloon;
 class Map;
 
 
+constexpr int MAX_TRACK_COVERAGE_INTERVALS = 4;	//past this, the last interval swallows the gaps after it, which only wakes the tower early
+
+
+struct TrackCoverageInterval
+{
+	float m_start = 0.0f;
+	float m_end = 0.0f;
+};
+
+
 enum class TargetingMode
 {
 	FIRST,
@@ -30,17 +41,27 @@ public:
 		, m_map(map)
 		, m_position(position)
 	{}
+	Tower(Tower const& copyFrom) = delete;
+	Tower& operator=(Tower const& copyFrom) = delete;
+	~Tower();
 
 	//game flow functions
 	void Update(float deltaSeconds);
 	void Render() const;
 	void RenderRange(bool redRange = false) const;
+	void AddVertsForRange(std::vector<Vertex_PCU>& verts, Rgba8 const& color) const;
 
 	//gameplay functions
+	void RefreshCurvedArc();
+	void Wake();
 	void FindTarget();
 	void ShootProjectile();
 	std::string GetTargetingModeAsString() const;
 
+	//determinism functions
+	uint64_t	GetStateHash() const;
+	std::string GetStateDescription() const;
+
 //public member variables
 public:
 	TowerDefinition const* m_definition = nullptr;
@@ -56,5 +77,16 @@ public:
 
 	bool m_isBeingHeld = false;
 
-	CubicBezierCurve2D m_curvedProjArc = CubicBezierCurve2D();
+	int m_curvedArcIndex = -1;
+
+	int m_slotIndex = -1;	//-1 while held
+
+	//sleep scheduling, managed by the map; derived from the rest of the state, so never saved or hashed
+	bool   m_foundTarget = false;			//whether the last Update had anything in range
+	bool   m_isAsleep = false;
+	double m_wakeSeconds = 0.0;
+	bool   m_hasTrackCoverage = false;
+	int	   m_numTrackCoverageIntervals = 0;
+	TrackCoverageInterval m_trackCoverage[MAX_TRACK_COVERAGE_INTERVALS];	//stretches of track a bloon must be on to be able to reach the range, in track order
+	float  m_swarmZoneStart = 0.0f;			//first track distance at which anything this tower fires could touch a bloon
 };
@@ -3,6 +3,7 @@
 #include "Game/ProjectileDefinition.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/Texture.hpp"
+#include "Engine/Core/VertexUtils.hpp"
 
 
 std::vector<TowerDefinition> TowerDefinition::s_towerDefinitions;
@@ -16,7 +17,10 @@ TowerDefinition::TowerDefinition(XmlElement const& element)
 	m_name = ParseXmlAttribute(element, "name", m_name);
 
 	std::string textureFilePath = ParseXmlAttribute(element, "texture", "invalid path");
-	m_texture = g_theRenderer->CreateOrGetTextureFromFile(textureFilePath.c_str());
+	if (g_theRenderer != nullptr)
+	{
+		m_texture = g_theRenderer->CreateOrGetTextureFromFile(textureFilePath.c_str());
+	}
 
 	std::string projDefName = ParseXmlAttribute(element, "projectile", "invalid projectile");
 	m_projectileDef = ProjectileDefinition::GetProjectileDefinitionByName(projDefName);
@@ -27,6 +31,8 @@ TowerDefinition::TowerDefinition(XmlElement const& element)
 	m_attackCooldown = ParseXmlAttribute(element, "attackCooldown", m_attackCooldown);
 	m_isTracking = ParseXmlAttribute(element, "isTracking", m_isTracking);
 	m_size = ParseXmlAttribute(element, "size", m_size) * SIZE_MODIFIER;
+
+	AddVertsForDisc2D(m_rangeDiscVerts, Vec2(), m_range, Rgba8(255, 255, 255, 127));
 	
 	m_addedPierce = ParseXmlAttribute(element, "addedPierce", m_addedPierce);
 	m_addedLifespan = ParseXmlAttribute(element, "addedLifespan", m_addedLifespan);
@@ -49,7 +55,7 @@ TowerDefinition::TowerDefinition(XmlElement const& element)
 		m_upgrade1Name = ParseXmlAttribute(*upgradesElement, "upgrade1Name", m_upgrade1Name);
 		m_upgrade1Desc = ParseXmlAttribute(*upgradesElement, "upgrade1Desc", m_upgrade1Desc);
 		std::string upgrade1TextureFilePath = ParseXmlAttribute(*upgradesElement, "upgrade1Texture", "invalid path");
-		if (upgrade1TextureFilePath != "invalid path")
+		if (upgrade1TextureFilePath != "invalid path" && g_theRenderer != nullptr)
 		{
 			m_upgrade1Tex = g_theRenderer->CreateOrGetTextureFromFile(upgrade1TextureFilePath.c_str());
 		}
@@ -58,7 +64,7 @@ TowerDefinition::TowerDefinition(XmlElement const& element)
 		m_upgrade2Name = ParseXmlAttribute(*upgradesElement, "upgrade2Name", m_upgrade2Name);
 		m_upgrade2Desc = ParseXmlAttribute(*upgradesElement, "upgrade2Desc", m_upgrade2Desc);
 		std::string upgrade2TextureFilePath = ParseXmlAttribute(*upgradesElement, "upgrade2Texture", "invalid path");
-		if (upgrade2TextureFilePath != "invalid path")
+		if (upgrade2TextureFilePath != "invalid path" && g_theRenderer != nullptr)
 		{
 			m_upgrade2Tex = g_theRenderer->CreateOrGetTextureFromFile(upgrade2TextureFilePath.c_str());
 		}
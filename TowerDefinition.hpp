@@ -1,6 +1,7 @@
 #pragma once
 #include "Game/GameCommon.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
 
 
 constexpr float RANGE_MODIFIER = 1.5f;
@@ -35,6 +36,8 @@ public:
 	bool  m_isTracking = false;
 	float m_size = 0.0f;
 
+	std::vector<Vertex_PCU> m_rangeDiscVerts;	//centered on the origin, built once at load
+
 	int   m_addedPierce = 0;
 	float m_addedLifespan = 0.0f;
 	float m_addedFreezeTime = 0.0f;
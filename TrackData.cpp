@@ -0,0 +1,109 @@
+#include "Game/TrackData.hpp"
+#include "Game/MappedFile.hpp"
+#include "Game/Snapshot.hpp"
+#include "Engine/Core/FileUtils.hpp"
+
+
+constexpr size_t TRACK_FILE_HEADER_SIZE = 16;	//magic, version, curve count, subdivision count
+
+
+//
+//public member functions
+//
+void TrackData::BuildArcLengths()
+{
+	int numCurves = static_cast<int>(m_curves.size());
+	m_arcLengths.resize(numCurves);
+	m_curveStartDistances.resize(numCurves + 1);
+
+	m_curveStartDistances[0] = 0.0f;
+	for (int curveIndex = 0; curveIndex < numCurves; curveIndex++)
+	{
+		m_arcLengths[curveIndex].Build(m_curves[curveIndex]);
+		m_curveStartDistances[curveIndex + 1] = m_curveStartDistances[curveIndex] + m_arcLengths[curveIndex].GetTotalLength();
+	}
+}
+
+
+bool TrackData::WriteToFile(std::string const& filePath) const
+{
+	int numCurves = static_cast<int>(m_curves.size());
+	if (numCurves == 0 || m_arcLengths.size() != numCurves || m_curveStartDistances.size() != numCurves + 1)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> buffer;
+	buffer.reserve(TRACK_FILE_HEADER_SIZE + numCurves * (sizeof(CubicBezierCurve2D) + sizeof(ArcLengthTable) + sizeof(float)) + sizeof(float));
+
+	SnapshotWriter writer = SnapshotWriter(buffer);
+	writer.Write(TRACK_FILE_MAGIC);
+	writer.Write(TRACK_FILE_VERSION);
+	writer.Write(numCurves);
+	writer.Write(static_cast<int>(NUM_CURVE_SUBDIVISIONS));
+
+	writer.WriteBytes(m_curves.data(), numCurves * sizeof(CubicBezierCurve2D));
+	writer.WriteBytes(m_arcLengths.data(), numCurves * sizeof(ArcLengthTable));
+	writer.WriteBytes(m_curveStartDistances.data(), (numCurves + 1) * sizeof(float));
+	writer.Finish();
+
+	return FileWriteFromBuffer(buffer, filePath);
+}
+
+
+//the file is mapped rather than read, and each section is a single copy straight out of the mapping
+bool TrackData::ReadFromFile(std::string const& filePath)
+{
+	MappedFile file;
+	if (!file.Open(filePath))
+	{
+		return false;
+	}
+
+	SnapshotReader reader = SnapshotReader(file.GetData(), file.GetSize());
+	if (reader.Read<uint32_t>() != TRACK_FILE_MAGIC || reader.Read<uint32_t>() != TRACK_FILE_VERSION)
+	{
+		return false;
+	}
+
+	//tables built with a different subdivision count can't be used as-is
+	int numCurves = reader.Read<int>();
+	int numSubdivisions = reader.Read<int>();
+	if (numCurves <= 0 || numSubdivisions != NUM_CURVE_SUBDIVISIONS)
+	{
+		return false;
+	}
+
+	size_t expectedSize = TRACK_FILE_HEADER_SIZE + numCurves * (sizeof(CubicBezierCurve2D) + sizeof(ArcLengthTable) + sizeof(float)) + sizeof(float);
+	if (file.GetSize() != expectedSize)
+	{
+		return false;
+	}
+
+	m_curves.resize(numCurves);
+	reader.ReadBytes(m_curves.data(), numCurves * sizeof(CubicBezierCurve2D));
+	m_arcLengths.resize(numCurves);
+	reader.ReadBytes(m_arcLengths.data(), numCurves * sizeof(ArcLengthTable));
+	m_curveStartDistances.resize(numCurves + 1);
+	reader.ReadBytes(m_curveStartDistances.data(), (numCurves + 1) * sizeof(float));
+
+	return reader.IsValid() && reader.IsAtEnd();
+}
+
+
+//same <Curve> elements MapDefinitions.xml reads, for pasting edited tracks back into it
+void TrackData::WriteXmlToFile(std::string const& filePath) const
+{
+	std::vector<uint8_t> buffer;
+	buffer.reserve(m_curves.size() * 96);
+
+	for (int curveIndex = 0; curveIndex < m_curves.size(); curveIndex++)
+	{
+		CubicBezierCurve2D const& curve = m_curves[curveIndex];
+		std::string curveXml = Stringf("<Curve a=\"%.1f, %.1f\" b=\"%.1f, %.1f\" c=\"%.1f, %.1f\" d=\"%.1f, %.1f\"/>\n", curve.A.x, curve.A.y, curve.B.x, curve.B.y, curve.C.x, curve.C.y,
+			curve.D.x, curve.D.y);
+		buffer.insert(buffer.end(), curveXml.begin(), curveXml.end());
+	}
+
+	FileWriteFromBuffer(buffer, filePath);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "Game/ArcLengthTable.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/CubicBezierCurve2D.hpp"
+
+
+constexpr uint32_t TRACK_FILE_MAGIC = 0x4B545442;	//"BTTK"
+constexpr uint32_t TRACK_FILE_VERSION = 1;
+
+
+//a map's track with its tessellation precomputed; stored in .track files so maps load without parsing or re-measuring curves
+class TrackData
+{
+//public member functions
+public:
+	void BuildArcLengths();
+
+	bool WriteToFile(std::string const& filePath) const;
+	bool ReadFromFile(std::string const& filePath);
+	void WriteXmlToFile(std::string const& filePath) const;
+
+//public member variables
+public:
+	std::vector<CubicBezierCurve2D> m_curves;
+	std::vector<ArcLengthTable>		m_arcLengths;			//one per curve
+	std::vector<float>				m_curveStartDistances;	//one per curve plus the total track length at the end
+};
@@ -0,0 +1,384 @@
+#include "Game/VectorEnvironment.hpp"
+#include "Game/WorkerPool.hpp"
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+#include "Game/Bloon.hpp"
+#include "Game/BloonDefinition.hpp"
+#include "Game/Tower.hpp"
+#include "Game/TowerDefinition.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Game/GameCommon.hpp"
+#include <cstring>
+
+
+static_assert(static_cast<int>(EnvironmentActionType::START_ROUND) - 1 == static_cast<int>(GameCommandType::START_ROUND),
+	"Environment actions past NONE must line up with the player's game commands");
+
+
+//
+//settings
+//
+//map indexes are checked against the loaded map definitions, so load those first
+bool VectorEnvironmentSettings::IsValid() const
+{
+	if (m_numEnvironments <= 0 || m_mapIndexes.empty() || m_ticksPerStep < 0 || !(m_deltaSeconds > 0.0f) || m_numWorkers < 0) return false;
+
+	//the grid is either left out entirely or has a positive resolution
+	bool hasGrid = m_gridWidth > 0 && m_gridHeight > 0;
+	bool hasNoGrid = m_gridWidth == 0 && m_gridHeight == 0;
+	if (!hasGrid && !hasNoGrid) return false;
+
+	for (int mapSlot = 0; mapSlot < m_mapIndexes.size(); mapSlot++)
+	{
+		if (m_mapIndexes[mapSlot] < 0 || m_mapIndexes[mapSlot] >= MapDefinition::s_mapDefinitions.size()) return false;
+	}
+	return true;
+}
+
+
+//
+//constructor and destructor
+//
+VectorEnvironment::VectorEnvironment(VectorEnvironmentSettings const& settings)
+	: m_settings(settings)
+{
+	Game::LoadDefinitions();
+	GUARANTEE_OR_DIE(m_settings.IsValid(), "Invalid vector environment settings! Check them with IsValid before constructing");
+
+	m_games = Game::CreateHeadlessGames(m_settings.m_numEnvironments);
+
+	m_baseSnapshots.resize(MapDefinition::s_mapDefinitions.size());
+	for (int mapSlot = 0; mapSlot < m_settings.m_mapIndexes.size(); mapSlot++)
+	{
+		int mapIndex = m_settings.m_mapIndexes[mapSlot];
+		if (m_baseSnapshots[mapIndex].empty())
+		{
+			m_games[0]->WriteFreshMapSnapshot(mapIndex, m_baseSnapshots[mapIndex]);
+		}
+	}
+
+	m_actions.resize(m_games.size());
+	m_observations.resize(m_games.size() * ENV_OBSERVATION_SIZE);
+	if (m_settings.m_gridWidth > 0 && m_settings.m_gridHeight > 0)
+	{
+		m_grids.resize(m_games.size(), ObservationGrid(m_settings.m_gridWidth, m_settings.m_gridHeight));
+		m_gridObservations.resize(m_games.size() * GetGridSize());
+	}
+	m_rewards.resize(m_games.size());
+	m_dones.resize(m_games.size());
+	m_actionsAccepted.resize(m_games.size());
+
+	m_workerPool = new WorkerPool(m_settings.m_numWorkers);
+	int numWorkers = m_workerPool->GetNumWorkers();
+	m_numEnvironmentsPerJob = (GetNumEnvironments() + numWorkers - 1) / numWorkers;
+}
+
+
+VectorEnvironment::~VectorEnvironment()
+{
+	delete m_workerPool;
+	Game::DestroyHeadlessGames(m_games);
+}
+
+
+//
+//public member functions
+//
+bool VectorEnvironment::Reset()
+{
+	bool succeeded = true;
+	for (int envIndex = 0; envIndex < m_games.size(); envIndex++)
+	{
+		succeeded = ResetEnvironment(envIndex) && succeeded;
+		m_rewards[envIndex] = 0.0f;
+		m_dones[envIndex] = 0;
+		m_actionsAccepted[envIndex] = 0;
+		m_actions[envIndex] = EnvironmentAction();
+	}
+	return succeeded;
+}
+
+
+bool VectorEnvironment::Step()
+{
+	m_numFailedResets = 0;
+
+	//one job per run of environments rather than per environment keeps the queue short and each capture small
+	for (int firstEnvIndex = 0; firstEnvIndex < GetNumEnvironments(); firstEnvIndex += m_numEnvironmentsPerJob)
+	{
+		m_workerPool->AddJob([this, firstEnvIndex](int)
+		{
+			int endEnvIndex = firstEnvIndex + m_numEnvironmentsPerJob < GetNumEnvironments() ? firstEnvIndex + m_numEnvironmentsPerJob : GetNumEnvironments();
+			for (int envIndex = firstEnvIndex; envIndex < endEnvIndex; envIndex++)
+			{
+				StepEnvironment(envIndex);
+			}
+		});
+	}
+	m_workerPool->WaitForAllJobs();
+
+	//an action is applied once; a caller that writes only some environments' actions next step shouldn't replay the rest
+	for (int envIndex = 0; envIndex < m_actions.size(); envIndex++)
+	{
+		m_actions[envIndex] = EnvironmentAction();
+	}
+	return m_numFailedResets == 0;
+}
+
+
+//
+//private member functions
+//
+void VectorEnvironment::StepEnvironment(int envIndex)
+{
+	Game& game = *m_games[envIndex];
+	EnvironmentAction const& action = m_actions[envIndex];
+
+	int startLives = game.m_numLives;
+	int startRound = game.m_roundNumber;
+
+	bool accepted = false;
+	if (action.m_type > static_cast<int32_t>(EnvironmentActionType::NONE) && action.m_type < static_cast<int32_t>(EnvironmentActionType::NUM_ACTION_TYPES))
+	{
+		//the action types past NONE line up with the first game command types
+		GameCommand command;
+		command.m_type = static_cast<GameCommandType>(action.m_type - 1);
+		command.m_index = action.m_index;
+		command.m_position = Vec2(action.m_x, action.m_y);
+
+		//the UI only lets a held tower down on the playfield where it fits, which the command itself doesn't check
+		TowerDefinition const* placeDef = TowerDefinition::GetTowerDefinitionByIndex(action.m_index);
+		bool isOnPlayfield = action.m_x >= 0.0f && action.m_x <= PLAYFIELD_SIZE_X && action.m_y >= 0.0f && action.m_y <= SCREEN_CAMERA_SIZE_Y;
+		bool fits = command.m_type != GameCommandType::PLACE_TOWER || (placeDef != nullptr && isOnPlayfield && game.m_currentMap->IsValidTowerPlacement(placeDef, command.m_position));
+		accepted = fits && game.ExecuteCommand(command);
+	}
+	m_actionsAccepted[envIndex] = accepted ? 1 : 0;
+
+	for (int tickIndex = 0; tickIndex < m_settings.m_ticksPerStep && game.m_resetTimer <= 0.0f; tickIndex++)
+	{
+		game.UpdateSimulation(m_settings.m_deltaSeconds);
+	}
+
+	int livesLost = startLives - game.m_numLives;
+	int roundsCompleted = game.m_roundNumber - startRound;
+	m_rewards[envIndex] = ENV_REWARD_PER_ROUND * static_cast<float>(roundsCompleted) + ENV_REWARD_PER_LIFE_LOST * static_cast<float>(livesLost);
+
+	//the game over timer starts on a loss or after the last authored round is won
+	bool isDone = game.m_resetTimer > 0.0f;
+	m_dones[envIndex] = isDone ? 1 : 0;
+	if (!isDone)
+	{
+		WriteObservation(envIndex);
+	}
+	else if (!ResetEnvironment(envIndex))
+	{
+		m_numFailedResets++;
+	}
+}
+
+
+//a failed restore leaves the game as it was; its observation is still written so the buffers stay consistent
+bool VectorEnvironment::ResetEnvironment(int envIndex)
+{
+	int mapIndex = m_settings.m_mapIndexes[envIndex % m_settings.m_mapIndexes.size()];
+	bool restored = m_games[envIndex]->ReadSnapshot(m_baseSnapshots[mapIndex]);
+
+	WriteObservation(envIndex);
+	return restored;
+}
+
+
+void VectorEnvironment::WriteObservation(int envIndex)
+{
+	Game const& game = *m_games[envIndex];
+	float* observation = &m_observations[envIndex * ENV_OBSERVATION_SIZE];
+	memset(observation, 0, ENV_OBSERVATION_SIZE * sizeof(float));
+
+	//a game whose very first restore failed has no map; it reads as all zeroes
+	if (game.m_currentMap == nullptr)
+	{
+		if (!m_grids.empty())
+		{
+			memset(&m_gridObservations[static_cast<size_t>(envIndex) * GetGridSize()], 0, GetGridSize() * sizeof(float));
+		}
+		return;
+	}
+	Map const& map = *game.m_currentMap;
+
+	int numBloons = 0;
+	int rbeOnTrack = 0;
+	float furthestDistance = 0.0f;
+	for (int bloonIndex = 0; bloonIndex < map.m_bloons.size(); bloonIndex++)
+	{
+		Bloon const* bloon = map.m_bloons[bloonIndex];
+		if (bloon == nullptr || bloon->m_hasPopped || bloon->m_hasLeaked) continue;
+
+		numBloons++;
+		rbeOnTrack += bloon->m_definition->m_RBE;
+		if (bloon->m_trackDistance > furthestDistance)
+		{
+			furthestDistance = bloon->m_trackDistance;
+		}
+	}
+	for (int swarmIndex = 0; swarmIndex < map.m_bloonSwarms.size(); swarmIndex++)
+	{
+		BloonSwarm const& swarm = map.m_bloonSwarms[swarmIndex];
+		int numMembers = swarm.m_numMembers - swarm.m_firstMemberIndex;
+		numBloons += numMembers;
+		rbeOnTrack += numMembers * swarm.m_definition->m_RBE;
+		if (numMembers > 0 && swarm.GetMemberDistance(swarm.m_firstMemberIndex) > furthestDistance)
+		{
+			furthestDistance = swarm.GetMemberDistance(swarm.m_firstMemberIndex);
+		}
+	}
+	float trackLength = map.GetBloonTrackLength();
+
+	observation[0] = static_cast<float>(game.m_numLives);
+	observation[1] = static_cast<float>(game.m_numMoney);
+	observation[2] = static_cast<float>(game.m_roundNumber);
+	observation[3] = game.m_isRoundActive ? 1.0f : 0.0f;
+	observation[4] = static_cast<float>(numBloons);
+	observation[5] = static_cast<float>(rbeOnTrack);
+	observation[6] = trackLength > 0.0f ? furthestDistance / trackLength : 0.0f;
+
+	float* towerObservations = observation + ENV_NUM_GLOBAL_OBSERVATIONS;
+	int numObservedSlots = map.m_towers.size() < ENV_MAX_OBSERVED_TOWERS ? static_cast<int>(map.m_towers.size()) : ENV_MAX_OBSERVED_TOWERS;
+	for (int towerSlot = 0; towerSlot < numObservedSlots; towerSlot++)
+	{
+		Tower const* tower = map.m_towers[towerSlot];
+		if (tower == nullptr) continue;
+
+		float* towerObservation = towerObservations + towerSlot * ENV_FLOATS_PER_TOWER;
+		towerObservation[0] = 1.0f;
+		towerObservation[1] = static_cast<float>(tower->m_definition - TowerDefinition::s_towerDefinitions.data());
+		towerObservation[2] = tower->m_position.x / PLAYFIELD_SIZE_X;
+		towerObservation[3] = tower->m_position.y / SCREEN_CAMERA_SIZE_Y;
+		towerObservation[4] = static_cast<float>(tower->m_targetingMode);
+	}
+
+	if (!m_grids.empty())
+	{
+		m_grids[envIndex].Rasterize(map, &m_gridObservations[static_cast<size_t>(envIndex) * GetGridSize()]);
+	}
+}
+
+
+//
+//C ABI
+//
+VectorEnvironment* VectorEnvironment_Create(int numEnvironments, int const* mapIndexes, int numMapIndexes, int ticksPerStep, float deltaSeconds, int numWorkers,
+	int gridWidth, int gridHeight, int* out_result)
+{
+	VectorEnvironmentSettings settings;
+	settings.m_numEnvironments = numEnvironments;
+	if (mapIndexes != nullptr && numMapIndexes > 0)
+	{
+		settings.m_mapIndexes.assign(mapIndexes, mapIndexes + numMapIndexes);
+	}
+	settings.m_ticksPerStep = ticksPerStep;
+	settings.m_deltaSeconds = deltaSeconds;
+	settings.m_numWorkers = numWorkers;
+	settings.m_gridWidth = gridWidth;
+	settings.m_gridHeight = gridHeight;
+
+	Game::LoadDefinitions();
+	if (!settings.IsValid())
+	{
+		if (out_result != nullptr) *out_result = VECTOR_ENVIRONMENT_INVALID_ARGUMENT;
+		return nullptr;
+	}
+
+	VectorEnvironment* environment = new VectorEnvironment(settings);
+	if (!environment->Reset())
+	{
+		delete environment;
+		if (out_result != nullptr) *out_result = VECTOR_ENVIRONMENT_RESTORE_FAILED;
+		return nullptr;
+	}
+
+	if (out_result != nullptr) *out_result = VECTOR_ENVIRONMENT_OK;
+	return environment;
+}
+
+
+void VectorEnvironment_Destroy(VectorEnvironment* environment)
+{
+	delete environment;
+}
+
+
+int VectorEnvironment_GetNumEnvironments(VectorEnvironment const* environment)
+{
+	return environment != nullptr ? environment->GetNumEnvironments() : 0;
+}
+
+
+int VectorEnvironment_GetObservationSize()
+{
+	return ENV_OBSERVATION_SIZE;
+}
+
+
+int VectorEnvironment_Reset(VectorEnvironment* environment)
+{
+	if (environment == nullptr) return VECTOR_ENVIRONMENT_INVALID_ARGUMENT;
+
+	return environment->Reset() ? VECTOR_ENVIRONMENT_OK : VECTOR_ENVIRONMENT_RESTORE_FAILED;
+}
+
+
+//actions may be null when the caller wrote straight into VectorEnvironment_GetActions; otherwise there must be one per environment
+int VectorEnvironment_Step(VectorEnvironment* environment, EnvironmentAction const* actions, int numActions)
+{
+	if (environment == nullptr) return VECTOR_ENVIRONMENT_INVALID_ARGUMENT;
+
+	if (actions != nullptr)
+	{
+		if (numActions != environment->GetNumEnvironments()) return VECTOR_ENVIRONMENT_INVALID_ARGUMENT;
+
+		memcpy(environment->m_actions.data(), actions, environment->m_actions.size() * sizeof(EnvironmentAction));
+	}
+	return environment->Step() ? VECTOR_ENVIRONMENT_OK : VECTOR_ENVIRONMENT_RESTORE_FAILED;
+}
+
+
+EnvironmentAction* VectorEnvironment_GetActions(VectorEnvironment* environment)
+{
+	return environment != nullptr ? environment->m_actions.data() : nullptr;
+}
+
+
+float const* VectorEnvironment_GetObservations(VectorEnvironment const* environment)
+{
+	return environment != nullptr ? environment->m_observations.data() : nullptr;
+}
+
+
+int VectorEnvironment_GetGridSize(VectorEnvironment const* environment)
+{
+	return environment != nullptr ? environment->GetGridSize() : 0;
+}
+
+
+float const* VectorEnvironment_GetGridObservations(VectorEnvironment const* environment)
+{
+	return environment != nullptr ? environment->m_gridObservations.data() : nullptr;
+}
+
+
+float const* VectorEnvironment_GetRewards(VectorEnvironment const* environment)
+{
+	return environment != nullptr ? environment->m_rewards.data() : nullptr;
+}
+
+
+uint8_t const* VectorEnvironment_GetDones(VectorEnvironment const* environment)
+{
+	return environment != nullptr ? environment->m_dones.data() : nullptr;
+}
+
+
+uint8_t const* VectorEnvironment_GetActionsAccepted(VectorEnvironment const* environment)
+{
+	return environment != nullptr ? environment->m_actionsAccepted.data() : nullptr;
+}
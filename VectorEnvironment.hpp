@@ -0,0 +1,141 @@
+#pragma once
+#include "Game/ObservationGrid.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+
+class Game;
+class WorkerPool;
+
+
+//the DLL configuration builds with VECTOR_ENVIRONMENT_EXPORTS so the C ABI below is exported from it
+#if defined(VECTOR_ENVIRONMENT_EXPORTS)
+#define VECTOR_ENVIRONMENT_API __declspec(dllexport)
+#else
+#define VECTOR_ENVIRONMENT_API
+#endif
+
+
+//what the C ABI returns instead of stopping the process over a caller's mistake
+enum VectorEnvironmentResult : int32_t
+{
+	VECTOR_ENVIRONMENT_OK = 0,
+	VECTOR_ENVIRONMENT_INVALID_ARGUMENT = -1,	//null environment, bad settings, unknown map, or an action count that isn't one per environment
+	VECTOR_ENVIRONMENT_RESTORE_FAILED = -2,		//an environment could not be reset to its fresh map; the batch should be recreated
+};
+
+
+//what an agent can do in one step; mirrors the player's console and UI actions, not the debug ones
+enum class EnvironmentActionType : int32_t
+{
+	NONE,
+	PLACE_TOWER,			//index = tower definition, (x, y) = placement
+	SELL_TOWER,				//index = tower slot
+	BUY_UPGRADE_1,			//index = tower slot
+	BUY_UPGRADE_2,			//index = tower slot
+	TOGGLE_TARGETING_MODE,	//index = tower slot
+	START_ROUND,
+
+	NUM_ACTION_TYPES
+};
+
+
+//plain layout so a C caller can fill an array of these directly
+struct EnvironmentAction
+{
+	int32_t m_type = 0;		//EnvironmentActionType
+	int32_t m_index = -1;
+	float	m_x = 0.0f;
+	float	m_y = 0.0f;
+};
+
+
+//observation layout per environment: ENV_NUM_GLOBAL_OBSERVATIONS floats, then ENV_FLOATS_PER_TOWER for each of the first
+//ENV_MAX_OBSERVED_TOWERS tower slots. Positions are divided by the playfield size so everything sits near 0 to 1 or is a count.
+constexpr int ENV_NUM_GLOBAL_OBSERVATIONS = 7;	//lives, money, round, round active, bloons on track, RBE on track, furthest bloon's share of the track
+constexpr int ENV_MAX_OBSERVED_TOWERS = 32;
+constexpr int ENV_FLOATS_PER_TOWER = 5;			//occupied, tower definition, x, y, targeting mode
+constexpr int ENV_OBSERVATION_SIZE = ENV_NUM_GLOBAL_OBSERVATIONS + ENV_MAX_OBSERVED_TOWERS * ENV_FLOATS_PER_TOWER;
+
+constexpr float ENV_REWARD_PER_ROUND = 1.0f;
+constexpr float ENV_REWARD_PER_LIFE_LOST = -0.01f;
+
+
+struct VectorEnvironmentSettings
+{
+	int	  m_numEnvironments = 64;
+	std::vector<int> m_mapIndexes = { 0 };	//environment i plays m_mapIndexes[i % size]
+	int	  m_ticksPerStep = 60;
+	float m_deltaSeconds = 1.0f / 60.0f;
+	int	  m_numWorkers = 0;					//0 means one per hardware thread
+	int	  m_gridWidth = 0;					//0 leaves out the rasterized grid observations
+	int	  m_gridHeight = 0;
+
+	bool IsValid() const;
+};
+
+
+//N independent headless games stepped together for training placement agents. Actions, observations, rewards and done
+//flags live in contiguous buffers sized once up front; each step fills them in place and hands one job per worker to the
+//pool, each stepping its own run of environments. An environment that ends is reset straight away, so its observation is
+//the first one of the next episode while its reward and done flag still describe the step that ended it.
+class VectorEnvironment
+{
+//public member functions
+public:
+	explicit VectorEnvironment(VectorEnvironmentSettings const& settings);	//settings must pass IsValid; Reset before the first Step
+	~VectorEnvironment();
+
+	bool Reset();	//false if any environment failed to restore its fresh map
+	bool Step();	//applies m_actions once, clears them back to NONE, then runs m_ticksPerStep ticks in every environment; false if a reset failed
+
+	int GetNumEnvironments() const { return static_cast<int>(m_games.size()); }
+	int GetGridSize() const { return m_grids.empty() ? 0 : m_grids[0].GetNumFloats(); }
+
+//public member variables
+public:
+	std::vector<EnvironmentAction> m_actions;		//one per environment, filled by the caller before each Step and cleared by it
+	std::vector<float>	 m_observations;			//ENV_OBSERVATION_SIZE per environment
+	std::vector<float>	 m_gridObservations;		//GetGridSize() per environment, laid out as ObservationGrid writes them
+	std::vector<float>	 m_rewards;
+	std::vector<uint8_t> m_dones;
+	std::vector<uint8_t> m_actionsAccepted;			//whether the game allowed each action
+
+//private member functions
+private:
+	void StepEnvironment(int envIndex);
+	bool ResetEnvironment(int envIndex);
+	void WriteObservation(int envIndex);
+
+//private member variables
+private:
+	VectorEnvironmentSettings m_settings;
+	std::vector<Game*> m_games;
+	std::vector<ObservationGrid> m_grids;	//one per environment, since each caches its own map's track mask
+	std::vector<std::vector<uint8_t>> m_baseSnapshots;	//by map index, empty for maps nobody plays
+	WorkerPool* m_workerPool = nullptr;
+	int m_numEnvironmentsPerJob = 1;
+	std::atomic<int> m_numFailedResets = 0;		//counted by the jobs of one Step
+};
+
+
+//C ABI over the same thing, for training code in other languages. Buffers returned stay valid, and in place, until destroy.
+//Create returns null and writes out_result when the settings are bad or the first reset fails; the getters return null or 0 for a null environment.
+extern "C"
+{
+	VECTOR_ENVIRONMENT_API VectorEnvironment* VectorEnvironment_Create(int numEnvironments, int const* mapIndexes, int numMapIndexes, int ticksPerStep, float deltaSeconds,
+		int numWorkers, int gridWidth, int gridHeight, int* out_result);
+	VECTOR_ENVIRONMENT_API void				  VectorEnvironment_Destroy(VectorEnvironment* environment);
+	VECTOR_ENVIRONMENT_API int				  VectorEnvironment_GetNumEnvironments(VectorEnvironment const* environment);
+	VECTOR_ENVIRONMENT_API int				  VectorEnvironment_GetObservationSize();
+	VECTOR_ENVIRONMENT_API int				  VectorEnvironment_GetGridSize(VectorEnvironment const* environment);
+	VECTOR_ENVIRONMENT_API int				  VectorEnvironment_Reset(VectorEnvironment* environment);
+	VECTOR_ENVIRONMENT_API int				  VectorEnvironment_Step(VectorEnvironment* environment, EnvironmentAction const* actions, int numActions);
+	VECTOR_ENVIRONMENT_API EnvironmentAction* VectorEnvironment_GetActions(VectorEnvironment* environment);
+	VECTOR_ENVIRONMENT_API float const*		  VectorEnvironment_GetObservations(VectorEnvironment const* environment);
+	VECTOR_ENVIRONMENT_API float const*		  VectorEnvironment_GetGridObservations(VectorEnvironment const* environment);
+	VECTOR_ENVIRONMENT_API float const*		  VectorEnvironment_GetRewards(VectorEnvironment const* environment);
+	VECTOR_ENVIRONMENT_API uint8_t const*	  VectorEnvironment_GetDones(VectorEnvironment const* environment);
+	VECTOR_ENVIRONMENT_API uint8_t const*	  VectorEnvironment_GetActionsAccepted(VectorEnvironment const* environment);
+}
@@ -0,0 +1,89 @@
+#include "Game/WorkerPool.hpp"
+
+
+//
+//constructor and destructor
+//
+WorkerPool::WorkerPool(int numWorkers)
+{
+	if (numWorkers <= 0)
+	{
+		numWorkers = static_cast<int>(std::thread::hardware_concurrency());
+		if (numWorkers <= 0) numWorkers = 1;
+	}
+
+	for (int workerIndex = 0; workerIndex < numWorkers; workerIndex++)
+	{
+		m_threads.emplace_back(&WorkerPool::WorkerMain, this, workerIndex);
+	}
+}
+
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_jobAvailableCondition.notify_all();
+
+	for (int workerIndex = 0; workerIndex < m_threads.size(); workerIndex++)
+	{
+		m_threads[workerIndex].join();
+	}
+}
+
+
+//
+//public member functions
+//
+void WorkerPool::AddJob(std::function<void(int workerIndex)> const& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.emplace_back(job);
+	}
+	m_jobAvailableCondition.notify_one();
+}
+
+
+void WorkerPool::WaitForAllJobs()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_allJobsDoneCondition.wait(lock, [this]() { return m_jobs.empty() && m_numJobsInProgress == 0; });
+}
+
+
+//
+//private member functions
+//
+void WorkerPool::WorkerMain(int workerIndex)
+{
+	while (true)
+	{
+		std::function<void(int)> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobAvailableCondition.wait(lock, [this]() { return m_isQuitting || !m_jobs.empty(); });
+			if (m_jobs.empty())
+			{
+				return;
+			}
+
+			job = m_jobs.front();
+			m_jobs.pop_front();
+			m_numJobsInProgress++;
+		}
+
+		job(workerIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_numJobsInProgress--;
+			if (m_jobs.empty() && m_numJobsInProgress == 0)
+			{
+				m_allJobsDoneCondition.notify_all();
+			}
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+//fixed set of threads pulling jobs from a shared queue; each job is told which worker runs it,
+//so callers can give every worker its own scratch state (e.g. a headless Game) and avoid locking
+class WorkerPool
+{
+//public member functions
+public:
+	explicit WorkerPool(int numWorkers = 0);	//0 means one worker per hardware thread
+	~WorkerPool();
+
+	void AddJob(std::function<void(int workerIndex)> const& job);
+	void WaitForAllJobs();
+
+	int GetNumWorkers() const { return static_cast<int>(m_threads.size()); }
+
+//private member functions
+private:
+	void WorkerMain(int workerIndex);
+
+//private member variables
+private:
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_jobAvailableCondition;
+	std::condition_variable m_allJobsDoneCondition;
+	std::deque<std::function<void(int)>> m_jobs;
+	int  m_numJobsInProgress = 0;
+	bool m_isQuitting = false;
+};